@@ -0,0 +1,144 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cmath>
+#include <algorithm>
+#include "AcAnalysis.h"
+#include "ThreadPool.h"
+
+static const double DEGREES_PER_RADIAN = 180 / M_PI;
+
+int AcResults::getNumberOfPoints() const {
+    return frequencies.size();
+}
+
+Phasor AcResults::getBranchCurrent(int point, int branch) const {
+    size_t i = (size_t) point * numberOfBranches + branch;
+    return std::polar(branchCurrentMagnitudes.at(i), branchCurrentPhases.at(i) / DEGREES_PER_RADIAN);
+}
+
+Phasor AcResults::getNodeVoltage(int point, int node) const {
+    size_t i = (size_t) point * numberOfNodes + node;
+    return std::polar(nodeVoltageMagnitudes.at(i), nodeVoltagePhases.at(i) / DEGREES_PER_RADIAN);
+}
+
+AcAnalysis::AcAnalysis(Circuit &circuit, int numberOfThreads) :
+        topology(std::make_shared<CircuitTopology>(circuit, true)), numberOfThreads(numberOfThreads) {
+    values = topology->getValuesOf(circuit);
+    topology->getBranchValues(values, resistances, voltages, currents);
+    topology->getBranchReactiveValues(values, capacitances, inductances);
+}
+
+vector<double> AcAnalysis::linearFrequencies(double start, double stop, int numberOfPoints) {
+    if (numberOfPoints < 1) throw std::domain_error("A sweep needs at least one value!");
+    vector<double> frequencies;
+    for (int i = 0; i < numberOfPoints; i++)
+        frequencies.push_back(numberOfPoints == 1 ? start : start + (stop - start) * i / (numberOfPoints - 1));
+    return frequencies;
+}
+
+vector<double> AcAnalysis::logarithmicFrequencies(double start, double stop, int numberOfPoints) {
+    if (start <= 0 || stop <= 0) throw std::domain_error("Logarithmic sweep needs positive values!");
+    vector<double> frequencies = linearFrequencies(log(start), log(stop), numberOfPoints);
+    for (auto &f : frequencies)
+        f = exp(f);
+    return frequencies;
+}
+
+//Every other source is set to zero: voltage sources become shorts and current sources opens
+void AcAnalysis::setExcitation(ComponentType type, int sourceId) {
+    if (type != ComponentType::VOLTAGE_SOURCE && type != ComponentType::CURRENT_SOURCE)
+        throw std::domain_error("Only a source can drive the circuit!");
+    int index = topology->getComponentIndex(type, sourceId);
+    if (index < 0) throw std::domain_error("Source is not in the circuit!");
+    double value = values.getValues(type)[index];
+    std::fill(values.voltages.begin(), values.voltages.end(), 0.0);
+    std::fill(values.currents.begin(), values.currents.end(), 0.0);
+    values.getValues(type)[index] = value;
+    topology->getBranchValues(values, resistances, voltages, currents);
+}
+
+void AcAnalysis::solveFrequency(SparseLU<Phasor> &lu, double frequency, vector<Phasor> &matrixValues,
+                                vector<Phasor> &impedances, vector<Phasor> &branchCurrents,
+                                vector<Phasor> &nodeVoltages) const {
+    const CircuitTopology &t = *topology;
+    int numberOfBranches = t.getNumberOfBranches();
+    double omega = 2 * M_PI * frequency;
+    impedances.resize(numberOfBranches);
+    for (int b = 0; b < numberOfBranches; b++) {
+        impedances[b] = Phasor(resistances[b], omega * inductances[b]);
+        if (capacitances[b] > 0) impedances[b] += Phasor(0, -1 / (omega * capacitances[b]));
+    }
+
+    matrixValues.resize(t.entryBranch.size());
+    for (int p = 0; p < t.entryBranch.size(); p++) {
+        int b = t.entryBranch[p];
+        matrixValues[p] = b < 0 ? Phasor(t.entrySign[p]) : t.entrySign[p] * impedances[b];
+    }
+    lu.refactor(matrixValues);
+
+    branchCurrents.assign(numberOfBranches, Phasor(0));
+    for (int l = 0; l < t.getNumberOfLoops(); l++) {
+        double sumOfVoltageSourcesInLoop = 0;
+        for (const auto &lb : t.loops[l])
+            sumOfVoltageSourcesInLoop += lb.orientation * voltages[lb.branch];
+        branchCurrents[t.loopRows[l]] = sumOfVoltageSourcesInLoop;
+    }
+    for (int b = 0; b < numberOfBranches; b++)
+        if (t.fixedCurrentRows[b] >= 0) branchCurrents[t.fixedCurrentRows[b]] = currents[b];
+    lu.solve(branchCurrents);
+
+    nodeVoltages.assign(t.getNumberOfNodes(), Phasor(0));
+    for (auto n : t.treeOrder) {
+        int b = t.treeParentBranch[n];
+        if (b < 0) continue;
+        Phasor drop = voltages[b] - branchCurrents[b] * impedances[b];
+        if (t.firstNodes[b] == t.treeParentNode[n]) nodeVoltages[n] = nodeVoltages[t.treeParentNode[n]] + drop;
+        else nodeVoltages[n] = nodeVoltages[t.treeParentNode[n]] - drop;
+    }
+}
+
+AcResults AcAnalysis::run(const vector<double> &frequencies) const {
+    for (auto f : frequencies)
+        if (f <= 0) throw std::domain_error("Frequency must be positive!");
+    const CircuitTopology &t = *topology;
+    int numberOfBranches = t.getNumberOfBranches();
+    int numberOfNodes = t.getNumberOfNodes();
+    int numberOfPoints = frequencies.size();
+
+    AcResults results;
+    results.numberOfBranches = numberOfBranches;
+    results.numberOfNodes = numberOfNodes;
+    results.branchIds = t.branchIds;
+    results.nodeIds = t.nodeIds;
+    results.frequencies = frequencies;
+    results.branchCurrentMagnitudes.resize((size_t) numberOfPoints * numberOfBranches);
+    results.branchCurrentPhases.resize((size_t) numberOfPoints * numberOfBranches);
+    results.nodeVoltageMagnitudes.resize((size_t) numberOfPoints * numberOfNodes);
+    results.nodeVoltagePhases.resize((size_t) numberOfPoints * numberOfNodes);
+    if (numberOfPoints == 0) return results;
+
+    int threads = std::max(1, std::min(getNumberOfThreads(numberOfThreads), numberOfPoints));
+    vector<SparseLU<Phasor>> factorizations(threads, SparseLU<Phasor>(t.pattern, t.symbolic));
+    vector<vector<Phasor>> workerMatrixValues(threads), workerImpedances(threads);
+    vector<vector<Phasor>> workerCurrents(threads), workerVoltages(threads);
+
+    parallelFor(numberOfPoints, threads, [&](int thread, int point) -> void {
+        vector<Phasor> &branchCurrents = workerCurrents[thread];
+        vector<Phasor> &nodeVoltages = workerVoltages[thread];
+        solveFrequency(factorizations[thread], frequencies[point], workerMatrixValues[thread],
+                       workerImpedances[thread], branchCurrents, nodeVoltages);
+        for (int b = 0; b < numberOfBranches; b++) {
+            size_t i = (size_t) point * numberOfBranches + b;
+            results.branchCurrentMagnitudes[i] = std::abs(branchCurrents[b]);
+            results.branchCurrentPhases[i] = std::arg(branchCurrents[b]) * DEGREES_PER_RADIAN;
+        }
+        for (int n = 0; n < numberOfNodes; n++) {
+            size_t i = (size_t) point * numberOfNodes + n;
+            results.nodeVoltageMagnitudes[i] = std::abs(nodeVoltages[n]);
+            results.nodeVoltagePhases[i] = std::arg(nodeVoltages[n]) * DEGREES_PER_RADIAN;
+        }
+    });
+    return results;
+}
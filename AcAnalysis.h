@@ -0,0 +1,72 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_ACANALYSIS_H
+#define CIRCUITANALYZER_ACANALYSIS_H
+
+#include <vector>
+#include <complex>
+#include "CompiledCircuit.h"
+
+using std::vector;
+
+typedef std::complex<double> Phasor;
+
+//Magnitude and phase (in degrees) of every branch current and node voltage, one row per frequency
+//Node voltages are relative to the root of their tree component
+
+class AcResults {
+public:
+    int numberOfBranches = 0;
+    int numberOfNodes = 0;
+    vector<int> branchIds;
+    vector<int> nodeIds;
+    vector<double> frequencies;
+    vector<double> branchCurrentMagnitudes;
+    vector<double> branchCurrentPhases;
+    vector<double> nodeVoltageMagnitudes;
+    vector<double> nodeVoltagePhases;
+
+    int getNumberOfPoints() const;
+
+    Phasor getBranchCurrent(int point, int branch) const;
+
+    Phasor getNodeVoltage(int point, int node) const;
+};
+
+//Small-signal frequency response. Every branch gets the complex impedance R + jwL + 1 / (jwC) of its
+//components, the sources are phasors with zero phase. setExcitation() keeps only one source driving the circuit,
+//for transfer functions and impedances. The equations have the same pattern for every frequency,
+//so the column ordering of the topology is shared, and every thread keeps its own complex factorization and
+//refactors it with the pivots of its previous frequency.
+
+class AcAnalysis {
+    std::shared_ptr<const CircuitTopology> topology;
+    ComponentValues values;
+    vector<double> resistances;
+    vector<double> voltages;
+    vector<double> currents;
+    vector<double> capacitances;
+    vector<double> inductances;
+    int numberOfThreads;
+
+public:
+    explicit AcAnalysis(Circuit &circuit, int numberOfThreads = 0);
+
+    static vector<double> linearFrequencies(double start, double stop, int numberOfPoints);
+
+    static vector<double> logarithmicFrequencies(double start, double stop, int numberOfPoints);
+
+    void setExcitation(ComponentType type, int sourceId);
+
+    AcResults run(const vector<double> &frequencies) const;
+
+private:
+    void solveFrequency(SparseLU<Phasor> &lu, double frequency, vector<Phasor> &matrixValues,
+                        vector<Phasor> &impedances, vector<Phasor> &branchCurrents,
+                        vector<Phasor> &nodeVoltages) const;
+};
+
+
+#endif //CIRCUITANALYZER_ACANALYSIS_H
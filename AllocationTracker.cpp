@@ -0,0 +1,107 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <new>
+#include <cstdlib>
+#include <stdexcept>
+#include "AllocationTracker.h"
+#include "AnalysisStatistics.h"
+
+std::atomic<bool> AllocationTracker::enabled(false);
+
+//Plain data, so that operator new can use them before and after the constructors and destructors of the thread
+static thread_local long threadAllocations = 0;
+static thread_local long threadBytes = 0;
+static thread_local PhaseStatistics *activePhase = nullptr;
+
+void AllocationTracker::setEnabled(bool enabled) {
+#ifndef CIRCUIT_ALLOCATION_TRACKING
+    if (enabled) throw std::domain_error("Allocation tracking isn't compiled in (CIRCUIT_ALLOCATION_TRACKING)!");
+#endif
+    AllocationTracker::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+AllocationCounters AllocationTracker::getThreadCounters() {
+    AllocationCounters counters;
+    counters.allocations = threadAllocations;
+    counters.bytes = threadBytes;
+    return counters;
+}
+
+PhaseStatistics *AllocationTracker::setActivePhase(PhaseStatistics *phase) {
+    PhaseStatistics *previous = activePhase;
+    activePhase = phase;
+    return previous;
+}
+
+#ifdef CIRCUIT_ALLOCATION_TRACKING
+
+static void *allocate(std::size_t size) {
+    if (size == 0) size = 1;
+    void *memory;
+    while ((memory = std::malloc(size)) == nullptr) {
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) throw std::bad_alloc();
+        handler();
+    }
+    if (AllocationTracker::isEnabled()) {
+        threadAllocations++;
+        threadBytes += size;
+        if (activePhase != nullptr) {
+            activePhase->allocations++;
+            activePhase->bytesAllocated += size;
+        }
+    }
+    return memory;
+}
+
+static void *allocateNothrow(std::size_t size) noexcept {
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc &) {
+        return nullptr;
+    }
+}
+
+void *operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return allocateNothrow(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return allocateNothrow(size);
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+#endif
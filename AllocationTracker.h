@@ -0,0 +1,51 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_ALLOCATIONTRACKER_H
+#define CIRCUITANALYZER_ALLOCATIONTRACKER_H
+
+#include <atomic>
+
+class PhaseStatistics;
+
+//Heap allocations (calls of operator new) and their bytes
+class AllocationCounters {
+public:
+    long allocations = 0;
+    long bytes = 0;
+};
+
+//Counts the heap allocations of every thread, and adds them to the analysis phase the thread is in
+//With CIRCUIT_ALLOCATION_TRACKING defined at compile time, AllocationTracker.cpp replaces the global operator new
+//and delete with ones that go to malloc and free and, while tracking is on, add to counters of the calling thread
+//(no atomics, no locks). Without it the default operators stay and isEnabled() is a constant false.
+//The counters say how often a phase goes to the heap, the bytes are the sizes asked for. Frees aren't counted, and
+//neither are the aligned operators (alignas above the default) nor memory taken with malloc directly.
+//While tracking is on, PhaseTimer makes its phase the active phase of the thread, so allocations in nested timers
+//go to the innermost phase only.
+
+class AllocationTracker {
+    static std::atomic<bool> enabled;
+
+public:
+    static bool isEnabled() {
+#ifdef CIRCUIT_ALLOCATION_TRACKING
+        return enabled.load(std::memory_order_relaxed);
+#else
+        return false;
+#endif
+    }
+
+    //Throws if tracking isn't compiled in
+    static void setEnabled(bool enabled);
+
+    //Allocations of the calling thread while tracking was on
+    static AllocationCounters getThreadCounters();
+
+    //Phase the allocations of the calling thread are added to (null for none), returns the one before
+    static PhaseStatistics *setActivePhase(PhaseStatistics *phase);
+};
+
+
+#endif //CIRCUITANALYZER_ALLOCATIONTRACKER_H
@@ -0,0 +1,62 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cstdio>
+#include "AnalysisStatistics.h"
+
+static const char *PHASE_NAMES[] = {"topology", "loops", "pattern", "assembly", "factorization", "solution",
+                                    "output"};
+
+std::atomic<bool> AnalysisStatistics::timing(true);
+
+double AnalysisStatistics::getSeconds() const {
+    double seconds = 0;
+    for (const auto &p : phases)
+        seconds += p.seconds;
+    return seconds;
+}
+
+long AnalysisStatistics::getAllocations() const {
+    long allocations = 0;
+    for (const auto &p : phases)
+        allocations += p.allocations;
+    return allocations;
+}
+
+long AnalysisStatistics::getBytesAllocated() const {
+    long bytes = 0;
+    for (const auto &p : phases)
+        bytes += p.bytesAllocated;
+    return bytes;
+}
+
+void AnalysisStatistics::addPhases(const AnalysisStatistics &other) {
+    for (int i = 0; i < NUMBER_OF_ANALYSIS_PHASES; i++) {
+        phases[i].calls += other.phases[i].calls;
+        phases[i].seconds += other.phases[i].seconds;
+        phases[i].allocations += other.phases[i].allocations;
+        phases[i].bytesAllocated += other.phases[i].bytesAllocated;
+    }
+}
+
+void AnalysisStatistics::print(std::ostream &os) const {
+    char line[200];
+    snprintf(line, sizeof(line), "%d branches, %d nodes, %d loops, %ld nonzeros, %ld fill-in%s\n", numberOfBranches,
+             numberOfNodes, numberOfLoops, matrixNonZeros, fillIn, cachedTopology ? ", cached topology" : "");
+    os << line;
+    for (int i = 0; i < NUMBER_OF_ANALYSIS_PHASES; i++) {
+        const PhaseStatistics &p = phases[i];
+        snprintf(line, sizeof(line), "%-14s %8ld x %11.3e s %10ld allocations %12ld bytes\n",
+                 getPhaseName((AnalysisPhase) i), p.calls, p.seconds, p.allocations, p.bytesAllocated);
+        os << line;
+    }
+}
+
+void AnalysisStatistics::setTiming(bool timing) {
+    AnalysisStatistics::timing.store(timing, std::memory_order_relaxed);
+}
+
+const char *AnalysisStatistics::getPhaseName(AnalysisPhase phase) {
+    return PHASE_NAMES[(int) phase];
+}
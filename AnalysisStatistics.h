@@ -0,0 +1,147 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_ANALYSISSTATISTICS_H
+#define CIRCUITANALYZER_ANALYSISSTATISTICS_H
+
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include "TraceRecorder.h"
+#include "AllocationTracker.h"
+
+//Phases of a DC analysis, in the order in which measureCurrentsOfACircuit() goes through them
+//TOPOLOGY: reading the branches of the circuit and the spanning tree, LOOPS: loops closed by the other branches,
+//PATTERN: pattern of the equations and ordering of the factorization, ASSEMBLY: branch values and matrix from the
+//component values, FACTORIZATION: numeric LU, SOLUTION: right hand side and triangular solves, OUTPUT: currents
+//written to the branches
+enum class AnalysisPhase {
+    TOPOLOGY, LOOPS, PATTERN, ASSEMBLY, FACTORIZATION, SOLUTION, OUTPUT
+};
+
+const int NUMBER_OF_ANALYSIS_PHASES = 7;
+const int NUMBER_OF_TOPOLOGY_PHASES = 3;         //TOPOLOGY, LOOPS and PATTERN, the phases of a CircuitTopology
+
+class PhaseStatistics {
+public:
+    long calls = 0;
+    double seconds = 0;
+    long allocations = 0;
+    long bytesAllocated = 0;
+};
+
+//Counters and phase times of the analysis of one circuit
+//A topology taken from TopologyCache only spends TOPOLOGY time, LOOPS and PATTERN stay at zero. A compiled circuit
+//that is refactored or solved many times adds up the time of every call. Allocations of a phase stay zero unless
+//AllocationTracker is on.
+//Timing costs one read of the steady clock per phase boundary, about 10 reads in measureCurrentsOfACircuit(), which
+//is lost in the noise from ten branches up. Repeated solves of tiny circuits (a few hundred ns each) can notice it,
+//setTiming(false) turns it off for the whole program and leaves the counters.
+
+class AnalysisStatistics {
+    static std::atomic<bool> timing;
+
+public:
+    int numberOfBranches = 0;
+    int numberOfNodes = 0;
+    int numberOfLoops = 0;
+    long matrixNonZeros = 0;
+    long fillIn = 0;                     //entries of L and U that aren't in the matrix
+    bool cachedTopology = false;
+    PhaseStatistics phases[NUMBER_OF_ANALYSIS_PHASES];
+
+    PhaseStatistics &getPhase(AnalysisPhase phase) {
+        return phases[(int) phase];
+    }
+
+    const PhaseStatistics &getPhase(AnalysisPhase phase) const {
+        return phases[(int) phase];
+    }
+
+    double getSeconds() const;
+
+    long getAllocations() const;
+
+    long getBytesAllocated() const;
+
+    //Phases of another analysis added to these, for the totals of many circuits
+    void addPhases(const AnalysisStatistics &other);
+
+    void print(std::ostream &os) const;
+
+    static const char *getPhaseName(AnalysisPhase phase);
+
+    static bool isTiming() {
+        return timing.load(std::memory_order_relaxed);
+    }
+
+    static void setTiming(bool timing);
+};
+
+//Adds the time between its construction and stop() (or destruction) to one phase
+//next() ends the phase and starts another with a single read of the clock.
+//While TraceRecorder is on, every phase is also recorded as a span of the "analysis" category.
+//While AllocationTracker is on, the current phase counts the allocations of the thread until the timer stops.
+
+class PhaseTimer {
+    typedef std::chrono::steady_clock Clock;
+
+    PhaseStatistics *phases;
+    PhaseStatistics *phase;              //null once stopped
+    bool timing;
+    bool tracing;
+    bool counting;
+    PhaseStatistics *outerPhase = nullptr;   //phase that counted allocations before this timer
+    Clock::time_point begin;
+
+    void finish(Clock::time_point end) {
+        if (timing) phase->seconds += std::chrono::duration<double>(end - begin).count();
+        if (tracing)
+            TraceRecorder::getInstance().record(AnalysisStatistics::getPhaseName((AnalysisPhase) (phase - phases)),
+                                                "analysis", begin, end);
+    }
+
+public:
+    //phases is indexed by AnalysisPhase, it only needs to reach the phases that are timed
+    PhaseTimer(PhaseStatistics *phases, AnalysisPhase phase) :
+            phases(phases), phase(&phases[(int) phase]), timing(AnalysisStatistics::isTiming()),
+            tracing(TraceRecorder::isEnabled()), counting(AllocationTracker::isEnabled()) {
+        if (counting) outerPhase = AllocationTracker::setActivePhase(this->phase);
+        if (timing || tracing) begin = Clock::now();
+    }
+
+    PhaseTimer(AnalysisStatistics &statistics, AnalysisPhase phase) : PhaseTimer(statistics.phases, phase) {}
+
+    ~PhaseTimer() {
+        stop();
+    }
+
+    void next(AnalysisPhase nextPhase) {
+        if (phase == nullptr) return;
+        phase->calls++;
+        if (timing || tracing) {
+            Clock::time_point now = Clock::now();
+            finish(now);
+            begin = now;
+        }
+        phase = &phases[(int) nextPhase];
+        if (counting) AllocationTracker::setActivePhase(phase);
+    }
+
+    void stop() {
+        if (phase == nullptr) return;
+        phase->calls++;
+        if (timing || tracing) finish(Clock::now());
+        if (counting) AllocationTracker::setActivePhase(outerPhase);
+        phase = nullptr;
+    }
+
+    PhaseTimer(const PhaseTimer &) = delete;
+
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+};
+
+
+#endif //CIRCUITANALYZER_ANALYSISSTATISTICS_H
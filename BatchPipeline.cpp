@@ -0,0 +1,346 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include "BatchPipeline.h"
+#include "BoundedQueue.h"
+#include "NetlistParser.h"
+#include "MappedFile.h"
+#include "MeterReadout.h"
+#include "NonlinearSolver.h"
+#include "ThreadPool.h"
+#include "TraceRecorder.h"
+
+#ifndef _WIN32
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#else
+
+#include <windows.h>
+
+#endif
+
+//A circuit on its way through the pipeline, each stage fills in the next part
+class PipelineItem {
+public:
+    long index = 0;
+    Circuit circuit;
+    std::shared_ptr<const CircuitTopology> topology;
+    ComponentValues values;
+    std::unique_ptr<MeterReadout> readout;
+    std::unique_ptr<CompiledCircuit> compiledCircuit;
+    vector<int> branchIds;
+    vector<double> branchCurrents;
+    vector<double> meterReadings;
+    std::string error;
+};
+
+typedef std::unique_ptr<PipelineItem> ItemPointer;
+typedef BoundedQueue<ItemPointer> ItemQueue;
+typedef std::chrono::steady_clock Clock;
+
+//The first exception that stops the pipeline, every stage checks aborted while it waits
+class PipelineControl {
+public:
+    std::atomic<bool> aborted;
+    std::mutex errorMutex;
+    std::exception_ptr error = nullptr;
+
+    PipelineControl() : aborted(false) {}
+
+    void abort(std::exception_ptr exception) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (error == nullptr) error = exception;
+        aborted = true;
+    }
+};
+
+static double getSecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+//Spins briefly before sleeping, a queue usually changes within a few microseconds
+static void waitForQueue(int &attempt) {
+    if (attempt++ < 64) std::this_thread::yield();
+    else std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+//Takes the next item, false when the previous stage is done and the queue is empty or the pipeline was aborted
+static bool pop(ItemQueue &queue, ItemPointer &item, double &starvedSeconds, const PipelineControl &control) {
+    if (queue.tryPop(item)) return true;
+    TraceScope trace("starved", "pipeline");
+    Clock::time_point start = Clock::now();
+    bool popped = false;
+    for (int attempt = 0; !control.aborted; waitForQueue(attempt)) {
+        if (queue.tryPop(item)) {
+            popped = true;
+            break;
+        }
+        if (queue.isClosed()) {
+            popped = queue.tryPop(item);
+            break;
+        }
+    }
+    starvedSeconds += getSecondsSince(start);
+    return popped;
+}
+
+static bool push(ItemQueue &queue, ItemPointer &item, double &blockedSeconds, const PipelineControl &control) {
+    if (queue.tryPush(item)) return true;
+    TraceScope trace("blocked", "pipeline");
+    Clock::time_point start = Clock::now();
+    bool pushed = false;
+    for (int attempt = 0; !control.aborted; waitForQueue(attempt))
+        if (queue.tryPush(item)) {
+            pushed = true;
+            break;
+        }
+    blockedSeconds += getSecondsSince(start);
+    return pushed;
+}
+
+//Topology and values only need the Circuit, so it is released here; nonlinear circuits keep it for their solver
+static void assemble(PipelineItem &item, bool readMeters) {
+    Circuit &circuit = item.circuit;
+    if (circuit.hasNonlinearElements()) return;
+    auto topology = std::make_shared<CircuitTopology>(circuit);
+    item.values = topology->getValuesOf(circuit);
+    if (readMeters) {
+        item.readout.reset(new MeterReadout(circuit, topology));
+        if (item.readout->getNumberOfMeters() == 0) item.readout.reset();
+    }
+    item.topology = topology;
+    item.circuit = Circuit();
+}
+
+static void solve(PipelineItem &item) {
+    if (item.topology == nullptr) {
+        for (const auto &b : item.circuit.getBranches())
+            item.branchIds.push_back(b.getId());
+        item.branchCurrents = NonlinearSolver(item.circuit).solve();
+        item.circuit = Circuit();
+        return;
+    }
+    item.compiledCircuit.reset(new CompiledCircuit(item.topology));
+    item.compiledCircuit->refactor(item.values);
+    item.compiledCircuit->solve(item.branchCurrents);
+    if (item.readout != nullptr) item.readout->readAll(*item.compiledCircuit, item.branchCurrents, item.meterReadings);
+}
+
+static void write(ResultWriter &writer, const PipelineItem &item) {
+    static const vector<int> noIds;
+    static const vector<double> noValues;
+    if (!item.error.empty()) writer.writeError(item.index, item.error);
+    else if (item.compiledCircuit != nullptr)
+        writer.write(item.index, *item.compiledCircuit, item.branchCurrents, item.meterReadings);
+    else writer.write(item.index, item.branchIds, item.branchCurrents, noIds, noValues, item.meterReadings);
+}
+
+double StageStatistics::getCapacity() const {
+    return busySeconds > 0 ? numberOfItems * numberOfThreads / busySeconds : 0;
+}
+
+void StageStatistics::add(const StageStatistics &statistics) {
+    numberOfItems += statistics.numberOfItems;
+    numberOfFailures += statistics.numberOfFailures;
+    busySeconds += statistics.busySeconds;
+    starvedSeconds += statistics.starvedSeconds;
+    blockedSeconds += statistics.blockedSeconds;
+}
+
+void PipelineStatistics::print(std::ostream &os) const {
+    char line[160];
+    snprintf(line, sizeof(line), "%-10s %7s %10s %8s %10s %10s %10s %12s\n", "stage", "threads", "circuits",
+             "failed", "busy s", "starved s", "blocked s", "capacity/s");
+    os << line;
+    for (const auto &s : stages) {
+        snprintf(line, sizeof(line), "%-10s %7d %10ld %8ld %10.3f %10.3f %10.3f %12.1f\n", s.name.c_str(),
+                 s.numberOfThreads, s.numberOfItems, s.numberOfFailures, s.busySeconds, s.starvedSeconds,
+                 s.blockedSeconds, s.getCapacity());
+        os << line;
+    }
+    snprintf(line, sizeof(line), "%ld circuits, %ld failed, %.3f s, %.1f circuits/s\n", numberOfCircuits,
+             numberOfFailures, seconds, seconds > 0 ? numberOfCircuits / seconds : 0.0);
+    os << line;
+}
+
+BatchPipeline::BatchPipeline(const PipelineOptions &options) : options(options) {}
+
+const PipelineOptions &BatchPipeline::getOptions() const {
+    return options;
+}
+
+PipelineStatistics BatchPipeline::runFiles(const vector<std::string> &paths) const {
+    std::atomic<long> nextFile(0);
+    return run(options.parseThreads, [&](int, PipelineItem &item) -> bool {
+        long file = nextFile++;
+        if (file >= (long) paths.size()) return false;
+        item.index = file;
+        try {
+            item.circuit = NetlistParser::parseFile(paths[file]);
+        } catch (const std::exception &e) {
+            item.error = paths[file] + ": " + e.what();
+        }
+        return true;
+    });
+}
+
+//"-" reads the standard input
+PipelineStatistics BatchPipeline::runStream(const std::string &path) const {
+    std::unique_ptr<MappedFile> file;
+    std::unique_ptr<NetlistParser> parser;
+    if (path == "-") parser.reset(new NetlistParser(std::cin));
+    else {
+        file.reset(new MappedFile(path));
+        parser.reset(new NetlistParser(file->getData(), file->getData() + file->getSize()));
+    }
+    long index = 0;
+    return run(1, [&](int, PipelineItem &item) -> bool {
+        item.index = index;
+        try {
+            if (!parser->next(item.circuit)) return false;
+        } catch (const NetlistError &e) {
+            item.error = e.what();
+        }
+        index++;
+        return true;
+    });
+}
+
+//Regular files of a directory (not the hidden ones), sorted by name
+vector<std::string> BatchPipeline::listDirectory(const std::string &path) {
+    vector<std::string> names;
+#ifndef _WIN32
+    DIR *directory = opendir(path.c_str());
+    if (directory == nullptr) throw std::runtime_error("Can't open " + path + "!");
+    while (dirent *entry = readdir(directory)) {
+        if (entry->d_name[0] == '.') continue;
+        std::string name = path + "/" + entry->d_name;
+        struct stat status;
+        if (stat(name.c_str(), &status) == 0 && S_ISREG(status.st_mode)) names.push_back(name);
+    }
+    closedir(directory);
+#else
+    WIN32_FIND_DATAA entry;
+    HANDLE search = FindFirstFileA((path + "\\*").c_str(), &entry);
+    if (search == INVALID_HANDLE_VALUE) throw std::runtime_error("Can't open " + path + "!");
+    do {
+        if (entry.cFileName[0] == '.' || (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) continue;
+        names.push_back(path + "\\" + entry.cFileName);
+    } while (FindNextFileA(search, &entry));
+    FindClose(search);
+#endif
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+//One path per line, empty lines are skipped
+vector<std::string> BatchPipeline::readFileList(const std::string &path) {
+    std::ifstream list(path);
+    if (!list) throw std::runtime_error("Can't open " + path + "!");
+    vector<std::string> paths;
+    std::string line;
+    while (std::getline(list, line)) {
+        while (!line.empty() && isspace((unsigned char) line.back())) line.pop_back();
+        size_t start = 0;
+        while (start < line.size() && isspace((unsigned char) line[start])) start++;
+        if (start < line.size()) paths.push_back(line.substr(start));
+    }
+    return paths;
+}
+
+//The calling thread writes the results, the other stages get threads of their own
+PipelineStatistics BatchPipeline::run(int parseThreads,
+                                      const std::function<bool(int threadIndex, PipelineItem &item)> &parse) const {
+    const int numberOfStages = 4;
+    const char *names[numberOfStages] = {"parse", "assemble", "solve", "write"};
+    int threads[numberOfStages] = {std::max(1, parseThreads), std::max(1, options.assembleThreads),
+                                   ::getNumberOfThreads(options.solveThreads), 1};
+    ItemQueue parsed(options.queueCapacity), assembled(options.queueCapacity), solved(options.queueCapacity);
+    ItemQueue *inputs[numberOfStages] = {nullptr, &parsed, &assembled, &solved};
+    ItemQueue *outputs[numberOfStages] = {&parsed, &assembled, &solved, nullptr};
+    ResultWriter writer(options.outputPath, options.format);
+    writer.setColumns(options.columns);
+    PipelineControl control;
+    vector<vector<StageStatistics>> statistics(numberOfStages);
+    vector<std::unique_ptr<std::atomic<int>>> running;
+    for (int s = 0; s < numberOfStages; s++) {
+        statistics[s].resize(threads[s]);
+        running.emplace_back(new std::atomic<int>(threads[s]));
+    }
+
+    auto stage = [&](int s, int threadIndex) -> void {
+        StageStatistics &counters = statistics[s][threadIndex];
+        TraceRecorder::getInstance().setThreadName(threads[s] > 1 ? names[s] + (" " + std::to_string(threadIndex))
+                                                                  : names[s]);
+        try {
+            while (!control.aborted) {
+                ItemPointer item;
+                if (s == 0) {
+                    item.reset(new PipelineItem());
+                    TraceScope trace(names[s], "pipeline");
+                    Clock::time_point start = Clock::now();
+                    bool parsedOne = parse(threadIndex, *item);
+                    counters.busySeconds += getSecondsSince(start);
+                    if (!parsedOne) break;
+                } else if (!pop(*inputs[s], item, counters.starvedSeconds, control)) break;
+
+                Clock::time_point start = Clock::now();
+                bool failed = s > 0 && !item->error.empty();
+                if (s > 0) {
+                    TraceScope trace(names[s], "pipeline");
+                    if (!failed) {
+                        try {
+                            if (s == 1) assemble(*item, options.readMeters);
+                            else if (s == 2) solve(*item);
+                        } catch (const std::exception &e) {
+                            item->error = e.what();
+                        }
+                    }
+                    if (s == 3) write(writer, *item);
+                    counters.busySeconds += getSecondsSince(start);
+                }
+                counters.numberOfItems++;
+                if (!failed && !item->error.empty()) counters.numberOfFailures++;
+                if (s < 3 && !push(*outputs[s], item, counters.blockedSeconds, control)) break;
+            }
+        } catch (...) {
+            control.abort(std::current_exception());
+        }
+        if (--*running[s] == 0 && outputs[s] != nullptr) outputs[s]->close();
+    };
+
+    Clock::time_point start = Clock::now();
+    vector<std::thread> workers;
+    for (int s = 0; s < numberOfStages - 1; s++)
+        for (int t = 0; t < threads[s]; t++)
+            workers.emplace_back(stage, s, t);
+    stage(numberOfStages - 1, 0);
+    for (auto &w : workers)
+        w.join();
+    if (control.error != nullptr) std::rethrow_exception(control.error);
+    writer.close();
+
+    PipelineStatistics result;
+    result.seconds = getSecondsSince(start);
+    for (int s = 0; s < numberOfStages; s++) {
+        StageStatistics total;
+        total.name = names[s];
+        total.numberOfThreads = threads[s];
+        for (const auto &counters : statistics[s])
+            total.add(counters);
+        result.numberOfFailures += total.numberOfFailures;
+        result.stages.push_back(total);
+    }
+    result.numberOfCircuits = result.stages.back().numberOfItems;
+    return result;
+}
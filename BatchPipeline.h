@@ -0,0 +1,95 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_BATCHPIPELINE_H
+#define CIRCUITANALYZER_BATCHPIPELINE_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <functional>
+#include "ResultWriter.h"
+
+using std::vector;
+
+class PipelineOptions {
+public:
+    int parseThreads = 1;
+    int assembleThreads = 1;
+    int solveThreads = 0;                //0 is one per core
+    size_t queueCapacity = 64;           //circuits waiting between two stages
+    bool readMeters = true;
+    std::string outputPath = "-";
+    ResultFormat format = ResultFormat::CSV;
+    ResultColumns columns;
+};
+
+//Counters of one stage, the times are summed over its threads
+//starved: waiting for a circuit from the previous stage, blocked: waiting for room in the queue to the next one.
+//The capacity is the rate the stage would reach if it never waited, the smallest one is the bottleneck.
+
+class StageStatistics {
+public:
+    std::string name;
+    int numberOfThreads = 0;
+    long numberOfItems = 0;
+    long numberOfFailures = 0;
+    double busySeconds = 0;
+    double starvedSeconds = 0;
+    double blockedSeconds = 0;
+
+    double getCapacity() const;
+
+    void add(const StageStatistics &statistics);
+};
+
+class PipelineStatistics {
+public:
+    vector<StageStatistics> stages;
+    long numberOfCircuits = 0;
+    long numberOfFailures = 0;
+    double seconds = 0;
+
+    void print(std::ostream &os) const;
+};
+
+class PipelineItem;
+
+//Solves a batch of netlists in four stages that run at the same time, each on its own threads:
+//
+//  parse       netlist -> Circuit
+//  assemble    Circuit -> topology (through TopologyCache), component values and meter handles
+//  solve       numeric factorization, branch currents and meter readings
+//  write       ResultWriter, always one thread, results in completion order with the index of their netlist
+//
+//Stages pass circuits through BoundedQueue (lock-free). A stage that finds the next queue full waits, so at most
+//queueCapacity circuits wait between two stages and memory stays bounded however large the batch is; the Circuit
+//itself is released as soon as it is assembled. A netlist that can't be parsed or solved becomes an error result,
+//only a failure of the output stops the pipeline.
+//Files: one netlist per file, the index is the position in the list, files are parsed in parallel.
+//Stream: concatenated netlists each ended by .END, the index is their position in the stream, parsed by one thread.
+
+class BatchPipeline {
+    PipelineOptions options;
+
+public:
+    explicit BatchPipeline(const PipelineOptions &options);
+
+    const PipelineOptions &getOptions() const;
+
+    PipelineStatistics runFiles(const vector<std::string> &paths) const;
+
+    PipelineStatistics runStream(const std::string &path) const;
+
+    static vector<std::string> listDirectory(const std::string &path);
+
+    static vector<std::string> readFileList(const std::string &path);
+
+private:
+    PipelineStatistics run(int parseThreads,
+                           const std::function<bool(int threadIndex, PipelineItem &item)> &parse) const;
+};
+
+
+#endif //CIRCUITANALYZER_BATCHPIPELINE_H
@@ -0,0 +1,114 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <mutex>
+#include "BatchSolver.h"
+#include "MeterReadout.h"
+#include "NonlinearSolver.h"
+#include "ThreadPool.h"
+
+bool BatchResult::isSolved() const {
+    return error.empty();
+}
+
+BatchSolver::BatchSolver(int numberOfThreads) : numberOfThreads(::getNumberOfThreads(numberOfThreads)) {}
+
+int BatchSolver::getNumberOfThreads() const {
+    return numberOfThreads;
+}
+
+bool BatchSolver::isReadingMeters() const {
+    return readMeters;
+}
+
+void BatchSolver::setReadMeters(bool readMeters) {
+    BatchSolver::readMeters = readMeters;
+}
+
+const std::shared_ptr<SolutionCache> &BatchSolver::getSolutionCache() const {
+    return solutionCache;
+}
+
+void BatchSolver::setSolutionCache(const std::shared_ptr<SolutionCache> &solutionCache) {
+    BatchSolver::solutionCache = solutionCache;
+}
+
+BatchStatistics BatchSolver::solve(vector<Circuit> &circuits, const Consumer &consumer) const {
+    return solve(circuits.size(), [&](int index, BatchResult &result) -> void {
+        solveCircuit(circuits[index], result);
+    }, consumer);
+}
+
+//The loader runs on the worker threads, so reading and parsing of netlist files is spread over them as well
+BatchStatistics BatchSolver::solve(int numberOfCircuits, const Loader &loader, const Consumer &consumer) const {
+    return solve(numberOfCircuits, [&](int index, BatchResult &result) -> void {
+        Circuit circuit = loader(index);
+        solveCircuit(circuit, result);
+    }, consumer);
+}
+
+BatchStatistics BatchSolver::solve(int numberOfCircuits,
+                                   const std::function<void(int index, BatchResult &result)> &solveOne,
+                                   const Consumer &consumer) const {
+    int threads = std::max(1, std::min(numberOfThreads, numberOfCircuits));
+    vector<BatchResult> results(threads);
+    vector<long> solved(threads, 0), failed(threads, 0);
+    vector<AnalysisStatistics> phases(threads);
+    std::mutex consumerMutex;
+
+    long steals = parallelForStealing(numberOfCircuits, threads, [&](int threadIndex, int index) -> void {
+        BatchResult &result = results[threadIndex];
+        result.index = index;
+        result.threadIndex = threadIndex;
+        result.error.clear();
+        solveOne(index, result);
+        solved[threadIndex]++;
+        phases[threadIndex].addPhases(result.statistics);
+        if (!result.isSolved()) failed[threadIndex]++;
+        std::lock_guard<std::mutex> lock(consumerMutex);
+        consumer(result);
+    });
+
+    BatchStatistics statistics;
+    statistics.numberOfSteals = steals;
+    statistics.circuitsPerThread = solved;
+    for (int t = 0; t < threads; t++) {
+        statistics.numberOfCircuits += solved[t];
+        statistics.numberOfFailures += failed[t];
+        statistics.analysisStatistics.addPhases(phases[t]);
+    }
+    return statistics;
+}
+
+void BatchSolver::solveCircuit(Circuit &circuit, BatchResult &result) const {
+    result.branchIds.clear();
+    result.branchCurrents.clear();
+    result.meterReadings.clear();
+    result.statistics = AnalysisStatistics();
+    try {
+        for (const auto &b : circuit.getBranches())
+            result.branchIds.push_back(b.getId());
+        if (circuit.hasNonlinearElements()) {
+            NonlinearSolver solver(circuit);
+            result.branchCurrents = solver.solve();
+            result.statistics = solver.getAnalysisStatistics();
+            return;
+        }
+        bool hasMeters = !circuit.getVoltmeters().empty() || !circuit.getAmpermeters().empty() ||
+                         !circuit.getWattmeters().empty();
+        if (solutionCache != nullptr && !(readMeters && hasMeters)) {
+            result.branchCurrents = solutionCache->solve(circuit);
+            return;
+        }
+        CompiledCircuit compiledCircuit(circuit);
+        compiledCircuit.solve(result.branchCurrents);
+        result.statistics = compiledCircuit.getAnalysisStatistics();
+        if (!readMeters) return;
+        MeterReadout readout(circuit, compiledCircuit.getTopology());
+        if (readout.getNumberOfMeters() > 0)
+            readout.readAll(compiledCircuit, result.branchCurrents, result.meterReadings);
+    } catch (const std::exception &e) {
+        result.error = e.what();
+    }
+}
@@ -0,0 +1,84 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_BATCHSOLVER_H
+#define CIRCUITANALYZER_BATCHSOLVER_H
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <memory>
+#include "CircuitFingerprint.h"
+
+using std::vector;
+
+//Solution of one circuit of a batch
+//branchCurrents are in the order of the branches of the circuit, meterReadings in the order of MeterReadout
+//(voltmeters, ampermeters, wattmeters). If the circuit couldn't be solved, error holds the reason.
+
+class BatchResult {
+public:
+    int index = -1;
+    int threadIndex = 0;
+    vector<int> branchIds;
+    vector<double> branchCurrents;
+    vector<double> meterReadings;
+    AnalysisStatistics statistics;       //empty for circuits taken from the solution cache
+    std::string error;
+
+    bool isSolved() const;
+};
+
+class BatchStatistics {
+public:
+    long numberOfCircuits = 0;
+    long numberOfFailures = 0;
+    long numberOfSteals = 0;
+    vector<long> circuitsPerThread;
+    AnalysisStatistics analysisStatistics;   //phases of all circuits added up
+};
+
+//Solves many small independent circuits on a work-stealing pool (see parallelForStealing)
+//Every worker compiles and solves its circuits alone and reuses one BatchResult for all of them, so the result
+//buffers are allocated once per thread. The consumer is called with each result as soon as it is solved (completion
+//order, not index order), one call at a time; the result is only valid during the call.
+//Circuits with nonlinear elements are solved by NonlinearSolver and get no meter readings.
+//With a solution cache, linear circuits whose meters aren't read are looked up by fingerprint before solving.
+//A circuit that fails is reported through BatchResult::error and doesn't stop the batch, only an exception thrown
+//by the loader or the consumer does.
+
+class BatchSolver {
+    int numberOfThreads;
+    bool readMeters = true;
+    std::shared_ptr<SolutionCache> solutionCache;
+
+public:
+    typedef std::function<void(const BatchResult &result)> Consumer;
+    typedef std::function<Circuit(int index)> Loader;
+
+    explicit BatchSolver(int numberOfThreads = 0);
+
+    int getNumberOfThreads() const;
+
+    bool isReadingMeters() const;
+
+    void setReadMeters(bool readMeters);
+
+    const std::shared_ptr<SolutionCache> &getSolutionCache() const;
+
+    void setSolutionCache(const std::shared_ptr<SolutionCache> &solutionCache);
+
+    BatchStatistics solve(vector<Circuit> &circuits, const Consumer &consumer) const;
+
+    BatchStatistics solve(int numberOfCircuits, const Loader &loader, const Consumer &consumer) const;
+
+private:
+    BatchStatistics solve(int numberOfCircuits, const std::function<void(int index, BatchResult &result)> &solveOne,
+                          const Consumer &consumer) const;
+
+    void solveCircuit(Circuit &circuit, BatchResult &result) const;
+};
+
+
+#endif //CIRCUITANALYZER_BATCHSOLVER_H
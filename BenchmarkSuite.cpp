@@ -0,0 +1,256 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include "BenchmarkSuite.h"
+#include "ResultWriter.h"
+
+#ifdef __GLIBC__
+
+#include <malloc.h>
+
+#endif
+#if !defined(__linux__) && !defined(_WIN32)
+
+#include <sys/resource.h>
+
+#endif
+
+void BenchmarkTimer::start() {
+    if (AllocationTracker::isEnabled()) beginAllocations = AllocationTracker::getThreadCounters();
+    begin = std::chrono::steady_clock::now();
+}
+
+void BenchmarkTimer::stop() {
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    if (AllocationTracker::isEnabled()) {
+        AllocationCounters end = AllocationTracker::getThreadCounters();
+        allocations.allocations += end.allocations - beginAllocations.allocations;
+        allocations.bytes += end.bytes - beginAllocations.bytes;
+    }
+}
+
+double BenchmarkTimer::getSeconds() const {
+    return seconds;
+}
+
+const AllocationCounters &BenchmarkTimer::getAllocations() const {
+    return allocations;
+}
+
+//Sets the high-water mark of the resident set back to the current resident set
+//The heap freed by earlier measurements is given back first, or it would stay in the resident set and hide the
+//memory of the next ones.
+static void resetPeakResidentBytes() {
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+#ifdef __linux__
+    std::ofstream file("/proc/self/clear_refs");
+    file << "5";
+#endif
+}
+
+//Current or peak resident set of the process, 0 if unknown
+static long getResidentBytes(bool peak) {
+#if defined(__linux__)
+    std::ifstream file("/proc/self/status");
+    std::string line;
+    while (std::getline(file, line))
+        if (line.compare(0, 6, peak ? "VmHWM:" : "VmRSS:") == 0) return std::atol(line.c_str() + 6) * 1024;
+    return 0;
+#elif !defined(_WIN32)
+    if (!peak) return 0;
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return usage.ru_maxrss;                 //bytes on macOS
+#else
+    return 0;
+#endif
+}
+
+BenchmarkSuite::BenchmarkSuite(const BenchmarkOptions &options) : options(options) {}
+
+void BenchmarkSuite::add(const BenchmarkCase &benchmark) {
+    cases.push_back(benchmark);
+}
+
+const vector<BenchmarkCase> &BenchmarkSuite::getCases() const {
+    return cases;
+}
+
+GeneratorOptions BenchmarkSuite::getGeneratorOptions(CircuitFamily family, int numberOfBranches, uint64_t seed) {
+    GeneratorOptions generatorOptions;
+    generatorOptions.family = family;
+    generatorOptions.numberOfBranches = numberOfBranches;
+    generatorOptions.seed = seed;
+    generatorOptions.numberOfVoltageSources = 1 + numberOfBranches / 1000;
+    generatorOptions.numberOfCurrentSources = numberOfBranches / 1000;
+    return generatorOptions;
+}
+
+vector<BenchmarkResult> BenchmarkSuite::run(std::ostream *progress) const {
+    vector<BenchmarkResult> results;
+    vector<int> sizes = options.sizes;
+    std::sort(sizes.begin(), sizes.end());
+    for (CircuitFamily family : options.families) {
+        //(branches, seconds of the setup and one iteration) of every benchmark, to predict the next size
+        vector<vector<std::pair<double, double>>> history(cases.size());
+        vector<bool> stopped(cases.size(), false);
+        for (int size : sizes) {
+            CircuitArrays arrays = CircuitGenerator(getGeneratorOptions(family, size, options.seed)).generate();
+            for (int c = 0; c < cases.size(); c++) {
+                const BenchmarkCase &benchmark = cases[c];
+                if (benchmark.name.find(options.filter) == std::string::npos) continue;
+                BenchmarkResult result;
+                std::string reason;
+                int numberOfBranches = arrays.branchIds.size();
+                if (stopped[c]) reason = "too slow at a smaller size";
+                else if (history[c].size() >= 2) {
+                    const auto &first = history[c][history[c].size() - 2], &last = history[c].back();
+                    double exponent = std::log(last.second / first.second) / std::log(last.first / first.first);
+                    double predicted = last.second * std::pow(numberOfBranches / last.first, std::max(1.0, exponent));
+                    if (predicted > options.maxSeconds) {
+                        reason = "predicted to take longer than the time limit";
+                        stopped[c] = true;
+                    }
+                }
+                double cost = 0;
+                if (reason.empty()) {
+                    resetPeakResidentBytes();
+                    long startResidentBytes = getResidentBytes(false);
+                    BenchmarkTimer timer;
+                    timer.start();
+                    BenchmarkIteration iteration = benchmark.prepare(arrays, reason);
+                    timer.stop();
+                    if (iteration) result = measure(iteration);
+                    else if (reason.empty()) reason = "can't run on this circuit";
+                    cost = timer.getSeconds() + result.minSeconds;
+                    result.startResidentBytes = startResidentBytes;
+                    result.peakResidentBytes = getResidentBytes(true);
+                }
+                result.name = benchmark.name;
+                result.kind = benchmark.kind;
+                result.family = family;
+                result.numberOfBranches = numberOfBranches;
+                result.numberOfNodes = arrays.nodeIds.size();
+                result.skipped = reason;
+                if (reason.empty()) {
+                    history[c].emplace_back(numberOfBranches, std::max(cost, 1e-9));
+                    if (cost > options.maxSeconds) stopped[c] = true;
+                }
+                results.push_back(result);
+                if (progress) print({result}, *progress);
+            }
+        }
+    }
+    return results;
+}
+
+//Iterations are repeated for minSeconds of wall time, untimed setup included, so that a short routine after a long
+//setup doesn't run maxIterations times
+BenchmarkResult BenchmarkSuite::measure(const BenchmarkIteration &iteration) const {
+    vector<double> times;
+    double total = 0;
+    AllocationCounters allocations;
+    auto begin = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (elapsed < options.minSeconds && times.size() < options.maxIterations) {
+        BenchmarkTimer timer;
+        iteration(timer);
+        times.push_back(timer.getSeconds());
+        total += timer.getSeconds();
+        allocations.allocations += timer.getAllocations().allocations;
+        allocations.bytes += timer.getAllocations().bytes;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+    BenchmarkResult result;
+    result.iterations = times.size();
+    result.meanSeconds = total / times.size();
+    result.countedAllocations = AllocationTracker::isEnabled();
+    result.allocations = (double) allocations.allocations / times.size();
+    result.bytesAllocated = (double) allocations.bytes / times.size();
+    std::sort(times.begin(), times.end());
+    result.minSeconds = times.front();
+    result.medianSeconds = times[times.size() / 2];
+    return result;
+}
+
+void BenchmarkSuite::print(const vector<BenchmarkResult> &results, std::ostream &os) {
+    char line[300];
+    for (const auto &r : results) {
+        if (r.skipped.empty() && r.countedAllocations)
+            snprintf(line, sizeof(line), "%-32s %-7s %9d branches %9ld x  min %11.3e s  median %11.3e s  %10.0f "
+                                         "allocations %12.0f bytes\n", r.name.c_str(),
+                     CircuitGenerator::getFamilyName(r.family).c_str(), r.numberOfBranches, r.iterations,
+                     r.minSeconds, r.medianSeconds, r.allocations, r.bytesAllocated);
+        else if (r.skipped.empty())
+            snprintf(line, sizeof(line), "%-32s %-7s %9d branches %9ld x  min %11.3e s  median %11.3e s\n",
+                     r.name.c_str(), CircuitGenerator::getFamilyName(r.family).c_str(), r.numberOfBranches,
+                     r.iterations, r.minSeconds, r.medianSeconds);
+        else
+            snprintf(line, sizeof(line), "%-32s %-7s %9d branches  skipped: %s\n", r.name.c_str(),
+                     CircuitGenerator::getFamilyName(r.family).c_str(), r.numberOfBranches, r.skipped.c_str());
+        os << line;
+    }
+}
+
+static std::string getJsonNumber(double value) {
+    char text[32];
+    return std::string(text, formatShortest(value, text));
+}
+
+//One result per line, so that two versions can be compared with a line diff too
+void BenchmarkSuite::writeJson(const vector<BenchmarkResult> &results, const std::string &path) const {
+    std::ofstream file;
+    if (path != "-") {
+        file.open(path);
+        if (!file) throw std::runtime_error("Can't open " + path + "!");
+    }
+    std::ostream &os = path == "-" ? std::cout : file;
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+#ifdef NDEBUG
+    bool optimized = true;
+#else
+    bool optimized = false;
+#endif
+#ifdef __VERSION__
+    std::string compiler = __VERSION__;
+#else
+    std::string compiler = "unknown";
+#endif
+    os << "{\"benchmark\":\"circuit_bench\",\"version\":1,\n\"context\":{\"date\":\"" << date << "\",\"compiler\":"
+       << getJsonString(compiler) << ",\"ndebug\":" << (optimized ? "true" : "false") << ",\"seed\":"
+       << options.seed << ",\"minSeconds\":" << getJsonNumber(options.minSeconds) << ",\"maxSeconds\":"
+       << getJsonNumber(options.maxSeconds) << ",\"allocationTracking\":"
+       << (AllocationTracker::isEnabled() ? "true" : "false") << "},\n\"results\":[";
+    for (int i = 0; i < results.size(); i++) {
+        const BenchmarkResult &r = results[i];
+        os << (i ? ",\n" : "\n") << "{\"name\":" << getJsonString(r.name) << ",\"kind\":" << getJsonString(r.kind)
+           << ",\"family\":\"" << CircuitGenerator::getFamilyName(r.family) << "\",\"branches\":"
+           << r.numberOfBranches << ",\"nodes\":" << r.numberOfNodes;
+        if (r.skipped.empty()) {
+            os << ",\"iterations\":" << r.iterations << ",\"minSeconds\":" << getJsonNumber(r.minSeconds)
+               << ",\"medianSeconds\":" << getJsonNumber(r.medianSeconds) << ",\"meanSeconds\":"
+               << getJsonNumber(r.meanSeconds);
+            if (r.startResidentBytes > 0) os << ",\"startResidentBytes\":" << r.startResidentBytes;
+            if (r.peakResidentBytes > 0) os << ",\"peakResidentBytes\":" << r.peakResidentBytes;
+            if (r.countedAllocations)
+                os << ",\"allocations\":" << getJsonNumber(r.allocations) << ",\"bytesAllocated\":"
+                   << getJsonNumber(r.bytesAllocated);
+            os << "}";
+        } else os << ",\"skipped\":" << getJsonString(r.skipped) << "}";
+    }
+    os << "\n]}\n";
+    if (!os) throw std::runtime_error("Can't write " + path + "!");
+}
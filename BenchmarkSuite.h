@@ -0,0 +1,115 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_BENCHMARKSUITE_H
+#define CIRCUITANALYZER_BENCHMARKSUITE_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <ostream>
+#include <functional>
+#include "CircuitGenerator.h"
+#include "AllocationTracker.h"
+
+using std::vector;
+
+//Time of one iteration, only the work between start() and stop() counts
+//The allocations of the calling thread are counted the same way while AllocationTracker is on.
+class BenchmarkTimer {
+    std::chrono::steady_clock::time_point begin;
+    double seconds = 0;
+    AllocationCounters beginAllocations;
+    AllocationCounters allocations;
+public:
+    void start();
+
+    void stop();
+
+    double getSeconds() const;
+
+    const AllocationCounters &getAllocations() const;
+};
+
+typedef std::function<void(BenchmarkTimer &timer)> BenchmarkIteration;
+
+//prepare() makes the state of the benchmark for one generated circuit (not timed) and returns the iteration to
+//repeat. It returns an empty iteration and sets the reason when the benchmark can't run on that circuit.
+//kind is "micro" for one routine or "end-to-end" for a whole analysis.
+
+class BenchmarkCase {
+public:
+    std::string name;
+    std::string kind;
+    std::function<BenchmarkIteration(const CircuitArrays &arrays, std::string &reason)> prepare;
+};
+
+class BenchmarkResult {
+public:
+    std::string name;
+    std::string kind;
+    CircuitFamily family = CircuitFamily::GRID_2D;
+    int numberOfBranches = 0;
+    int numberOfNodes = 0;
+    long iterations = 0;
+    double minSeconds = 0;               //per iteration
+    double medianSeconds = 0;
+    double meanSeconds = 0;
+    bool countedAllocations = false;     //AllocationTracker was on
+    double allocations = 0;              //mean per iteration
+    double bytesAllocated = 0;
+    long startResidentBytes = 0;         //RSS of the process before the setup, 0 if unknown
+    long peakResidentBytes = 0;          //peak RSS of the process during setup and iterations, 0 if unknown
+    std::string skipped;                 //why the benchmark didn't run, empty if it did
+};
+
+class BenchmarkOptions {
+public:
+    vector<CircuitFamily> families = {CircuitFamily::GRID_2D, CircuitFamily::GRID_3D, CircuitFamily::LADDER,
+                                      CircuitFamily::RANDOM, CircuitFamily::TREE};
+    vector<int> sizes = {10, 30, 100, 300, 1000, 3000, 10000, 30000, 100000};
+    std::string filter;                  //only benchmarks whose name contains it
+    uint64_t seed = 1;
+    double minSeconds = 0.2;             //iterations are repeated for at least this long (wall time)
+    long maxIterations = 100000;
+    double maxSeconds = 5;               //sizes at which setup and one iteration would take longer are skipped
+};
+
+//Runs every benchmark on the circuits of every family and size, generated with the same seed
+//Sizes go up in order. Once a benchmark has run on two sizes of a family, the time of its setup and one iteration
+//at the next size is predicted from the exponent between them (at least linear), and the benchmark is skipped for
+//that family from the first size predicted or measured above maxSeconds, so slow routines stop before they take
+//minutes. Every measurement repeats the iteration until minSeconds have passed and keeps the minimum, median and
+//mean time of one iteration, and the mean allocations of one iteration while AllocationTracker is on.
+//The peak RSS of a measurement is the high-water mark of the whole process, reset before its setup on Linux
+//(elsewhere it only grows over the run, and is unknown on Windows). It includes what earlier measurements left in
+//the caches of the process, the memory of the measurement itself is the growth above the RSS before its setup.
+
+class BenchmarkSuite {
+    BenchmarkOptions options;
+    vector<BenchmarkCase> cases;
+
+public:
+    explicit BenchmarkSuite(const BenchmarkOptions &options);
+
+    void add(const BenchmarkCase &benchmark);
+
+    const vector<BenchmarkCase> &getCases() const;
+
+    //progress, if not null, gets one line per result
+    vector<BenchmarkResult> run(std::ostream *progress = nullptr) const;
+
+    //Circuits of a size: a pad and a load per thousand branches, as in a power grid
+    static GeneratorOptions getGeneratorOptions(CircuitFamily family, int numberOfBranches, uint64_t seed);
+
+    static void print(const vector<BenchmarkResult> &results, std::ostream &os);
+
+    void writeJson(const vector<BenchmarkResult> &results, const std::string &path) const;
+
+private:
+    BenchmarkResult measure(const BenchmarkIteration &iteration) const;
+};
+
+
+#endif //CIRCUITANALYZER_BENCHMARKSUITE_H
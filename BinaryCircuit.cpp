@@ -0,0 +1,433 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include "BinaryCircuit.h"
+#include "CircuitFingerprint.h"
+#include "MeterReadout.h"
+
+static const char MAGIC[8] = {'C', 'I', 'R', 'C', 'U', 'I', 'T', '\0'};
+
+//Hash of the 64-bit words of the data (the last one padded with zeros)
+uint64_t getChecksum(const void *data, size_t size) {
+    const char *bytes = static_cast<const char *>(data);
+    uint64_t checksum = mixHash(0, size);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        checksum = mixHash(checksum, word);
+    }
+    if (i < size) {
+        uint64_t word = 0;
+        memcpy(&word, bytes + i, size - i);
+        checksum = mixHash(checksum, word);
+    }
+    return checksum;
+}
+
+//Arrays of the file in section order, they are only written after the table with their offsets
+class SectionData {
+public:
+    BinarySectionType type;
+    uint32_t elementSize;
+    const void *data;
+    size_t count;
+};
+
+//Parallel arrays must have the same length
+template<typename Arrays>
+static void checkArrays(const Arrays &a) {
+    size_t numberOfBranches = a.branchIds.size();
+    size_t numberOfResistors = a.resistorIds.size(), numberOfVoltageSources = a.voltageSourceIds.size();
+    size_t numberOfCurrentSources = a.currentSourceIds.size(), numberOfCapacitors = a.capacitorIds.size();
+    size_t numberOfInductors = a.inductorIds.size();
+    if (a.firstNodes.size() != numberOfBranches || a.secondNodes.size() != numberOfBranches ||
+        a.fixedResistances.size() != numberOfBranches || a.resistorBranches.size() != numberOfResistors ||
+        a.resistances.size() != numberOfResistors || a.voltageSourceBranches.size() != numberOfVoltageSources ||
+        a.voltageSourceOrientations.size() != numberOfVoltageSources || a.voltages.size() != numberOfVoltageSources ||
+        a.currentSourceBranches.size() != numberOfCurrentSources ||
+        a.currentSourceOrientations.size() != numberOfCurrentSources || a.currents.size() != numberOfCurrentSources ||
+        a.capacitorBranches.size() != numberOfCapacitors || a.capacitances.size() != numberOfCapacitors ||
+        a.inductorBranches.size() != numberOfInductors || a.inductances.size() != numberOfInductors)
+        throw std::domain_error("Circuit file is corrupted!");
+}
+
+//Node and branch indices are only checked when they are about to be used
+template<typename Arrays>
+static void checkIndices(const Arrays &a) {
+    int numberOfNodes = a.nodeIds.size(), numberOfBranches = a.branchIds.size();
+    auto checkAll = [](const decltype(a.firstNodes) &indices, int size) -> void {
+        for (auto i : indices)
+            if (i < 0 || i >= size) throw std::domain_error("Circuit file is corrupted!");
+    };
+    checkAll(a.firstNodes, numberOfNodes);
+    checkAll(a.secondNodes, numberOfNodes);
+    checkAll(a.resistorBranches, numberOfBranches);
+    checkAll(a.voltageSourceBranches, numberOfBranches);
+    checkAll(a.currentSourceBranches, numberOfBranches);
+    checkAll(a.capacitorBranches, numberOfBranches);
+    checkAll(a.inductorBranches, numberOfBranches);
+    for (const auto &m : a.meters)
+        if (m.branch < 0 || m.branch >= numberOfBranches) throw std::domain_error("Circuit file is corrupted!");
+}
+
+//Meter branches are made by the meters themselves, in their place among the other branches
+template<typename Arrays>
+static Circuit buildCircuit(const Arrays &a) {
+    checkIndices(a);
+    int numberOfBranches = a.branchIds.size();
+    vector<int> branchMeters(numberOfBranches, -1);
+    for (int m = 0; m < a.meters.size(); m++)
+        if (a.meters[m].type != (int32_t) MeterType::WATTMETER) branchMeters[a.meters[m].branch] = m;
+
+    Circuit circuit;
+    vector<Branch> &branches = circuit.getBranches();
+    branches.reserve(numberOfBranches);
+    for (int b = 0; b < numberOfBranches; b++) {
+        int first = a.nodeIds[a.firstNodes[b]], second = a.nodeIds[a.secondNodes[b]];
+        if (branchMeters[b] < 0) {
+            branches.emplace_back(a.branchIds[b], Node(first), Node(second));
+            if (a.fixedResistances[b] != 0) branches.back().addResistor(Resistor(a.fixedResistances[b]));
+            continue;
+        }
+        const BinaryMeter &m = a.meters[branchMeters[b]];
+        if (m.type == (int32_t) MeterType::VOLTMETER)
+            circuit.addVoltmeterToCircuit(Voltmeter(m.id, m.internalResistance, m.naturalOrientation != 0),
+                                          m.firstNode, m.secondNode, a.branchIds[b]);
+        else
+            circuit.addAmpermeterToCircuit(Ampermeter(m.id, m.internalResistance, m.naturalOrientation != 0),
+                                           first, second, a.branchIds[b]);
+    }
+    for (int i = 0; i < a.resistorIds.size(); i++)
+        branches[a.resistorBranches[i]].addResistor(Resistor(a.resistances[i], a.resistorIds[i]));
+    for (int i = 0; i < a.voltageSourceIds.size(); i++)
+        branches[a.voltageSourceBranches[i]].addVoltageSource(
+                VoltageSource(a.voltageSourceIds[i], a.voltages[i], 0, a.voltageSourceOrientations[i] > 0));
+    for (int i = 0; i < a.currentSourceIds.size(); i++)
+        branches[a.currentSourceBranches[i]].addCurrentSource(
+                CurrentSource(a.currentSourceIds[i], a.currents[i], -1, a.currentSourceOrientations[i] > 0));
+    for (int i = 0; i < a.capacitorIds.size(); i++)
+        branches[a.capacitorBranches[i]].addCapacitor(Capacitor(a.capacitorIds[i], a.capacitances[i]));
+    for (int i = 0; i < a.inductorIds.size(); i++)
+        branches[a.inductorBranches[i]].addInductor(Inductor(a.inductorIds[i], a.inductances[i]));
+    for (const auto &m : a.meters)
+        if (m.type == (int32_t) MeterType::WATTMETER)
+            circuit.addWattmeterToCircuit(Wattmeter(m.id, a.branchIds[m.branch]));
+    return circuit;
+}
+
+Circuit toCircuit(const CircuitArrays &arrays) {
+    checkArrays(arrays);
+    return buildCircuit(arrays);
+}
+
+template<typename T>
+static SectionData getSectionData(BinarySectionType type, const vector<T> &array) {
+    return {type, sizeof(T), array.data(), array.size()};
+}
+
+CircuitArrays getCircuitArrays(Circuit &circuit) {
+    if (circuit.hasNonlinearElements()) throw std::domain_error("Nonlinear elements can't be stored!");
+    CircuitArrays a;
+    vector<Branch> &branches = circuit.getBranches();
+    for (const auto &n : circuit.getNodes())
+        a.nodeIds.push_back(n.getId());
+    auto getNodeIndex = [&](int id) -> int32_t {
+        return std::lower_bound(a.nodeIds.begin(), a.nodeIds.end(), id) - a.nodeIds.begin();
+    };
+
+    std::unordered_map<int, int> branchIndices;
+    for (int i = 0; i < branches.size(); i++) {
+        Branch &b = branches.at(i);
+        branchIndices.emplace(b.getId(), i);
+        a.branchIds.push_back(b.getId());
+        a.firstNodes.push_back(getNodeIndex(b.getFirstNode().getId()));
+        a.secondNodes.push_back(getNodeIndex(b.getSecondNode().getId()));
+        double fixedResistance = 0;
+        for (const auto &r : b.getResistors()) {
+            if (r.getId() != -1) {
+                a.resistorIds.push_back(r.getId());
+                a.resistorBranches.push_back(i);
+                a.resistances.push_back(r.getResistance());
+            } else if (r.hasInfiniteResistance() || fixedResistance < 0) fixedResistance = -1;
+            else fixedResistance += r.getResistance();
+        }
+        a.fixedResistances.push_back(fixedResistance);
+        for (const auto &v : b.getVoltageSources()) {
+            a.voltageSourceIds.push_back(v.getId());
+            a.voltageSourceBranches.push_back(i);
+            a.voltageSourceOrientations.push_back(v.isNaturalOrientation() ? 1 : -1);
+            a.voltages.push_back(v.getVoltage());
+        }
+        for (const auto &c : b.getCurrentSources()) {
+            a.currentSourceIds.push_back(c.getId());
+            a.currentSourceBranches.push_back(i);
+            a.currentSourceOrientations.push_back(c.isNaturalOrientation() ? 1 : -1);
+            a.currents.push_back(c.getCurrent());
+        }
+        for (const auto &c : b.getCapacitors()) {
+            a.capacitorIds.push_back(c.getId());
+            a.capacitorBranches.push_back(i);
+            a.capacitances.push_back(c.getCapacitance());
+        }
+        for (const auto &l : b.getInductors()) {
+            a.inductorIds.push_back(l.getId());
+            a.inductorBranches.push_back(i);
+            a.inductances.push_back(l.getInductance());
+        }
+    }
+
+    auto getBranchIndex = [&](int id) -> int32_t {
+        auto it = branchIndices.find(id);
+        if (it == branchIndices.end()) throw std::logic_error("Meter is not in the circuit!");
+        return it->second;
+    };
+    for (const auto &v : circuit.getVoltmeters())
+        a.meters.push_back({(int32_t) MeterType::VOLTMETER, v.getVoltmeter().getId(), getBranchIndex(v.getBranchId()),
+                            v.getVoltmeter().isNaturalOrientation(), v.getFirstNode().getId(),
+                            v.getSecondNode().getId(), v.getVoltmeter().getInternalResistance()});
+    for (const auto &m : circuit.getAmpermeters()) {
+        const Branch &b = m.getAmpermeterBranch();
+        a.meters.push_back({(int32_t) MeterType::AMPERMETER, m.getAmpermeter().getId(), getBranchIndex(b.getId()),
+                            m.getAmpermeter().isNaturalOrientation(), b.getFirstNode().getId(),
+                            b.getSecondNode().getId(), m.getAmpermeter().getInternalResistance()});
+    }
+    for (const auto &w : circuit.getWattmeters())
+        a.meters.push_back({(int32_t) MeterType::WATTMETER, w.getId(), getBranchIndex(w.getBranchId()), 1, 0, 0, 0});
+    return a;
+}
+
+void writeBinaryCircuit(Circuit &circuit, const std::string &path) {
+    writeBinaryCircuit(getCircuitArrays(circuit), path);
+}
+
+void writeBinaryCircuit(const CircuitArrays &a, const std::string &path) {
+    checkArrays(a);
+    vector<SectionData> data = {
+            getSectionData(BinarySectionType::NODE_IDS, a.nodeIds),
+            getSectionData(BinarySectionType::BRANCH_IDS, a.branchIds),
+            getSectionData(BinarySectionType::FIRST_NODES, a.firstNodes),
+            getSectionData(BinarySectionType::SECOND_NODES, a.secondNodes),
+            getSectionData(BinarySectionType::FIXED_RESISTANCES, a.fixedResistances),
+            getSectionData(BinarySectionType::RESISTOR_IDS, a.resistorIds),
+            getSectionData(BinarySectionType::RESISTOR_BRANCHES, a.resistorBranches),
+            getSectionData(BinarySectionType::RESISTANCES, a.resistances),
+            getSectionData(BinarySectionType::VOLTAGE_SOURCE_IDS, a.voltageSourceIds),
+            getSectionData(BinarySectionType::VOLTAGE_SOURCE_BRANCHES, a.voltageSourceBranches),
+            getSectionData(BinarySectionType::VOLTAGE_SOURCE_ORIENTATIONS, a.voltageSourceOrientations),
+            getSectionData(BinarySectionType::VOLTAGES, a.voltages),
+            getSectionData(BinarySectionType::CURRENT_SOURCE_IDS, a.currentSourceIds),
+            getSectionData(BinarySectionType::CURRENT_SOURCE_BRANCHES, a.currentSourceBranches),
+            getSectionData(BinarySectionType::CURRENT_SOURCE_ORIENTATIONS, a.currentSourceOrientations),
+            getSectionData(BinarySectionType::CURRENTS, a.currents),
+            getSectionData(BinarySectionType::CAPACITOR_IDS, a.capacitorIds),
+            getSectionData(BinarySectionType::CAPACITOR_BRANCHES, a.capacitorBranches),
+            getSectionData(BinarySectionType::CAPACITANCES, a.capacitances),
+            getSectionData(BinarySectionType::INDUCTOR_IDS, a.inductorIds),
+            getSectionData(BinarySectionType::INDUCTOR_BRANCHES, a.inductorBranches),
+            getSectionData(BinarySectionType::INDUCTANCES, a.inductances),
+            getSectionData(BinarySectionType::METERS, a.meters)};
+
+    vector<BinarySection> sections;
+    uint64_t offset = sizeof(BinaryCircuitHeader) + data.size() * sizeof(BinarySection);
+    for (const auto &d : data) {
+        offset = (offset + 7) / 8 * 8;
+        size_t size = d.count * d.elementSize;
+        sections.push_back({(uint32_t) d.type, d.elementSize, offset, d.count, getChecksum(d.data, size)});
+        offset += size;
+    }
+    BinaryCircuitHeader header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = MappedCircuit::VERSION;
+    header.numberOfSections = sections.size();
+    header.fileSize = offset;
+    header.tableChecksum = getChecksum(sections.data(), sections.size() * sizeof(BinarySection));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("Can't open " + path + "!");
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(sections.data()), sections.size() * sizeof(BinarySection));
+    const char padding[8] = {};
+    uint64_t written = sizeof(BinaryCircuitHeader) + sections.size() * sizeof(BinarySection);
+    for (int s = 0; s < sections.size(); s++) {
+        file.write(padding, sections[s].offset - written);
+        file.write(static_cast<const char *>(data[s].data), sections[s].count * sections[s].elementSize);
+        written = sections[s].offset + sections[s].count * sections[s].elementSize;
+    }
+    if (!file) throw std::runtime_error("Can't write " + path + "!");
+}
+
+MappedCircuit::MappedCircuit(const std::string &path, bool verifyChecksums) :
+        file(std::make_shared<MappedFile>(path)) {
+    const char *data = file->getData();
+    uint64_t size = file->getSize();
+    BinaryCircuitHeader header;
+    if (size < sizeof(header)) throw std::domain_error("Not a circuit file!");
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) throw std::domain_error("Not a circuit file!");
+    if (header.version != VERSION) throw std::domain_error("Unsupported circuit file version!");
+    if (header.fileSize != size) throw std::domain_error("Circuit file is truncated!");
+    if (header.numberOfSections > (size - sizeof(header)) / sizeof(BinarySection))
+        throw std::domain_error("Circuit file is corrupted!");
+    sections.resize(header.numberOfSections);
+    memcpy(sections.data(), data + sizeof(header), sections.size() * sizeof(BinarySection));
+    if (getChecksum(sections.data(), sections.size() * sizeof(BinarySection)) != header.tableChecksum)
+        throw std::domain_error("Circuit file is corrupted!");
+    for (const auto &s : sections)
+        if (s.elementSize == 0 || s.offset % 8 != 0 || s.offset > size || s.count > (size - s.offset) / s.elementSize)
+            throw std::domain_error("Circuit file is corrupted!");
+
+    arrays.nodeIds = getSection<int32_t>(BinarySectionType::NODE_IDS);
+    arrays.branchIds = getSection<int32_t>(BinarySectionType::BRANCH_IDS);
+    arrays.firstNodes = getSection<int32_t>(BinarySectionType::FIRST_NODES);
+    arrays.secondNodes = getSection<int32_t>(BinarySectionType::SECOND_NODES);
+    arrays.fixedResistances = getSection<double>(BinarySectionType::FIXED_RESISTANCES);
+    arrays.resistorIds = getSection<int32_t>(BinarySectionType::RESISTOR_IDS);
+    arrays.resistorBranches = getSection<int32_t>(BinarySectionType::RESISTOR_BRANCHES);
+    arrays.resistances = getSection<double>(BinarySectionType::RESISTANCES);
+    arrays.voltageSourceIds = getSection<int32_t>(BinarySectionType::VOLTAGE_SOURCE_IDS);
+    arrays.voltageSourceBranches = getSection<int32_t>(BinarySectionType::VOLTAGE_SOURCE_BRANCHES);
+    arrays.voltageSourceOrientations = getSection<int32_t>(BinarySectionType::VOLTAGE_SOURCE_ORIENTATIONS);
+    arrays.voltages = getSection<double>(BinarySectionType::VOLTAGES);
+    arrays.currentSourceIds = getSection<int32_t>(BinarySectionType::CURRENT_SOURCE_IDS);
+    arrays.currentSourceBranches = getSection<int32_t>(BinarySectionType::CURRENT_SOURCE_BRANCHES);
+    arrays.currentSourceOrientations = getSection<int32_t>(BinarySectionType::CURRENT_SOURCE_ORIENTATIONS);
+    arrays.currents = getSection<double>(BinarySectionType::CURRENTS);
+    arrays.capacitorIds = getSection<int32_t>(BinarySectionType::CAPACITOR_IDS);
+    arrays.capacitorBranches = getSection<int32_t>(BinarySectionType::CAPACITOR_BRANCHES);
+    arrays.capacitances = getSection<double>(BinarySectionType::CAPACITANCES);
+    arrays.inductorIds = getSection<int32_t>(BinarySectionType::INDUCTOR_IDS);
+    arrays.inductorBranches = getSection<int32_t>(BinarySectionType::INDUCTOR_BRANCHES);
+    arrays.inductances = getSection<double>(BinarySectionType::INDUCTANCES);
+    arrays.meters = getSection<BinaryMeter>(BinarySectionType::METERS);
+
+    checkArrays(arrays);
+    if (verifyChecksums) this->verifyChecksums();
+}
+
+//Reads every array once, throws if one of them doesn't match its checksum
+void MappedCircuit::verifyChecksums() const {
+    for (const auto &s : sections)
+        if (getChecksum(file->getData() + s.offset, s.count * s.elementSize) != s.checksum)
+            throw std::domain_error("Circuit file is corrupted!");
+}
+
+template<typename T>
+ArrayView<T> MappedCircuit::getSection(BinarySectionType type) const {
+    for (const auto &s : sections) {
+        if (s.type != (uint32_t) type) continue;
+        if (s.elementSize != sizeof(T)) throw std::domain_error("Circuit file is corrupted!");
+        return ArrayView<T>(reinterpret_cast<const T *>(file->getData() + s.offset), s.count);
+    }
+    throw std::domain_error("Circuit file is corrupted!");
+}
+
+int MappedCircuit::getNumberOfNodes() const {
+    return arrays.nodeIds.size();
+}
+
+int MappedCircuit::getNumberOfBranches() const {
+    return arrays.branchIds.size();
+}
+
+const ArrayView<int32_t> &MappedCircuit::getNodeIds() const {
+    return arrays.nodeIds;
+}
+
+const ArrayView<int32_t> &MappedCircuit::getBranchIds() const {
+    return arrays.branchIds;
+}
+
+const ArrayView<int32_t> &MappedCircuit::getFirstNodes() const {
+    return arrays.firstNodes;
+}
+
+const ArrayView<int32_t> &MappedCircuit::getSecondNodes() const {
+    return arrays.secondNodes;
+}
+
+const ArrayView<double> &MappedCircuit::getResistances() const {
+    return arrays.resistances;
+}
+
+const ArrayView<double> &MappedCircuit::getVoltages() const {
+    return arrays.voltages;
+}
+
+const ArrayView<double> &MappedCircuit::getCurrents() const {
+    return arrays.currents;
+}
+
+const ArrayView<BinaryMeter> &MappedCircuit::getMeters() const {
+    return arrays.meters;
+}
+
+const CircuitArraysOf<ArrayView> &MappedCircuit::getArrays() const {
+    return arrays;
+}
+
+Circuit MappedCircuit::toCircuit() const {
+    return buildCircuit(arrays);
+}
+
+//Same topology as CircuitTopology(toCircuit(), dynamic), made from the arrays without building the circuit
+std::shared_ptr<const CircuitTopology> MappedCircuit::getTopology(bool dynamic) const {
+    const CircuitArraysOf<ArrayView> &a = arrays;
+    checkIndices(a);
+    int numberOfBranches = getNumberOfBranches();
+    std::shared_ptr<CircuitTopology> topology(new CircuitTopology(dynamic));
+    CircuitTopology &t = *topology;
+    PhaseTimer timer(t.phases, AnalysisPhase::TOPOLOGY);
+    t.nodeIds.assign(a.nodeIds.begin(), a.nodeIds.end());
+    t.branchIds.assign(a.branchIds.begin(), a.branchIds.end());
+    t.firstNodes.assign(a.firstNodes.begin(), a.firstNodes.end());
+    t.secondNodes.assign(a.secondNodes.begin(), a.secondNodes.end());
+    t.fixedResistances.resize(numberOfBranches);
+    t.currentFixed.resize(numberOfBranches);
+    for (int b = 0; b < numberOfBranches; b++) {
+        t.currentFixed[b] = a.fixedResistances[b] < 0;
+        t.fixedResistances[b] = a.fixedResistances[b] < 0 ? 0 : a.fixedResistances[b];
+    }
+
+    t.resistorIds.assign(a.resistorIds.begin(), a.resistorIds.end());
+    t.resistorBranches.assign(a.resistorBranches.begin(), a.resistorBranches.end());
+    for (int i = 0; i < a.resistorIds.size(); i++)
+        if (fabs(a.resistances[i] + 1) < EPSILON) t.currentFixed[a.resistorBranches[i]] = true;
+    t.voltageSourceIds.assign(a.voltageSourceIds.begin(), a.voltageSourceIds.end());
+    t.voltageSourceBranches.assign(a.voltageSourceBranches.begin(), a.voltageSourceBranches.end());
+    t.voltageSourceOrientations.assign(a.voltageSourceOrientations.begin(), a.voltageSourceOrientations.end());
+    t.currentSourceIds.assign(a.currentSourceIds.begin(), a.currentSourceIds.end());
+    t.currentSourceBranches.assign(a.currentSourceBranches.begin(), a.currentSourceBranches.end());
+    t.currentSourceOrientations.assign(a.currentSourceOrientations.begin(), a.currentSourceOrientations.end());
+    t.branchCurrentSource.assign(numberOfBranches, -1);
+    for (int i = 0; i < a.currentSourceIds.size(); i++) {
+        int b = a.currentSourceBranches[i];
+        if (t.branchCurrentSource[b] < 0) t.branchCurrentSource[b] = i;
+        t.currentFixed[b] = true;
+    }
+    t.capacitorIds.assign(a.capacitorIds.begin(), a.capacitorIds.end());
+    t.capacitorBranches.assign(a.capacitorBranches.begin(), a.capacitorBranches.end());
+    if (!dynamic)
+        for (auto b : a.capacitorBranches)
+            t.currentFixed[b] = true;
+    t.inductorIds.assign(a.inductorIds.begin(), a.inductorIds.end());
+    t.inductorBranches.assign(a.inductorBranches.begin(), a.inductorBranches.end());
+
+    t.analyse(timer);
+    return topology;
+}
+
+//Values in the order of getTopology(), sources with their orientation kept in the topology
+ComponentValues MappedCircuit::getValues() const {
+    ComponentValues values;
+    values.resistances.assign(arrays.resistances.begin(), arrays.resistances.end());
+    values.voltages.assign(arrays.voltages.begin(), arrays.voltages.end());
+    values.currents.assign(arrays.currents.begin(), arrays.currents.end());
+    values.capacitances.assign(arrays.capacitances.begin(), arrays.capacitances.end());
+    values.inductances.assign(arrays.inductances.begin(), arrays.inductances.end());
+    return values;
+}
@@ -0,0 +1,180 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_BINARYCIRCUIT_H
+#define CIRCUITANALYZER_BINARYCIRCUIT_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "CompiledCircuit.h"
+#include "MappedFile.h"
+
+using std::vector;
+
+//Binary circuit file, version 1 (native byte order, little endian on every supported platform)
+//
+//  header      magic "CIRCUIT\0", version, number of sections, file size, checksum of the section table
+//  sections    one table entry per array: type, element size, offset, count and checksum of the bytes
+//
+//Every array starts on an 8 byte boundary. Nodes are a sorted table of node ids, branches are parallel arrays
+//(id, first and second node index, resistance of the parasite resistors, -1 if one of them is infinite), every
+//component type is a set of parallel arrays (id, branch index, orientation for sources, value) like in
+//CircuitTopology. Meters are records pointing to their branch. Voltage sources are stored ideal, their internal
+//resistance is one of the parasite resistors of their branch. Circuits with nonlinear elements can't be stored.
+
+enum class BinarySectionType : uint32_t {
+    NODE_IDS, BRANCH_IDS, FIRST_NODES, SECOND_NODES, FIXED_RESISTANCES,
+    RESISTOR_IDS, RESISTOR_BRANCHES, RESISTANCES,
+    VOLTAGE_SOURCE_IDS, VOLTAGE_SOURCE_BRANCHES, VOLTAGE_SOURCE_ORIENTATIONS, VOLTAGES,
+    CURRENT_SOURCE_IDS, CURRENT_SOURCE_BRANCHES, CURRENT_SOURCE_ORIENTATIONS, CURRENTS,
+    CAPACITOR_IDS, CAPACITOR_BRANCHES, CAPACITANCES,
+    INDUCTOR_IDS, INDUCTOR_BRANCHES, INDUCTANCES,
+    METERS, NUMBER_OF_SECTIONS
+};
+
+class BinaryCircuitHeader {
+public:
+    char magic[8];
+    uint32_t version;
+    uint32_t numberOfSections;
+    uint64_t fileSize;
+    uint64_t tableChecksum;
+};
+
+class BinarySection {
+public:
+    uint32_t type;
+    uint32_t elementSize;
+    uint64_t offset;
+    uint64_t count;
+    uint64_t checksum;
+};
+
+//type is a MeterType, a voltmeter reads V(second) - V(first) between node ids, ampermeters and wattmeters belong
+//to their branch
+class BinaryMeter {
+public:
+    int32_t type;
+    int32_t id;
+    int32_t branch;
+    int32_t naturalOrientation;
+    int32_t firstNode;
+    int32_t secondNode;
+    double internalResistance;
+};
+
+//Read-only array inside a mapped file
+template<typename T>
+class ArrayView {
+    const T *data = nullptr;
+    size_t count = 0;
+public:
+    ArrayView() = default;
+
+    ArrayView(const T *data, size_t count) : data(data), count(count) {}
+
+    const T &operator[](size_t i) const {
+        return data[i];
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    const T *begin() const {
+        return data;
+    }
+
+    const T *end() const {
+        return data + count;
+    }
+};
+
+//The arrays of a binary circuit file, owned (CircuitArrays) or inside a mapped file (CircuitArraysOf<ArrayView>)
+template<template<typename...> class Array>
+class CircuitArraysOf {
+public:
+    Array<int32_t> nodeIds, branchIds, firstNodes, secondNodes;
+    Array<double> fixedResistances;
+    Array<int32_t> resistorIds, resistorBranches;
+    Array<double> resistances;
+    Array<int32_t> voltageSourceIds, voltageSourceBranches, voltageSourceOrientations;
+    Array<double> voltages;
+    Array<int32_t> currentSourceIds, currentSourceBranches, currentSourceOrientations;
+    Array<double> currents;
+    Array<int32_t> capacitorIds, capacitorBranches;
+    Array<double> capacitances;
+    Array<int32_t> inductorIds, inductorBranches;
+    Array<double> inductances;
+    Array<BinaryMeter> meters;
+};
+
+typedef CircuitArraysOf<std::vector> CircuitArrays;
+
+uint64_t getChecksum(const void *data, size_t size);
+
+CircuitArrays getCircuitArrays(Circuit &circuit);
+
+Circuit toCircuit(const CircuitArrays &arrays);
+
+void writeBinaryCircuit(Circuit &circuit, const std::string &path);
+
+//Writes arrays made without a Circuit (CircuitGenerator), they have to be consistent like the ones of a Circuit
+void writeBinaryCircuit(const CircuitArrays &arrays, const std::string &path);
+
+//A binary circuit file mapped into memory, the arrays are used in place (shared between processes by the page cache)
+//Opening checks the header and the bounds of every section, the checksums of the arrays are only verified when asked
+//for, so opening doesn't touch the data. toCircuit() builds a regular Circuit, getTopology() and getValues() go
+//straight to a CompiledCircuit without one.
+
+class MappedCircuit {
+    std::shared_ptr<MappedFile> file;
+    vector<BinarySection> sections;
+
+    CircuitArraysOf<ArrayView> arrays;
+
+public:
+    static const uint32_t VERSION = 1;
+
+    explicit MappedCircuit(const std::string &path, bool verifyChecksums = false);
+
+    void verifyChecksums() const;
+
+    int getNumberOfNodes() const;
+
+    int getNumberOfBranches() const;
+
+    const ArrayView<int32_t> &getNodeIds() const;
+
+    const ArrayView<int32_t> &getBranchIds() const;
+
+    const ArrayView<int32_t> &getFirstNodes() const;
+
+    const ArrayView<int32_t> &getSecondNodes() const;
+
+    const ArrayView<double> &getResistances() const;
+
+    const ArrayView<double> &getVoltages() const;
+
+    const ArrayView<double> &getCurrents() const;
+
+    const ArrayView<BinaryMeter> &getMeters() const;
+
+    const CircuitArraysOf<ArrayView> &getArrays() const;
+
+    Circuit toCircuit() const;
+
+    std::shared_ptr<const CircuitTopology> getTopology(bool dynamic = false) const;
+
+    ComponentValues getValues() const;
+
+private:
+    template<typename T>
+    ArrayView<T> getSection(BinarySectionType type) const;
+};
+
+
+#endif //CIRCUITANALYZER_BINARYCIRCUIT_H
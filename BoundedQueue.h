@@ -0,0 +1,100 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_BOUNDEDQUEUE_H
+#define CIRCUITANALYZER_BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+//Bounded lock-free queue for many producers and many consumers (Vyukov's ring of sequenced cells)
+//Every cell carries a sequence number telling whether it is free for the producer of a position or full for its
+//consumer, so a push or a pop is one compare-and-swap on a position counter and never waits for another thread.
+//The capacity is rounded up to a power of two. tryPush and tryPop return false instead of blocking when the queue is
+//full or empty, the caller decides how to wait. close() tells consumers that no more values will come.
+
+template<typename T>
+class BoundedQueue {
+    class Cell {
+    public:
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    char padding0[64];
+    std::atomic<size_t> pushPosition;
+    char padding1[64];
+    std::atomic<size_t> popPosition;
+    char padding2[64];
+    std::atomic<bool> closed;
+
+public:
+    explicit BoundedQueue(size_t capacity) : pushPosition(0), popPosition(0), closed(false) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    size_t getCapacity() const {
+        return mask + 1;
+    }
+
+    //Moves value into the queue, value is left untouched if the queue is full
+    bool tryPush(T &value) {
+        size_t position = pushPosition.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &cells[position & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t) sequence - (intptr_t) position;
+            if (difference == 0) {
+                if (pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (difference < 0) return false;
+            else position = pushPosition.load(std::memory_order_relaxed);
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T &value) {
+        size_t position = popPosition.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &cells[position & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t) sequence - (intptr_t) (position + 1);
+            if (difference == 0) {
+                if (popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (difference < 0) return false;
+            else position = popPosition.load(std::memory_order_relaxed);
+        }
+        value = std::move(cell->value);
+        cell->sequence.store(position + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    void close() {
+        closed.store(true, std::memory_order_release);
+    }
+
+    //A consumer that finds the queue closed has to try one more pop, a value may have come just before close()
+    bool isClosed() const {
+        return closed.load(std::memory_order_acquire);
+    }
+};
+
+
+#endif //CIRCUITANALYZER_BOUNDEDQUEUE_H
@@ -5,7 +5,11 @@
 #include <algorithm>
 #include <QTextStream>
 #include "Circuit.h"
-#include "CMatrix.h"
+#include "CompiledCircuit.h"
+#include "AcAnalysis.h"
+#include "NonlinearSolver.h"
+#include "MeterReadout.h"
+#include "PowerAccounting.h"
 
 Circuit::Circuit(const vector<Branch> &branches) {
     this->branches = branches;
@@ -218,22 +222,60 @@ void Circuit::addCurrentSourceToCircuit(CurrentSource c, int firstNodeID, int se
     addBranch(newBranch);
 }
 
-void Circuit::addVoltmeterToCircuit(Voltmeter v, int firstNodeID, int secondNodeID) {
+void Circuit::addCapacitorToCircuit(const Capacitor &c, int firstNodeID, int secondNodeID) {
+    Branch newBranch(getAvailableBranchId(), Node(firstNodeID), Node(secondNodeID));
+    newBranch.addCapacitor(c);
+    addBranch(newBranch);
+}
+
+void Circuit::addInductorToCircuit(const Inductor &l, int firstNodeID, int secondNodeID) {
+    Branch newBranch(getAvailableBranchId(), Node(firstNodeID), Node(secondNodeID));
+    newBranch.addInductor(l);
+    addBranch(newBranch);
+}
+
+void Circuit::addNonlinearElementToCircuit(const std::shared_ptr<const NonlinearElement> &e, int firstNodeID,
+                                           int secondNodeID) {
     Branch newBranch(getAvailableBranchId(), Node(firstNodeID), Node(secondNodeID));
+    newBranch.addNonlinearElement(e);
+    addBranch(newBranch);
+}
+
+bool Circuit::hasNonlinearElements() {
+    for (const auto &b : branches)
+        if (b.hasNonlinearElements()) return true;
+    return false;
+}
+
+//Wrappers keep the ids of the meter branches, the readings are computed on demand by readMeters()
+void Circuit::addVoltmeterToCircuit(Voltmeter v, int firstNodeID, int secondNodeID) {
+    addVoltmeterToCircuit(v, firstNodeID, secondNodeID, getAvailableBranchId());
+}
+
+//Meter branch with a given id, for circuits restored with their original branch ids
+void Circuit::addVoltmeterToCircuit(Voltmeter v, int firstNodeID, int secondNodeID, int branchId) {
+    Branch newBranch(branchId, Node(firstNodeID), Node(secondNodeID));
     newBranch.addResistor(Resistor(v.getInternalResistance()));
     addBranch(newBranch);
 
-    VoltmeterWrapper voltmeterWrapper(v, Node(firstNodeID), Node(secondNodeID), &newBranch.getResistors().front());
-    voltmeters.push_back(voltmeterWrapper);
+    voltmeters.emplace_back(v, Node(firstNodeID), Node(secondNodeID), newBranch.getId());
 }
 
+//an ideal ampermeter is a short circuit
 void Circuit::addAmpermeterToCircuit(Ampermeter a, int firstNodeID, int secondNodeID) {
-    Branch newBranch(getAvailableBranchId(), Node(firstNodeID), Node(secondNodeID));
-    newBranch.addResistor(Resistor(a.getInternalResistance()));
+    addAmpermeterToCircuit(a, firstNodeID, secondNodeID, getAvailableBranchId());
+}
+
+void Circuit::addAmpermeterToCircuit(Ampermeter a, int firstNodeID, int secondNodeID, int branchId) {
+    Branch newBranch(branchId, Node(firstNodeID), Node(secondNodeID));
+    newBranch.addResistor(Resistor(a.isIdeal() ? 0 : a.getInternalResistance()));
     addBranch(newBranch);
 
-    AmpermeterWrapper ampermeterWrapper(a, newBranch, &newBranch.getResistors().front());
-    ampermeters.push_back(ampermeterWrapper);
+    ampermeters.emplace_back(a, newBranch);
+}
+
+void Circuit::addWattmeterToCircuit(const Wattmeter &w) {
+    wattmeters.push_back(w);
 }
 
 //Returns all branches in the circuit that do not have Current Source
@@ -550,7 +592,20 @@ std::vector<std::vector<double>> Circuit::secondKirchoffsLaw() {
 
 vector<double> Circuit::measureCurrentsOfACircuit(){
     vector<double> currentsInTheCircuit = {};
+    if(hasNonlinearElements()){
+        //Newton-Raphson over the same compiled circuit, see NonlinearSolver
+        NonlinearSolver solver(*this);
+        currentsInTheCircuit = solver.solve();
+        analysisStatistics = solver.getAnalysisStatistics();
+        PhaseTimer timer(analysisStatistics, AnalysisPhase::OUTPUT);
+        for(int i = 0; i < getNumberOfBranches(); i++)
+            branches.at(i).setCurrent(currentsInTheCircuit.at(i));
+        return currentsInTheCircuit;
+    }
     if(getNumberOfBranches()==1){
+        analysisStatistics = AnalysisStatistics();
+        analysisStatistics.numberOfBranches = 1;
+        analysisStatistics.numberOfNodes = getNumberOfNodes();
         if(getBranches().at(0).hasCurrentSources()){
             currentsInTheCircuit.push_back(getBranches().at(0).getCurrentFromCurrentSources());
             return currentsInTheCircuit;
@@ -563,75 +618,144 @@ vector<double> Circuit::measureCurrentsOfACircuit(){
             return currentsInTheCircuit;
         }
     }
-    vector<vector<int>> firstKirchoffsLawMatrix = firstKirchhoffsLaw();
-    vector<vector<double>> secondKirchoffsLawMatrix = secondKirchoffsLaw();
-    firstKirchoffsLawMatrix.erase(firstKirchoffsLawMatrix.begin()+firstKirchoffsLawMatrix.size()-1);
-    int numberOfEquations = firstKirchoffsLawMatrix.size() + secondKirchoffsLawMatrix.size();
-
-
-
-
+    //topology, equation pattern and factorization are done by the compiled circuit
+    CompiledCircuit compiledCircuit(*this);
+    currentsInTheCircuit = compiledCircuit.solve();
+    analysisStatistics = compiledCircuit.getAnalysisStatistics();
 
+   //set currents
+   PhaseTimer timer(analysisStatistics, AnalysisPhase::OUTPUT);
+   for(int i = 0; i < getNumberOfBranches(); i++){
+       branches.at(i).setCurrent(currentsInTheCircuit.at(i));
+   }
 
-    vector<vector<double>> equationMatrix;
+    return currentsInTheCircuit;
+    
+}
 
-    for(auto i : secondKirchoffsLawMatrix){
-        vector<double> vectorRow;
-        vectorRow.clear();
-        for(auto j : i){
-            if(j == i.at(i.size()-1))break;
-            else vectorRow.push_back(j);
-        }
-        equationMatrix.push_back(vectorRow);
-    }
+const AnalysisStatistics &Circuit::getAnalysisStatistics() const {
+    return analysisStatistics;
+}
 
-   for(auto i : firstKirchoffsLawMatrix){
-       vector<double> vectorRow;
-       vectorRow.clear();
-       for(auto j : i){
-           vectorRow.push_back((double) j);
-       }
-       equationMatrix.push_back(vectorRow);
-   }
+//Solves the circuit once and writes the reading of every meter into its wrapper
+void Circuit::readMeters() {
+    if (hasNonlinearElements()) throw std::domain_error("Meter readout needs a linear circuit!");
+    CompiledCircuit compiledCircuit(*this);
+    MeterReadout readout(*this, compiledCircuit.getTopology());
+    vector<double> readings;
+    readout.readAll(compiledCircuit, compiledCircuit.solve(), readings);
+    int m = 0;
+    for (auto &v : voltmeters)
+        v.getVoltmeter().setVoltage(readings[m++]);
+    for (auto &a : ampermeters)
+        a.getAmpermeter().setCurrent(readings[m++]);
+    for (auto &w : wattmeters)
+        w.setPower(readings[m++]);
+}
 
+//Readings of all ampermeters, in the order in which they were added
+vector<double> Circuit::getMeasuredCurrents() {
+    readMeters();
+    vector<double> currents;
+    for (const auto &a : ampermeters)
+        currents.push_back(a.getAmpermeter().getCurrent());
+    return currents;
+}
 
-   CMatrix finalMatrix("finalMatrixOfEquations", equationMatrix.size(), getNumberOfBranches());
+//Readings of all voltmeters, in the order in which they were added
+vector<double> Circuit::getMeasuredVoltages() {
+    readMeters();
+    vector<double> voltages;
+    for (const auto &v : voltmeters)
+        voltages.push_back(v.getVoltmeter().getVoltage());
+    return voltages;
+}
 
-   for(int i = 0; i < equationMatrix.size(); i++){
-       for(int j = 0; j < equationMatrix.at(i).size(); j++){
-           finalMatrix.m_pData[i][j] = equationMatrix.at(i).at(j);
-       }
-   }
+const list<VoltmeterWrapper> &Circuit::getVoltmeters() const {
+    return voltmeters;
+}
 
-   CMatrix sourcesMatrix("sourcesMatrix", getNumberOfBranches(), 1);
-    for(int i = 0; i < secondKirchoffsLawMatrix.size(); i++){
-            sourcesMatrix.m_pData[i][0] = secondKirchoffsLawMatrix.at(i).at(secondKirchoffsLawMatrix.at(i).size()-1) * (-1); // EQUATIONS * CURRENT + SOURCES = 0, *(-1) to shift SOURCES to right side
-    }
+const list<AmpermeterWrapper> &Circuit::getAmpermeters() const {
+    return ampermeters;
+}
 
+const list<Wattmeter> &Circuit::getWattmeters() const {
+    return wattmeters;
+}
 
-   CMatrix currentMatrix("currentMatrix",getNumberOfBranches(),1);
+//Readings of all wattmeters, in the order in which they were added
+vector<double> Circuit::getMeasuredPowers() {
+    readMeters();
+    vector<double> powers;
+    for (const auto &w : wattmeters)
+        powers.push_back(w.getPower());
+    return powers;
+}
 
-   finalMatrix = finalMatrix.Inverse();
-   currentMatrix = finalMatrix * sourcesMatrix;
+//Power of every component of the solved circuit, see PowerReport
+PowerReport Circuit::measurePowers() {
+    if (hasNonlinearElements()) throw std::domain_error("Power accounting needs a linear circuit!");
+    CompiledCircuit compiledCircuit(*this);
+    return PowerReport(compiledCircuit, compiledCircuit.solve());
+}
 
+static void scaleSensitivities(Sensitivities &sensitivities, double factor) {
+    sensitivities.reading *= factor;
+    for (auto &d : sensitivities.gradient.resistances) d *= factor;
+    for (auto &d : sensitivities.gradient.voltages) d *= factor;
+    for (auto &d : sensitivities.gradient.currents) d *= factor;
+}
 
+//Gradient of the ampermeter reading with respect to every component, see CompiledCircuit::getCurrentSensitivities()
+Sensitivities Circuit::getSensitivities(const AmpermeterWrapper &ampermeter) {
+    CompiledCircuit compiledCircuit(*this);
+    int branch = compiledCircuit.getTopology()->getBranchIndex(ampermeter.getAmpermeterBranch().getId());
+    if (branch < 0) throw std::logic_error("Ampermeter is not in the circuit!");
+    Sensitivities sensitivities = compiledCircuit.getCurrentSensitivities(branch);
+    if (!ampermeter.getAmpermeter().isNaturalOrientation()) scaleSensitivities(sensitivities, -1);
+    return sensitivities;
+}
 
-   for(int i = 0; i < getNumberOfBranches(); i++){
-       currentsInTheCircuit.push_back(currentMatrix.m_pData[i][0]);
-   }
+//Gradient of the voltmeter reading V(secondNode) - V(firstNode) with respect to every component
+Sensitivities Circuit::getSensitivities(const VoltmeterWrapper &voltmeter) {
+    CompiledCircuit compiledCircuit(*this);
+    const CircuitTopology &topology = *compiledCircuit.getTopology();
+    int firstNode = topology.getNodeIndex(voltmeter.getFirstNode().getId());
+    int secondNode = topology.getNodeIndex(voltmeter.getSecondNode().getId());
+    if (firstNode < 0 || secondNode < 0) throw std::logic_error("Voltmeter is not in the circuit!");
+    Sensitivities sensitivities = compiledCircuit.getVoltageSensitivities(firstNode, secondNode);
+    if (!voltmeter.getVoltmeter().isNaturalOrientation()) scaleSensitivities(sensitivities, -1);
+    return sensitivities;
+}
 
-   //set currents
-   for(int i = 0; i < getNumberOfBranches(); i++){
-       branches.at(i).setCurrent(currentsInTheCircuit.at(i));
-   }
+//Thevenin equivalent seen from nodeA and nodeB: V_th = V(nodeA) - V(nodeB) and R_th between them
+//One factorization is shared by the open-circuit voltage and the resistance, see CompiledCircuit
+TheveninEquivalent Circuit::theveninEquivalent(int nodeA, int nodeB) {
+    return theveninEquivalents({{nodeA, nodeB}}).front();
+}
+
+vector<TheveninEquivalent> Circuit::theveninEquivalents(const vector<pair<int, int>> &nodePairs) {
+    if (hasNonlinearElements()) throw std::domain_error("Thevenin equivalent needs a linear circuit!");
+    CompiledCircuit compiledCircuit(*this);
+    const CircuitTopology &topology = *compiledCircuit.getTopology();
+    vector<pair<int, int>> ports;
+    for (const auto &nodePair : nodePairs) {
+        int first = topology.getNodeIndex(nodePair.first);
+        int second = topology.getNodeIndex(nodePair.second);
+        if (first < 0 || second < 0) throw std::domain_error("Node is not in the circuit!");
+        ports.emplace_back(first, second);
+    }
+    return compiledCircuit.getTheveninEquivalents(ports);
+}
 
-    return currentsInTheCircuit;
-    
+//AC analysis driven by all sources of the circuit, see AcAnalysis
+AcResults Circuit::measureFrequencyResponse(const vector<double> &frequencies, int numberOfThreads) {
+    return AcAnalysis(*this, numberOfThreads).run(frequencies);
 }
 
 int Circuit::getAvailableBranchId() {
     std::set<int> ids;
-    for (auto b : branches)
+    for (const auto &b : branches)
         ids.insert(b.getId());
     for(int i = 1; ; i++) {
         if(ids.find(i) == ids.end())
@@ -728,68 +852,4 @@ int Circuit::getAvailableBranchId() {
         std::cout << std::endl;
     }
 }
-
-  int main() {
-     Circuit c;
-     char choice;
-     bool breakLoop = false;
-     int id = 0;
-     int node1, node2;
-     double resistance;
-     double voltage;
-     double current;
-     while(true) {
-         std::cout<< "Enter R for resistor, C for current source, E for voltage source, A for ampermeter, or V for voltmeter (X for exit):\n";
-         std::cin >> choice;
-         choice = toupper(choice);
-         switch (choice) {
-             case 'R':
-                 std::cout << "Enter resistance:\n";
-                 std::cin >> resistance;
-                 std::cout << "Enter nodes (two integers):\n";
-                 std::cin >> node1 >> node2;
-                 c.addResistorToCircuit(Resistor(resistance, id++), node1, node2);
-                 break;
-             case 'C':
-                 std::cout << "Enter current:\n";
-                 std::cin >> current;
-                 std::cout << "Enter nodes (two integers):\n";
-                 std::cin >> node1 >> node2;
-                 std::cout << "Enter internal resistance (-1 for ideal):\n";
-                 std::cin >> resistance;
-                 c.addCurrentSourceToCircuit(CurrentSource(id++, current, resistance), node1, node2);
-                 break;
-             case 'E':
-                 std::cout << "Enter voltage:\n";
-                 std::cin >> voltage;
-                 std::cout << "Enter nodes (two integers):\n";
-                 std::cin >> node1 >> node2;
-                 std::cout << "Enter internal resistance (0 for ideal):\n";
-                 std::cin >> resistance;
-                 c.addVoltageSourceToCircuit(VoltageSource(id++, voltage, resistance), node1, node2);
-                 break;
-             case 'A':
-                 std::cout << "Enter internal resistance (0 for ideal):\n";
-                 std::cin >> resistance;
-                 std::cout << "Enter nodes (two integers):\n";
-                 std::cin >> node1 >> node2;
-                 c.addAmpermeterToCircuit(Ampermeter(id++, resistance), node1, node2);
-                 break;
-             case 'V':
-                 std::cout << "Enter internal resistance (-1 for ideal):\n";
-                 std::cin >> resistance;
-                 std::cout << "Enter nodes (two integers):\n";
-                 std::cin >> node1 >> node2;
-                 c.addVoltmeterToCircuit(Voltmeter(id++, resistance), node1, node2);
-                 break;
-             case 'X':
-                 breakLoop = true;
-                 break;
-             default :
-                 std::cout << "Wrong letter!\n";
-         }
-         if (breakLoop) break;
-     }
-     c.removeObsoleteBranches();
-     std::cout<<c;
-  }*/
+*/
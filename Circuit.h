@@ -13,16 +13,27 @@
 #include <utility>
 #include <set>
 #include <list>
+#include "AnalysisStatistics.h"
 
 using std::vector;
 using std::list;
 
+class Sensitivities;
+
+class AcResults;
+
+class TheveninEquivalent;
+
+class PowerReport;
+
 class Circuit {
     vector<Branch> branches;
     list<VoltmeterWrapper> voltmeters;
     list<AmpermeterWrapper> ampermeters;
+    list<Wattmeter> wattmeters;
 
     int numberOfNodes;
+    AnalysisStatistics analysisStatistics;
 
 public:
     Circuit();
@@ -71,6 +82,15 @@ public:
 
     void addCurrentSourceToCircuit(CurrentSource V, int firstNodeID, int secondNodeID);
 
+    void addCapacitorToCircuit(const Capacitor &c, int firstNodeID, int secondNodeID);
+
+    void addInductorToCircuit(const Inductor &l, int firstNodeID, int secondNodeID);
+
+    void addNonlinearElementToCircuit(const std::shared_ptr<const NonlinearElement> &e, int firstNodeID,
+                                      int secondNodeID);
+
+    bool hasNonlinearElements();
+
     vector<Branch> &getBranches();
 
     friend std::ostream &operator<<(std::ostream &os, const Circuit &C);
@@ -79,8 +99,14 @@ public:
 
     void addVoltmeterToCircuit(Voltmeter v, int firstNodeID, int secondID);
 
+    void addVoltmeterToCircuit(Voltmeter v, int firstNodeID, int secondNodeID, int branchId);
+
     void addAmpermeterToCircuit(Ampermeter a, int firstNodeID, int secondNodeID);
 
+    void addAmpermeterToCircuit(Ampermeter a, int firstNodeID, int secondNodeID, int branchId);
+
+    void addWattmeterToCircuit(const Wattmeter &w);
+
     void removeBranchesWithInfiniteResistance();
 
     void shortConnectBranchesWithZeroResistance();
@@ -99,8 +125,37 @@ public:
 
     int getIndexOfABranchInBranches(Branch branchToCheck);
 
+    vector<double> measureCurrentsOfACircuit();
+
+    //Phase times and counters of the last measureCurrentsOfACircuit()
+    const AnalysisStatistics &getAnalysisStatistics() const;
+
+    void readMeters();
+
     vector<double> getMeasuredCurrents();
 
+    vector<double> getMeasuredVoltages();
+
+    const list<VoltmeterWrapper> &getVoltmeters() const;
+
+    const list<AmpermeterWrapper> &getAmpermeters() const;
+
+    const list<Wattmeter> &getWattmeters() const;
+
+    vector<double> getMeasuredPowers();
+
+    PowerReport measurePowers();
+
+    Sensitivities getSensitivities(const AmpermeterWrapper &ampermeter);
+
+    Sensitivities getSensitivities(const VoltmeterWrapper &voltmeter);
+
+    TheveninEquivalent theveninEquivalent(int nodeA, int nodeB);
+
+    vector<TheveninEquivalent> theveninEquivalents(const vector<pair<int, int>> &nodePairs);
+
+    AcResults measureFrequencyResponse(const vector<double> &frequencies, int numberOfThreads = 0);
+
     int getAvailableBranchId();
 };
 
@@ -0,0 +1,254 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <set>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "BenchmarkSuite.h"
+#include "CompiledCircuit.h"
+#include "ScalingReport.h"
+#include "TopologyCache.h"
+
+static const char *USAGE =
+        "Usage: circuit_bench [options]\n"
+        "  --families a,b,...      grid2d, grid3d, ladder, random, tree (default all)\n"
+        "  --sizes n,m,...         numbers of branches (default 10 to 100000, about 3 times more each)\n"
+        "  --filter text           only benchmarks whose name contains text\n"
+        "  --seed n                seed of the generated circuits (default 1)\n"
+        "  --min-time s            repeat every measurement for at least s seconds (default 0.2)\n"
+        "  --max-time s            skip sizes where setup and one iteration take longer than s seconds (default 5)\n"
+        "  --allocations           count the heap allocations of every iteration (built with\n"
+        "                          CIRCUIT_ALLOCATION_TRACKING)\n"
+        "  --output file           JSON results (default circuit_bench.json, - for the standard output)\n"
+        "  --scaling file          exponent k of time ~ branches^k of every benchmark and family, as a CSV that can\n"
+        "                          be the baseline of later runs, and as a table on the standard output\n"
+        "  --baseline file         flag exponents above those of an earlier --scaling CSV, such as\n"
+        "                          scaling_baseline.csv of the sources (default options)\n"
+        "  --tolerance k           how far above the baseline an exponent may be (default 0.25)\n"
+        "  --list                  names of the benchmarks\n"
+        "  --quiet                 no progress on the standard error\n"
+        "Exit status: 0, 1 if the benchmarks couldn't run, 2 if an exponent regressed against the baseline\n";
+
+//The spanning tree of Circuit::getMinimumSpanningTree() stops when its walk comes back to the first node, so it
+//misses the other subtrees of that node, and getLoops() then fails. The loop benchmarks only run when it spans.
+static bool isLegacyTreeSpanning(Circuit &circuit) {
+    std::set<int> nodes;
+    for (auto &b : circuit.getBranches()) {
+        if (b.hasCurrentSources()) continue;
+        nodes.insert(b.getFirstNode().getId());
+        nodes.insert(b.getSecondNode().getId());
+    }
+    return circuit.getMinimumSpanningTree().size() + 1 == nodes.size();
+}
+
+static BenchmarkIteration prepareLoops(const CircuitArrays &arrays, std::string &reason,
+                                       const std::function<void(Circuit &circuit)> &routine) {
+    auto circuit = std::make_shared<Circuit>(toCircuit(arrays));
+    if (!isLegacyTreeSpanning(*circuit)) {
+        reason = "getMinimumSpanningTree() doesn't span the circuit";
+        return nullptr;
+    }
+    return [circuit, routine](BenchmarkTimer &timer) {
+        timer.start();
+        routine(*circuit);
+        timer.stop();
+    };
+}
+
+//CMatrix isn't benchmarked: nothing uses it since the loop equations are solved by SparseLU, and it doesn't compile
+//(Determinant() refers to undeclared variables, tchar.h). The kernels are topology analysis, numeric factorization
+//and triangular solves of CompiledCircuit.
+//Benchmarks that analyse the topology clear TopologyCache first, or every iteration after the first would only look
+//the structure up.
+static void addBenchmarks(BenchmarkSuite &suite) {
+    suite.add({"getMinimumSpanningTree", "micro", [](const CircuitArrays &arrays, std::string &) {
+        auto circuit = std::make_shared<Circuit>(toCircuit(arrays));
+        return BenchmarkIteration([circuit](BenchmarkTimer &timer) {
+            timer.start();
+            circuit->getMinimumSpanningTree();
+            timer.stop();
+        });
+    }});
+    suite.add({"getLoops", "micro", [](const CircuitArrays &arrays, std::string &reason) {
+        return prepareLoops(arrays, reason, [](Circuit &circuit) { circuit.getLoops(); });
+    }});
+    suite.add({"firstKirchhoffsLaw", "micro", [](const CircuitArrays &arrays, std::string &) {
+        auto circuit = std::make_shared<Circuit>(toCircuit(arrays));
+        return BenchmarkIteration([circuit](BenchmarkTimer &timer) {
+            timer.start();
+            circuit->firstKirchhoffsLaw();
+            timer.stop();
+        });
+    }});
+    suite.add({"secondKirchoffsLaw", "micro", [](const CircuitArrays &arrays, std::string &reason) {
+        return prepareLoops(arrays, reason, [](Circuit &circuit) { circuit.secondKirchoffsLaw(); });
+    }});
+    suite.add({"removeObsoleteBranches", "micro", [](const CircuitArrays &arrays, std::string &) {
+        auto circuit = std::make_shared<Circuit>(toCircuit(arrays));
+        return BenchmarkIteration([circuit](BenchmarkTimer &timer) {
+            Circuit copy = *circuit;
+            timer.start();
+            copy.removeObsoleteBranches();
+            timer.stop();
+        });
+    }});
+    suite.add({"CircuitTopology", "micro", [](const CircuitArrays &arrays, std::string &) {
+        auto circuit = std::make_shared<Circuit>(toCircuit(arrays));
+        return BenchmarkIteration([circuit](BenchmarkTimer &timer) {
+            TopologyCache::getInstance().clear();
+            timer.start();
+            CircuitTopology topology(*circuit);
+            timer.stop();
+        });
+    }});
+    suite.add({"CircuitTopology::getValuesOf", "micro", [](const CircuitArrays &arrays, std::string &) {
+        auto circuit = std::make_shared<Circuit>(toCircuit(arrays));
+        auto topology = std::make_shared<CircuitTopology>(*circuit);
+        return BenchmarkIteration([circuit, topology](BenchmarkTimer &timer) {
+            timer.start();
+            topology->getValuesOf(*circuit);
+            timer.stop();
+        });
+    }});
+    suite.add({"CompiledCircuit::refactor", "micro", [](const CircuitArrays &arrays, std::string &) {
+        Circuit circuit = toCircuit(arrays);
+        auto compiled = std::make_shared<CompiledCircuit>(circuit);
+        auto values = std::make_shared<ComponentValues>(compiled->getTopology()->getValuesOf(circuit));
+        return BenchmarkIteration([compiled, values](BenchmarkTimer &timer) {
+            timer.start();
+            compiled->refactor(*values);
+            timer.stop();
+        });
+    }});
+    suite.add({"CompiledCircuit::solve", "micro", [](const CircuitArrays &arrays, std::string &) {
+        Circuit circuit = toCircuit(arrays);
+        auto compiled = std::make_shared<CompiledCircuit>(circuit);
+        auto currents = std::make_shared<vector<double>>();
+        return BenchmarkIteration([compiled, currents](BenchmarkTimer &timer) {
+            timer.start();
+            compiled->solve(*currents);
+            timer.stop();
+        });
+    }});
+    suite.add({"CompiledCircuit::refactor/mixed", "micro", [](const CircuitArrays &arrays, std::string &) {
+        Circuit circuit = toCircuit(arrays);
+        auto compiled = std::make_shared<CompiledCircuit>(circuit);
+        compiled->setPrecision(SolverPrecision::MIXED);
+        auto values = std::make_shared<ComponentValues>(compiled->getTopology()->getValuesOf(circuit));
+        //the first single precision factorization chooses the pivots, the iterations only reuse them
+        compiled->refactor(*values);
+        return BenchmarkIteration([compiled, values](BenchmarkTimer &timer) {
+            timer.start();
+            compiled->refactor(*values);
+            timer.stop();
+        });
+    }});
+    suite.add({"CompiledCircuit::solve/mixed", "micro", [](const CircuitArrays &arrays, std::string &) {
+        Circuit circuit = toCircuit(arrays);
+        auto compiled = std::make_shared<CompiledCircuit>(circuit);
+        compiled->setPrecision(SolverPrecision::MIXED);
+        //the constructor factored in double precision, the single precision factors come with the next refactor
+        compiled->refactor(compiled->getValues());
+        auto currents = std::make_shared<vector<double>>();
+        return BenchmarkIteration([compiled, currents](BenchmarkTimer &timer) {
+            timer.start();
+            compiled->solve(*currents);
+            timer.stop();
+        });
+    }});
+    suite.add({"measureCurrentsOfACircuit", "end-to-end", [](const CircuitArrays &arrays, std::string &) {
+        auto circuit = std::make_shared<Circuit>(toCircuit(arrays));
+        return BenchmarkIteration([circuit](BenchmarkTimer &timer) {
+            TopologyCache::getInstance().clear();
+            timer.start();
+            circuit->measureCurrentsOfACircuit();
+            timer.stop();
+        });
+    }});
+}
+
+static double parseValue(const std::string &option, const std::string &text) {
+    size_t length = 0;
+    double value = 0;
+    try {
+        value = std::stod(text, &length);
+    } catch (const std::exception &) {
+    }
+    if (length == 0 || length != text.size() || value < 0) throw std::domain_error("Wrong value of " + option + "!");
+    return value;
+}
+
+static vector<std::string> split(const std::string &text) {
+    vector<std::string> items;
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ','))
+        items.push_back(item);
+    return items;
+}
+
+static int runBenchmarks(int argc, char *argv[]) {
+    BenchmarkOptions options;
+    std::string output = "circuit_bench.json", scaling, baseline;
+    double tolerance = 0.25;
+    bool list = false, quiet = false;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        auto getValue = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::domain_error(argument + " needs a value!");
+            return argv[++i];
+        };
+        if (argument == "--families") {
+            options.families.clear();
+            for (const auto &name : split(getValue()))
+                options.families.push_back(CircuitGenerator::getFamily(name));
+        } else if (argument == "--sizes") {
+            options.sizes.clear();
+            for (const auto &size : split(getValue()))
+                options.sizes.push_back(std::max(1, (int) parseValue(argument, size)));
+        } else if (argument == "--filter") options.filter = getValue();
+        else if (argument == "--seed") options.seed = (uint64_t) parseValue(argument, getValue());
+        else if (argument == "--min-time") options.minSeconds = parseValue(argument, getValue());
+        else if (argument == "--max-time") options.maxSeconds = parseValue(argument, getValue());
+        else if (argument == "--allocations") AllocationTracker::setEnabled(true);
+        else if (argument == "--output") output = getValue();
+        else if (argument == "--scaling") scaling = getValue();
+        else if (argument == "--baseline") baseline = getValue();
+        else if (argument == "--tolerance") tolerance = parseValue(argument, getValue());
+        else if (argument == "--list") list = true;
+        else if (argument == "--quiet") quiet = true;
+        else if (argument == "--help") {
+            std::cout << USAGE;
+            return 0;
+        } else throw std::domain_error("Unknown option " + argument + "!");
+    }
+
+    BenchmarkSuite suite(options);
+    addBenchmarks(suite);
+    if (list) {
+        for (const auto &c : suite.getCases())
+            std::cout << c.name << " (" << c.kind << ")\n";
+        return 0;
+    }
+    if (!baseline.empty() && !std::ifstream(baseline)) throw std::runtime_error("Can't open " + baseline + "!");
+    vector<BenchmarkResult> results = suite.run(quiet ? nullptr : &std::cerr);
+    suite.writeJson(results, output);
+    if (scaling.empty() && baseline.empty()) return 0;
+    ScalingReport report(results);
+    if (!baseline.empty()) report.compare(baseline, tolerance);
+    report.print(std::cout);
+    if (!scaling.empty()) report.writeCsv(scaling);
+    return report.getNumberOfRegressions() > 0 ? 2 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    try {
+        return runBenchmarks(argc, argv);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
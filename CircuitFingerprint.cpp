@@ -0,0 +1,332 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <map>
+#include <algorithm>
+#include "CircuitFingerprint.h"
+#include "NonlinearSolver.h"
+
+//Ordered partition of the nodes for colour refinement, every class (colour) is a range of elements
+//Refining by a splitter class separates the nodes of every class by the labels of their branches (oriented away from
+//them) to nodes of the splitter. Only nodes next to the splitter are touched, and after a split only the new classes
+//become splitters, all but the largest if the old class was already refined by (Hopcroft), so a stable partition takes
+//O(branches * log(nodes)) instead of a round over all nodes for each split, which made chains and ladders quadratic.
+//New classes are numbered in the order of their labels, so the colours don't depend on the node numbering.
+class ColourPartition {
+    vector<int> elements;
+    vector<int> positions;
+    vector<int> cellStarts;
+    vector<int> cellEnds;
+    vector<bool> queued;
+    vector<int> queue;
+    int queueHead = 0;
+    int firstTied = 0;                   //classes before it have one node
+    vector<vector<std::pair<int, uint64_t>>> neighbours;   //other node and the label of the branch seen from it
+    vector<uint64_t> signatures;
+    vector<bool> touched;
+    vector<int> touchedCounts;
+
+    void refine(int splitter);
+
+    void addCell(int start, int end) {
+        cellStarts.push_back(start);
+        cellEnds.push_back(end);
+        queued.push_back(false);
+        for (int p = start; p < end; p++)
+            colours[elements[p]] = cellStarts.size() - 1;
+    }
+
+    void enqueue(int cell) {
+        if (queued[cell]) return;
+        queued[cell] = true;
+        queue.push_back(cell);
+    }
+
+public:
+    vector<uint64_t> colours;
+
+    ColourPartition(int numberOfNodes, const vector<int> &firstNodes, const vector<int> &secondNodes,
+                    const vector<uint64_t> &forwardLabels, const vector<uint64_t> &backwardLabels);
+
+    int getNumberOfColours() const {
+        return cellStarts.size();
+    }
+
+    //refines until no splitter is left
+    void stabilize();
+
+    //gives one node of the first class with more than one node a colour of its own, false if every class is single
+    bool breakTie();
+};
+
+ColourPartition::ColourPartition(int numberOfNodes, const vector<int> &firstNodes, const vector<int> &secondNodes,
+                                 const vector<uint64_t> &forwardLabels, const vector<uint64_t> &backwardLabels) :
+        elements(numberOfNodes), positions(numberOfNodes), neighbours(numberOfNodes), signatures(numberOfNodes, 0),
+        touched(numberOfNodes, false), touchedCounts(numberOfNodes, 0), colours(numberOfNodes, 0) {
+    for (int b = 0; b < firstNodes.size(); b++) {
+        neighbours[firstNodes[b]].emplace_back(secondNodes[b], backwardLabels[b]);
+        neighbours[secondNodes[b]].emplace_back(firstNodes[b], forwardLabels[b]);
+    }
+    for (int n = 0; n < numberOfNodes; n++)
+        elements[n] = positions[n] = n;
+    if (numberOfNodes == 0) return;
+    addCell(0, numberOfNodes);
+    enqueue(0);
+}
+
+void ColourPartition::stabilize() {
+    while (queueHead < queue.size()) {
+        int splitter = queue[queueHead++];
+        queued[splitter] = false;
+        refine(splitter);
+    }
+    queue.clear();
+    queueHead = 0;
+}
+
+void ColourPartition::refine(int splitter) {
+    vector<int> members(elements.begin() + cellStarts[splitter], elements.begin() + cellEnds[splitter]);
+    vector<int> touchedNodes, touchedCells;
+    for (int x : members)
+        for (const auto &neighbour : neighbours[x]) {
+            int y = neighbour.first;
+            if (!touched[y]) {
+                touched[y] = true;
+                touchedNodes.push_back(y);
+            }
+            signatures[y] += mixHash(neighbour.second, 1);
+        }
+    //touched nodes go to the end of their class
+    for (int y : touchedNodes) {
+        int cell = colours[y];
+        if (touchedCounts[cell]++ == 0) touchedCells.push_back(cell);
+        int p = cellEnds[cell] - touchedCounts[cell];
+        int other = elements[p];
+        std::swap(elements[p], elements[positions[y]]);
+        positions[other] = positions[y];
+        positions[y] = p;
+    }
+    std::sort(touchedCells.begin(), touchedCells.end());
+    for (int cell : touchedCells) {
+        int start = cellStarts[cell], end = cellEnds[cell], tail = end - touchedCounts[cell];
+        touchedCounts[cell] = 0;
+        std::sort(elements.begin() + tail, elements.begin() + end, [this](int a, int b) {
+            return signatures[a] < signatures[b];
+        });
+        for (int p = tail; p < end; p++)
+            positions[elements[p]] = p;
+        //groups: the untouched nodes, then the touched ones by signature
+        vector<int> groupStarts;
+        if (tail > start) groupStarts.push_back(start);
+        for (int p = tail; p < end; p++)
+            if (p == tail || signatures[elements[p]] != signatures[elements[p - 1]]) groupStarts.push_back(p);
+        if (groupStarts.size() == 1) continue;
+        groupStarts.push_back(end);
+        int largest = 0;
+        for (int g = 1; g + 1 < groupStarts.size(); g++)
+            if (groupStarts[g + 1] - groupStarts[g] > groupStarts[largest + 1] - groupStarts[largest]) largest = g;
+        bool wasQueued = queued[cell];
+        cellEnds[cell] = groupStarts[1];
+        if (wasQueued || largest != 0) enqueue(cell);
+        for (int g = 1; g + 1 < groupStarts.size(); g++) {
+            addCell(groupStarts[g], groupStarts[g + 1]);
+            if (wasQueued || largest != g) enqueue(cellStarts.size() - 1);
+        }
+    }
+    for (int y : touchedNodes) {
+        touched[y] = false;
+        signatures[y] = 0;
+    }
+}
+
+bool ColourPartition::breakTie() {
+    while (firstTied < cellStarts.size() && cellEnds[firstTied] - cellStarts[firstTied] == 1)
+        firstTied++;
+    if (firstTied == cellStarts.size()) return false;
+    //the node with the lowest index, so the choice is the same for the same circuit
+    int start = cellStarts[firstTied], end = cellEnds[firstTied];
+    int chosen = start;
+    for (int p = start + 1; p < end; p++)
+        if (elements[p] < elements[chosen]) chosen = p;
+    std::swap(elements[chosen], elements[end - 1]);
+    positions[elements[chosen]] = chosen;
+    positions[elements[end - 1]] = end - 1;
+    cellEnds[firstTied] = end - 1;
+    addCell(end - 1, end);
+    enqueue(cellStarts.size() - 1);
+    return true;
+}
+
+CircuitFingerprint::CircuitFingerprint(Circuit &circuit) {
+    if (circuit.hasNonlinearElements()) throw std::domain_error("Fingerprint needs a linear circuit!");
+    vector<Branch> &branches = circuit.getBranches();
+    int numberOfBranches = branches.size();
+    std::map<int, int> nodeIndices;
+    for (auto &b : branches) {
+        nodeIndices.emplace(b.getFirstNode().getId(), 0);
+        nodeIndices.emplace(b.getSecondNode().getId(), 0);
+    }
+    int numberOfNodes = 0;
+    for (auto &n : nodeIndices)
+        n.second = numberOfNodes++;
+
+    //label of every branch in both orientations: fixed current, R, E, J (E and J change sign with the orientation)
+    vector<int> firstNodes(numberOfBranches), secondNodes(numberOfBranches);
+    vector<uint64_t> forwardLabels(numberOfBranches), backwardLabels(numberOfBranches);
+    vector<vector<uint64_t>> forwardTuples(numberOfBranches), backwardTuples(numberOfBranches);
+    for (int i = 0; i < numberOfBranches; i++) {
+        Branch &b = branches.at(i);
+        firstNodes[i] = nodeIndices[b.getFirstNode().getId()];
+        secondNodes[i] = nodeIndices[b.getSecondNode().getId()];
+        double resistance = b.getResistance();
+        bool fixed = b.hasCurrentSources() || fabs(resistance + 1) < EPSILON || b.hasCapacitors();
+        double voltage = b.getVoltageFromVoltageSources();
+        double current = 0;
+        if (b.hasCurrentSources()) {
+            const CurrentSource &c = b.getCurrentSources().front();
+            current = c.isNaturalOrientation() ? c.getCurrent() : -c.getCurrent();
+        }
+        forwardTuples[i] = {(uint64_t) fixed, getDoubleBits(resistance), getDoubleBits(voltage),
+                            getDoubleBits(current)};
+        backwardTuples[i] = {(uint64_t) fixed, getDoubleBits(resistance), getDoubleBits(-voltage),
+                             getDoubleBits(-current)};
+        forwardLabels[i] = backwardLabels[i] = 0;
+        for (int k = 0; k < 4; k++) {
+            forwardLabels[i] = mixHash(forwardLabels[i], forwardTuples[i][k]);
+            backwardLabels[i] = mixHash(backwardLabels[i], backwardTuples[i][k]);
+        }
+    }
+
+    ColourPartition partition(numberOfNodes, firstNodes, secondNodes, forwardLabels, backwardLabels);
+    partition.stabilize();
+    while (partition.breakTie())
+        partition.stabilize();
+    const vector<uint64_t> &colours = partition.colours;
+
+    //every branch oriented from its lower node label, then sorted
+    vector<vector<uint64_t>> tuples(numberOfBranches);
+    orientations.assign(numberOfBranches, 1);
+    for (int i = 0; i < numberOfBranches; i++) {
+        uint64_t first = colours[firstNodes[i]], second = colours[secondNodes[i]];
+        bool reversed = second < first || (first == second && backwardTuples[i] < forwardTuples[i]);
+        tuples[i] = reversed ? backwardTuples[i] : forwardTuples[i];
+        tuples[i].insert(tuples[i].begin(), {std::min(first, second), std::max(first, second)});
+        if (reversed) orientations[i] = -1;
+    }
+    canonicalBranches.resize(numberOfBranches);
+    for (int i = 0; i < numberOfBranches; i++)
+        canonicalBranches[i] = i;
+    std::sort(canonicalBranches.begin(), canonicalBranches.end(), [&](int b1, int b2) {
+        return tuples[b1] < tuples[b2];
+    });
+    vector<int> branchOrientations(orientations);
+    canonicalForm = {(uint64_t) numberOfNodes, (uint64_t) numberOfBranches};
+    for (int p = 0; p < numberOfBranches; p++) {
+        int b = canonicalBranches[p];
+        orientations[p] = branchOrientations[b];
+        canonicalForm.insert(canonicalForm.end(), tuples[b].begin(), tuples[b].end());
+    }
+    for (auto x : canonicalForm)
+        hash = mixHash(hash, x);
+}
+
+uint64_t CircuitFingerprint::getHash() const {
+    return hash;
+}
+
+const vector<uint64_t> &CircuitFingerprint::getCanonicalForm() const {
+    return canonicalForm;
+}
+
+int CircuitFingerprint::getNumberOfBranches() const {
+    return canonicalBranches.size();
+}
+
+void CircuitFingerprint::toCanonical(const vector<double> &branchCurrents, vector<double> &canonicalCurrents) const {
+    canonicalCurrents.resize(canonicalBranches.size());
+    for (int p = 0; p < canonicalBranches.size(); p++)
+        canonicalCurrents[p] = orientations[p] * branchCurrents[canonicalBranches[p]];
+}
+
+void CircuitFingerprint::fromCanonical(const vector<double> &canonicalCurrents, vector<double> &branchCurrents) const {
+    branchCurrents.resize(canonicalBranches.size());
+    for (int p = 0; p < canonicalBranches.size(); p++)
+        branchCurrents[canonicalBranches[p]] = orientations[p] * canonicalCurrents[p];
+}
+
+double CacheStatistics::getHitRate() const {
+    return hits + misses == 0 ? 0 : (double) hits / (hits + misses);
+}
+
+SolutionCache::SolutionCache(int capacity) : capacity(capacity) {
+    if (capacity < 1) throw std::domain_error("Cache capacity must be positive!");
+}
+
+int SolutionCache::getCapacity() const {
+    return capacity;
+}
+
+int SolutionCache::getSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+CacheStatistics SolutionCache::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return statistics;
+}
+
+void SolutionCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+}
+
+//Branch currents of an equal circuit solved before, in the order and orientation of the fingerprinted circuit
+bool SolutionCache::find(const CircuitFingerprint &fingerprint, vector<double> &branchCurrents) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(fingerprint.getHash());
+    if (it == index.end() || it->second->canonicalForm != fingerprint.getCanonicalForm()) {
+        statistics.misses++;
+        return false;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    statistics.hits++;
+    fingerprint.fromCanonical(it->second->canonicalCurrents, branchCurrents);
+    return true;
+}
+
+//A different circuit with the same hash is replaced, the least recently used entry is evicted when the cache is full
+void SolutionCache::insert(const CircuitFingerprint &fingerprint, const vector<double> &branchCurrents) {
+    Entry entry;
+    entry.hash = fingerprint.getHash();
+    entry.canonicalForm = fingerprint.getCanonicalForm();
+    fingerprint.toCanonical(branchCurrents, entry.canonicalCurrents);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(entry.hash);
+    if (it != index.end()) {
+        *it->second = std::move(entry);
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    entries.push_front(std::move(entry));
+    index[entries.front().hash] = entries.begin();
+    statistics.insertions++;
+    if (entries.size() > capacity) {
+        index.erase(entries.back().hash);
+        entries.pop_back();
+        statistics.evictions++;
+    }
+}
+
+vector<double> SolutionCache::solve(Circuit &circuit) {
+    if (circuit.hasNonlinearElements()) return NonlinearSolver(circuit).solve();
+    CircuitFingerprint fingerprint(circuit);
+    vector<double> branchCurrents;
+    if (find(fingerprint, branchCurrents)) return branchCurrents;
+    CompiledCircuit(circuit).solve(branchCurrents);
+    insert(fingerprint, branchCurrents);
+    return branchCurrents;
+}
@@ -0,0 +1,117 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_CIRCUITFINGERPRINT_H
+#define CIRCUITANALYZER_CIRCUITFINGERPRINT_H
+
+#include <vector>
+#include <list>
+#include <mutex>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include "CompiledCircuit.h"
+
+using std::vector;
+using std::list;
+
+//splitmix64 finalizer, combines a value into a running hash
+inline uint64_t mixHash(uint64_t seed, uint64_t value) {
+    uint64_t x = seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+inline uint64_t getDoubleBits(double value) {
+    if (value == 0) value = 0;   //-0 and 0 are the same value
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+//Canonical form of a linear DC circuit, independent of node ids, branch ids, branch order and branch orientation
+//Every branch is reduced to what its DC current depends on: fixed current or not, total resistance, total voltage
+//and the current of its current source. Nodes are relabelled by colour refinement over these labels; when the
+//refinement leaves equal colours, one node of the first tied class is singled out and the refinement continues.
+//The canonical form is the sorted list of branches between the new node labels, oriented from the lower label.
+//Equal canonical forms always mean the same circuit up to relabelling; the hash only speeds up the comparison.
+//Symmetric circuits relabelled differently can get different forms, which only costs a cache miss.
+
+class CircuitFingerprint {
+    uint64_t hash = 0;
+    vector<uint64_t> canonicalForm;
+    vector<int> canonicalBranches;      //branch index of the circuit at every canonical position
+    vector<int> orientations;           //-1 where the canonical orientation is opposite to the branch
+
+public:
+    explicit CircuitFingerprint(Circuit &circuit);
+
+    uint64_t getHash() const;
+
+    const vector<uint64_t> &getCanonicalForm() const;
+
+    int getNumberOfBranches() const;
+
+    void toCanonical(const vector<double> &branchCurrents, vector<double> &canonicalCurrents) const;
+
+    void fromCanonical(const vector<double> &canonicalCurrents, vector<double> &branchCurrents) const;
+
+    friend bool operator==(const CircuitFingerprint &f1, const CircuitFingerprint &f2) {
+        return f1.hash == f2.hash && f1.canonicalForm == f2.canonicalForm;
+    }
+
+    friend bool operator!=(const CircuitFingerprint &f1, const CircuitFingerprint &f2) {
+        return !(f1 == f2);
+    }
+};
+
+class CacheStatistics {
+public:
+    long hits = 0;
+    long misses = 0;
+    long insertions = 0;
+    long evictions = 0;
+
+    double getHitRate() const;
+};
+
+//Bounded least recently used cache of DC solutions keyed by circuit fingerprints, safe to share between threads
+//Solutions are stored in canonical order and orientation and mapped back to the branches of the asking circuit.
+//Only linear circuits are cached, solve() solves circuits with nonlinear elements without the cache.
+
+class SolutionCache {
+    class Entry {
+    public:
+        uint64_t hash;
+        vector<uint64_t> canonicalForm;
+        vector<double> canonicalCurrents;
+    };
+
+    int capacity;
+    list<Entry> entries;                //most recently used first
+    std::unordered_map<uint64_t, list<Entry>::iterator> index;
+    CacheStatistics statistics;
+    mutable std::mutex mutex;
+
+public:
+    explicit SolutionCache(int capacity = 4096);
+
+    int getCapacity() const;
+
+    int getSize() const;
+
+    CacheStatistics getStatistics() const;
+
+    void clear();
+
+    bool find(const CircuitFingerprint &fingerprint, vector<double> &branchCurrents);
+
+    void insert(const CircuitFingerprint &fingerprint, const vector<double> &branchCurrents);
+
+    vector<double> solve(Circuit &circuit);
+};
+
+
+#endif //CIRCUITANALYZER_CIRCUITFINGERPRINT_H
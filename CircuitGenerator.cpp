@@ -0,0 +1,389 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "CircuitGenerator.h"
+#include "ResultWriter.h"
+
+static const char *FAMILY_NAMES[] = {"grid2d", "grid3d", "ladder", "random", "tree"};
+
+CircuitGenerator::CircuitGenerator(const GeneratorOptions &options) : options(options) {
+    if (options.numberOfBranches < 1) throw std::domain_error("Number of branches must be positive!");
+    if (options.minResistance <= 0 || options.maxResistance < options.minResistance)
+        throw std::domain_error("Wrong range of resistances!");
+    if (options.degree < 2) throw std::domain_error("Degree must be at least 2!");
+    if (options.numberOfVoltageSources < 0 || options.numberOfCurrentSources < 0)
+        throw std::domain_error("Number of sources can't be negative!");
+}
+
+const GeneratorOptions &CircuitGenerator::getOptions() const {
+    return options;
+}
+
+CircuitArrays CircuitGenerator::generate() {
+    arrays = CircuitArrays();
+    engine.seed(options.seed);
+    int sourceBranches = options.numberOfCurrentSources;
+    if (options.placement == SourcePlacement::PADS) sourceBranches += options.numberOfVoltageSources;
+    int numberOfBranches = std::max(1, options.numberOfBranches - sourceBranches);
+
+    switch (options.family) {
+        case CircuitFamily::GRID_2D: {
+            //h (w - 1) + w (h - 1) branches
+            int width = std::max(2, (int) std::lround(std::sqrt(numberOfBranches / 2.0)));
+            makeGrid(width, std::max(1, (numberOfBranches + width) / (2 * width - 1)), 1);
+            break;
+        }
+        case CircuitFamily::GRID_3D: {
+            //d (2 w^2 - 2 w) + (d - 1) w^2 branches
+            int width = std::max(2, (int) std::lround(std::cbrt(numberOfBranches / 3.0)));
+            int layer = width * width;
+            makeGrid(width, width, std::max(1, (numberOfBranches + layer) / (3 * layer - 2 * width)));
+            break;
+        }
+        case CircuitFamily::LADDER:
+            makeLadder(numberOfBranches);
+            break;
+        case CircuitFamily::RANDOM:
+            makeRandomGraph(numberOfBranches);
+            break;
+        case CircuitFamily::TREE:
+            makeTree(numberOfBranches);
+            break;
+    }
+    placeSources();
+    return std::move(arrays);
+}
+
+Circuit CircuitGenerator::generateCircuit() {
+    return toCircuit(generate());
+}
+
+void CircuitGenerator::writeNetlist(const std::string &path) {
+    std::string title = getFamilyName(options.family) + " circuit, seed " + std::to_string(options.seed);
+    writeNetlist(generate(), path, title);
+}
+
+void CircuitGenerator::writeBinary(const std::string &path) {
+    writeBinaryCircuit(generate(), path);
+}
+
+//Uniform in [0, 1) from the top 53 bits
+double CircuitGenerator::getUniform() {
+    return (engine() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+int CircuitGenerator::getIndex(int size) {
+    return (int) (engine() % (uint64_t) size);
+}
+
+double CircuitGenerator::getResistance() {
+    return options.minResistance + (options.maxResistance - options.minResistance) * getUniform();
+}
+
+//Returns the index of the first new node
+int CircuitGenerator::addNodes(int count) {
+    int first = arrays.nodeIds.size();
+    for (int i = 0; i < count; i++)
+        arrays.nodeIds.push_back(first + i);
+    return first;
+}
+
+int CircuitGenerator::addBranch(int firstNode, int secondNode) {
+    int branch = arrays.branchIds.size();
+    arrays.branchIds.push_back(branch);
+    arrays.firstNodes.push_back(firstNode);
+    arrays.secondNodes.push_back(secondNode);
+    arrays.fixedResistances.push_back(0);
+    return branch;
+}
+
+int CircuitGenerator::addResistor(int firstNode, int secondNode, double resistance) {
+    int branch = addBranch(firstNode, secondNode);
+    arrays.resistorIds.push_back(arrays.resistorIds.size());
+    arrays.resistorBranches.push_back(branch);
+    arrays.resistances.push_back(resistance);
+    return branch;
+}
+
+void CircuitGenerator::addVoltageSource(int branch, double voltage, int orientation) {
+    arrays.voltageSourceIds.push_back(arrays.voltageSourceIds.size());
+    arrays.voltageSourceBranches.push_back(branch);
+    arrays.voltageSourceOrientations.push_back(orientation);
+    arrays.voltages.push_back(voltage);
+}
+
+void CircuitGenerator::addCurrentSource(int branch, double current, int orientation) {
+    arrays.currentSourceIds.push_back(arrays.currentSourceIds.size());
+    arrays.currentSourceBranches.push_back(branch);
+    arrays.currentSourceOrientations.push_back(orientation);
+    arrays.currents.push_back(current);
+}
+
+//Node x + w (y + h z), the ground is the corner node 0
+void CircuitGenerator::makeGrid(int width, int height, int depth) {
+    addNodes(width * height * depth);
+    for (int z = 0; z < depth; z++)
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++) {
+                int node = x + width * (y + height * z);
+                if (x + 1 < width) addResistor(node, node + 1, getResistance());
+                if (y + 1 < height) addResistor(node, node + width, getResistance());
+                if (z + 1 < depth) addResistor(node, node + width * height, getResistance());
+            }
+}
+
+//Rail nodes 1..n, the ground is node 0. The 2R of the last node and the 2R termination are merged into one R, so
+//that no two branches join the same nodes.
+void CircuitGenerator::makeLadder(int numberOfBranches) {
+    int numberOfStages = std::max(1, (numberOfBranches + 1) / 2);
+    double resistance = options.minResistance;
+    addNodes(numberOfStages + 1);
+    for (int k = 1; k <= numberOfStages; k++) {
+        if (k > 1) addResistor(k - 1, k, resistance);
+        addResistor(k, 0, k < numberOfStages ? 2 * resistance : resistance);
+    }
+}
+
+//Edges are distinct, there are enough nodes for them
+void CircuitGenerator::makeRandomGraph(int numberOfBranches) {
+    int numberOfNodes = std::max(2, (int) std::lround(2.0 * numberOfBranches / options.degree));
+    numberOfNodes = std::min(numberOfNodes, numberOfBranches + 1);
+    while ((int64_t) numberOfNodes * (numberOfNodes - 1) / 2 < numberOfBranches) numberOfNodes++;
+    makeTree(numberOfNodes - 1);
+    //Open addressing set of the edges (min node << 32 | max node), at most half full
+    size_t size = 2;
+    while (size < 2 * (size_t) numberOfBranches) size *= 2;
+    vector<uint64_t> edges(size, UINT64_MAX);
+    auto addEdge = [&](int first, int second) -> bool {
+        uint64_t edge = (uint64_t) std::min(first, second) << 32 | (uint64_t) std::max(first, second);
+        size_t i = (edge * 0x9E3779B97F4A7C15ull) & (size - 1);
+        while (edges[i] != UINT64_MAX) {
+            if (edges[i] == edge) return false;
+            i = (i + 1) & (size - 1);
+        }
+        edges[i] = edge;
+        return true;
+    };
+    for (int b = 0; b < arrays.branchIds.size(); b++)
+        addEdge(arrays.firstNodes[b], arrays.secondNodes[b]);
+    while (arrays.branchIds.size() < numberOfBranches) {
+        int first = getIndex(numberOfNodes), second = getIndex(numberOfNodes);
+        if (first != second && addEdge(first, second)) addResistor(first, second, getResistance());
+    }
+}
+
+void CircuitGenerator::makeTree(int numberOfBranches) {
+    addNodes(numberOfBranches + 1);
+    for (int node = 1; node <= numberOfBranches; node++)
+        addResistor(getIndex(node), node, getResistance());
+}
+
+void CircuitGenerator::placeSources() {
+    int numberOfNodes = arrays.nodeIds.size(), numberOfResistors = arrays.branchIds.size();
+    if (options.placement == SourcePlacement::PADS) {
+        //Pads spread from node 1 on, loads in the middle between them. A node next to the ground or with a source
+        //already is passed over for the next free one, so that sources don't end up in parallel with other branches
+        //as long as there are free nodes. taken: 0 free, 1 next to the ground or with a load, 2 with a pad (two pads
+        //on one node would be singular, so pads never share a node).
+        vector<char> taken(numberOfNodes, 0);
+        for (int b = 0; b < numberOfResistors; b++)
+            if (arrays.firstNodes[b] == 0 || arrays.secondNodes[b] == 0)
+                taken[arrays.firstNodes[b] + arrays.secondNodes[b]] = 1;
+        auto getFreeNode = [&](int node, char mark) -> int {
+            for (char allowed = 0; allowed < mark; allowed++)
+                for (int k = 0; k < numberOfNodes - 1; k++) {
+                    int candidate = 1 + (node - 1 + k) % (numberOfNodes - 1);
+                    if (taken[candidate] <= allowed) {
+                        taken[candidate] = std::max(taken[candidate], mark);
+                        return candidate;
+                    }
+                }
+            return node;
+        };
+        int numberOfPads = std::min(options.numberOfVoltageSources, numberOfNodes - 1);
+        for (int k = 0; k < numberOfPads; k++) {
+            int node = 1 + (int) ((int64_t) k * (numberOfNodes - 1) / numberOfPads);
+            addVoltageSource(addBranch(0, getFreeNode(node, 2)), options.voltage, 1);
+        }
+        int numberOfLoads = options.numberOfCurrentSources;
+        for (int k = 0; k < numberOfLoads; k++) {
+            int node = 1 + (int) ((int64_t) (2 * k + 1) * (numberOfNodes - 1) / (2 * numberOfLoads));
+            addCurrentSource(addBranch(getFreeNode(std::min(node, numberOfNodes - 1), 1), 0), options.current, 1);
+        }
+        return;
+    }
+
+    //Different branches for the voltage sources, in the order of the branches so that ids follow the cards of
+    //the netlist
+    int numberOfSources = std::min(options.numberOfVoltageSources, numberOfResistors);
+    vector<char> used(numberOfResistors, 0);
+    vector<int> branches;
+    while (branches.size() < numberOfSources) {
+        int branch = getIndex(numberOfResistors);
+        if (used[branch]) continue;
+        used[branch] = 1;
+        branches.push_back(branch);
+    }
+    std::sort(branches.begin(), branches.end());
+    for (int branch : branches)
+        addVoltageSource(branch, options.voltage, engine() & 1 ? 1 : -1);
+    for (int k = 0; k < options.numberOfCurrentSources; k++) {
+        int branch = getIndex(numberOfResistors);
+        int parallel = addBranch(arrays.firstNodes[branch], arrays.secondNodes[branch]);
+        addCurrentSource(parallel, options.current, engine() & 1 ? 1 : -1);
+    }
+}
+
+//Sorts the elements by branch, index of the first element of each branch in offsets
+static vector<int> groupByBranch(const vector<int32_t> &elementBranches, int numberOfBranches,
+                                 vector<int> &offsets) {
+    offsets.assign(numberOfBranches + 1, 0);
+    for (int b : elementBranches)
+        offsets[b + 1]++;
+    for (int b = 0; b < numberOfBranches; b++)
+        offsets[b + 1] += offsets[b];
+    vector<int> elements(elementBranches.size());
+    vector<int> next(offsets.begin(), offsets.end() - 1);
+    for (int i = 0; i < elementBranches.size(); i++)
+        elements[next[elementBranches[i]]++] = i;
+    return elements;
+}
+
+class NetlistOutput {
+    FILE *file;
+    bool standardOutput;
+    vector<char> buffer;
+    size_t size = 0;
+
+public:
+    explicit NetlistOutput(const std::string &path) : standardOutput(path == "-"), buffer(1 << 20) {
+        file = standardOutput ? stdout : fopen(path.c_str(), "wb");
+        if (!file) throw std::runtime_error("Can't open " + path + "!");
+    }
+
+    ~NetlistOutput() {
+        if (!standardOutput) fclose(file);
+    }
+
+    void append(const char *text, size_t length) {
+        if (size + length > buffer.size()) flush();
+        memcpy(buffer.data() + size, text, length);
+        size += length;
+    }
+
+    void append(const char *text) {
+        append(text, strlen(text));
+    }
+
+    void append(char prefix, int number) {
+        char text[24] = {prefix};
+        append(text, formatInteger(number, text + 1) + 1);
+    }
+
+    void appendNode(int node, int branch, int position) {
+        char text[48] = {' '};
+        if (position < 0) {
+            append(text, formatInteger(node, text + 1) + 1);
+            return;
+        }
+        text[1] = 'b';
+        int length = formatInteger(branch, text + 2) + 2;
+        text[length++] = '_';
+        append(text, length + formatInteger(position, text + length));
+    }
+
+    void appendValue(double value) {
+        char text[32] = {' '};
+        int length = formatShortest(value, text + 1);
+        text[length + 1] = '\n';
+        append(text, length + 2);
+    }
+
+    void flush() {
+        if (size > 0 && fwrite(buffer.data(), 1, size, file) != size) throw std::runtime_error("Can't write netlist!");
+        size = 0;
+    }
+
+    void close() {
+        flush();
+        if (fflush(file) != 0) throw std::runtime_error("Can't write netlist!");
+    }
+};
+
+//A branch is its resistors followed by its voltage sources in series, joined by nodes b<branch>_<k>, or one current
+//source. Anything else (parasite resistors, reactive elements, meters) has no card in the netlist subset.
+void CircuitGenerator::writeNetlist(const CircuitArrays &arrays, const std::string &path, const std::string &title) {
+    int numberOfBranches = arrays.branchIds.size();
+    if (!arrays.capacitorIds.empty() || !arrays.inductorIds.empty() || !arrays.meters.empty())
+        throw std::domain_error("Only resistors and sources can be written as a netlist!");
+    for (double r : arrays.fixedResistances)
+        if (r != 0) throw std::domain_error("Only resistors and sources can be written as a netlist!");
+    for (int id : arrays.nodeIds)
+        if (id < 0) throw std::domain_error("Netlist nodes can't be negative!");
+    vector<int> resistorOffsets, voltageSourceOffsets, currentSourceOffsets;
+    vector<int> resistors = groupByBranch(arrays.resistorBranches, numberOfBranches, resistorOffsets);
+    vector<int> voltageSources = groupByBranch(arrays.voltageSourceBranches, numberOfBranches, voltageSourceOffsets);
+    vector<int> currentSources = groupByBranch(arrays.currentSourceBranches, numberOfBranches, currentSourceOffsets);
+
+    NetlistOutput output(path);
+    output.append("* ");
+    output.append(title.empty() ? "circuit" : title.c_str());
+    output.append("\n");
+    for (int b = 0; b < numberOfBranches; b++) {
+        int first = arrays.nodeIds[arrays.firstNodes[b]], second = arrays.nodeIds[arrays.secondNodes[b]];
+        int numberOfResistors = resistorOffsets[b + 1] - resistorOffsets[b];
+        int numberOfElements = numberOfResistors + voltageSourceOffsets[b + 1] - voltageSourceOffsets[b];
+        int numberOfCurrentSources = currentSourceOffsets[b + 1] - currentSourceOffsets[b];
+        if (numberOfCurrentSources > 0) {
+            if (numberOfCurrentSources > 1 || numberOfElements > 0)
+                throw std::domain_error("A current source has to be alone in its branch!");
+            int c = currentSources[currentSourceOffsets[b]];
+            bool natural = arrays.currentSourceOrientations[c] > 0;
+            output.append('I', arrays.currentSourceIds[c]);
+            output.appendNode(natural ? first : second, b, -1);
+            output.appendNode(natural ? second : first, b, -1);
+            output.appendValue(arrays.currents[c]);
+            continue;
+        }
+        if (numberOfElements == 0) throw std::domain_error("A short circuit can't be written as a netlist!");
+        for (int k = 0; k < numberOfElements; k++) {
+            //Element k goes from node k - 1 to node k of the branch, -1 being the first node and the last one
+            //the second node
+            int from = k == 0 ? -1 : k - 1, to = k + 1 == numberOfElements ? -1 : k;
+            int fromId = k == 0 ? first : 0, toId = to < 0 ? second : 0;
+            if (k < numberOfResistors) {
+                int r = resistors[resistorOffsets[b] + k];
+                output.append('R', arrays.resistorIds[r]);
+                output.appendNode(fromId, b, from);
+                output.appendNode(toId, b, to);
+                output.appendValue(arrays.resistances[r]);
+            } else {
+                //The source raises the potential from the first node towards the second one
+                int v = voltageSources[voltageSourceOffsets[b] + k - numberOfResistors];
+                bool natural = arrays.voltageSourceOrientations[v] > 0;
+                output.append('V', arrays.voltageSourceIds[v]);
+                output.appendNode(natural ? toId : fromId, b, natural ? to : from);
+                output.appendNode(natural ? fromId : toId, b, natural ? from : to);
+                output.appendValue(arrays.voltages[v]);
+            }
+        }
+    }
+    output.append(".END\n");
+    output.close();
+}
+
+CircuitFamily CircuitGenerator::getFamily(const std::string &name) {
+    for (int f = 0; f < sizeof(FAMILY_NAMES) / sizeof(FAMILY_NAMES[0]); f++)
+        if (name == FAMILY_NAMES[f]) return (CircuitFamily) f;
+    throw std::domain_error("Unknown circuit family " + name + "!");
+}
+
+std::string CircuitGenerator::getFamilyName(CircuitFamily family) {
+    return FAMILY_NAMES[(int) family];
+}
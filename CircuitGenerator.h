@@ -0,0 +1,110 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_CIRCUITGENERATOR_H
+#define CIRCUITANALYZER_CIRCUITGENERATOR_H
+
+#include <vector>
+#include <string>
+#include <random>
+#include <cstdint>
+#include "BinaryCircuit.h"
+
+using std::vector;
+
+//GRID_2D, GRID_3D: resistor meshes like the power grid of a chip, nodes on a lattice joined to their neighbours
+//LADDER: R-2R ladder, series resistors R along the rail, 2R from every rail node to the ground, R at the end
+//RANDOM: sparse random graph, a random spanning tree plus distinct random edges up to the average degree
+//TREE: random tree (every node hangs on a random earlier one), no loops without the sources
+enum class CircuitFamily {
+    GRID_2D, GRID_3D, LADDER, RANDOM, TREE
+};
+
+//PADS: voltage sources from the ground to nodes spread evenly over the structure (supply pads) and current sources
+//from nodes to the ground (loads), each on its own branch
+//RANDOM: voltage sources in series with random resistors, current sources in parallel with random resistors
+enum class SourcePlacement {
+    PADS, RANDOM
+};
+
+class GeneratorOptions {
+public:
+    CircuitFamily family = CircuitFamily::GRID_2D;
+    int numberOfBranches = 1000;         //about, grids are rounded to whole layers
+    uint64_t seed = 1;
+    double minResistance = 1;            //resistors are uniform in [min, max], the R of a ladder is min
+    double maxResistance = 10;
+    int degree = 4;                      //average node degree of RANDOM
+    int numberOfVoltageSources = 1;
+    int numberOfCurrentSources = 0;
+    SourcePlacement placement = SourcePlacement::PADS;
+    double voltage = 1;
+    double current = 1e-3;
+};
+
+//Seeded generator of large circuits for benchmarks and scaling tests
+//The same options give the same circuit on every platform: the random numbers are taken straight from the bits of
+//mt19937_64 (the distributions of <random> differ between standard libraries). Node 0 is the ground and belongs to
+//the structure, so every circuit is connected and has a solution. No two branches join the same nodes (older
+//routines like Circuit::getLoops() can't walk parallel branches), except the current sources of RANDOM placement
+//and sources of circuits with too few nodes. Ids of nodes, branches and of every component type are 0, 1, 2... in
+//the order of the arrays.
+//Circuits are made as CircuitArrays, the arrays of a binary circuit file, so 10^7 branches take a few hundred MB
+//instead of the gigabytes of a Circuit. generateCircuit() builds the Circuit for smaller sizes.
+
+class CircuitGenerator {
+    GeneratorOptions options;
+    std::mt19937_64 engine;
+    CircuitArrays arrays;
+
+public:
+    explicit CircuitGenerator(const GeneratorOptions &options);
+
+    const GeneratorOptions &getOptions() const;
+
+    CircuitArrays generate();
+
+    Circuit generateCircuit();
+
+    //One card per component, a resistor in series with a voltage source gets a named node between them
+    void writeNetlist(const std::string &path);
+
+    void writeBinary(const std::string &path);
+
+    static void writeNetlist(const CircuitArrays &arrays, const std::string &path, const std::string &title = "");
+
+    static CircuitFamily getFamily(const std::string &name);
+
+    static std::string getFamilyName(CircuitFamily family);
+
+private:
+    double getUniform();
+
+    int getIndex(int size);
+
+    double getResistance();
+
+    int addNodes(int count);
+
+    int addBranch(int firstNode, int secondNode);
+
+    int addResistor(int firstNode, int secondNode, double resistance);
+
+    void addVoltageSource(int branch, double voltage, int orientation);
+
+    void addCurrentSource(int branch, double current, int orientation);
+
+    void makeGrid(int width, int height, int depth);
+
+    void makeLadder(int numberOfBranches);
+
+    void makeRandomGraph(int numberOfBranches);
+
+    void makeTree(int numberOfBranches);
+
+    void placeSources();
+};
+
+
+#endif //CIRCUITANALYZER_CIRCUITGENERATOR_H
@@ -0,0 +1,303 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <iostream>
+#include <cstring>
+#include <cctype>
+#include <sstream>
+#include "BatchPipeline.h"
+#include "CircuitGenerator.h"
+#include "TraceRecorder.h"
+
+#ifndef _WIN32
+
+#include <sys/stat.h>
+
+#else
+
+#include <windows.h>
+
+#endif
+
+static const char *USAGE =
+        "Usage: CircuitAnalyzer                         interactive mode\n"
+        "       CircuitAnalyzer --batch [options] <directory | file... | --list file | --stream file>\n"
+        "       CircuitAnalyzer --generate family [options]\n"
+        "\n"
+        "Inputs:\n"
+        "  directory               every file of the directory, one netlist per file\n"
+        "  file...                 the files, one netlist per file\n"
+        "  --list file             the files named in the list, one per line\n"
+        "  --stream file           netlists one after another, each ended by .END (- for the standard input)\n"
+        "Options:\n"
+        "  --output file           results (default - for the standard output)\n"
+        "  --format name           csv, jsonl or binary (default csv)\n"
+        "  --parse-threads n       threads of each stage (default 1, 1, one per core)\n"
+        "  --assemble-threads n\n"
+        "  --solve-threads n\n"
+        "  --queue n               circuits waiting between two stages (default 64)\n"
+        "  --no-currents           leave out branch currents\n"
+        "  --no-voltages           leave out node voltages\n"
+        "  --no-meters             don't read the meters\n"
+        "  --meters i,j,...        only these meters (indices, voltmeters first, then ampermeters and wattmeters)\n"
+        "  --trace file            timeline of the stages and solver phases of every thread, Chrome trace JSON for\n"
+        "                          Perfetto or chrome://tracing\n"
+        "  --trace-events n        events kept per thread, the oldest are dropped (default 16384)\n"
+        "  --quiet                 no statistics on the standard error\n"
+        "Exit status: 0, 1 if the batch couldn't run, 2 if some circuits failed\n"
+        "\n"
+        "Families: grid2d, grid3d, ladder (R-2R), random (sparse graph), tree\n"
+        "Generator options:\n"
+        "  --branches n            about n branches (default 1000)\n"
+        "  --seed n                the same seed gives the same circuit (default 1)\n"
+        "  --degree n              average node degree of random (default 4)\n"
+        "  --resistance min,max    range of the resistors, the R of a ladder is min (default 1,10)\n"
+        "  --voltage-sources n     default 1, of --voltage volts (default 1)\n"
+        "  --current-sources n     default 0, of --current amperes (default 0.001)\n"
+        "  --placement name        pads (supply pads and loads to the ground) or random (in series and in parallel\n"
+        "                          with random resistors), default pads\n"
+        "  --format name           netlist or binary (default netlist)\n"
+        "  --output file           default - for the standard output (netlist only)\n";
+
+static bool isDirectory(const std::string &path) {
+#ifndef _WIN32
+    struct stat status;
+    return stat(path.c_str(), &status) == 0 && S_ISDIR(status.st_mode);
+#else
+    DWORD attributes = GetFileAttributesA(path.c_str());
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#endif
+}
+
+static int parseCount(const std::string &option, const std::string &text) {
+    size_t length = 0;
+    int value = -1;
+    try {
+        value = std::stoi(text, &length);
+    } catch (const std::exception &) {
+    }
+    if (length != text.size() || value < 0) throw std::domain_error("Wrong value of " + option + "!");
+    return value;
+}
+
+static double parseValue(const std::string &option, const std::string &text) {
+    size_t length = 0;
+    double value = 0;
+    try {
+        value = std::stod(text, &length);
+    } catch (const std::exception &) {
+    }
+    if (length == 0 || length != text.size()) throw std::domain_error("Wrong value of " + option + "!");
+    return value;
+}
+
+static uint64_t parseSeed(const std::string &option, const std::string &text) {
+    size_t length = 0;
+    uint64_t value = 0;
+    try {
+        value = std::stoull(text, &length);
+    } catch (const std::exception &) {
+    }
+    if (length == 0 || length != text.size() || text[0] == '-')
+        throw std::domain_error("Wrong value of " + option + "!");
+    return value;
+}
+
+static vector<int> parseIndices(const std::string &option, const std::string &text) {
+    vector<int> indices;
+    std::stringstream list(text);
+    std::string index;
+    while (std::getline(list, index, ','))
+        indices.push_back(parseCount(option, index));
+    return indices;
+}
+
+static int runBatch(int argc, char *argv[]) {
+    PipelineOptions options;
+    vector<std::string> files;
+    std::string list, stream, trace;
+    bool quiet = false;
+    for (int i = 2; i < argc; i++) {
+        std::string argument = argv[i];
+        auto getValue = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::domain_error(argument + " needs a value!");
+            return argv[++i];
+        };
+        if (argument == "--output") options.outputPath = getValue();
+        else if (argument == "--format") {
+            std::string format = getValue();
+            if (format == "csv") options.format = ResultFormat::CSV;
+            else if (format == "jsonl") options.format = ResultFormat::JSON_LINES;
+            else if (format == "binary") options.format = ResultFormat::BINARY;
+            else throw std::domain_error("Unknown format " + format + "!");
+        } else if (argument == "--parse-threads") options.parseThreads = parseCount(argument, getValue());
+        else if (argument == "--assemble-threads") options.assembleThreads = parseCount(argument, getValue());
+        else if (argument == "--solve-threads") options.solveThreads = parseCount(argument, getValue());
+        else if (argument == "--queue") options.queueCapacity = std::max(1, parseCount(argument, getValue()));
+        else if (argument == "--no-currents") options.columns.branchCurrents = false;
+        else if (argument == "--no-voltages") options.columns.nodeVoltages = false;
+        else if (argument == "--no-meters") options.readMeters = options.columns.meterReadings = false;
+        else if (argument == "--meters") options.columns.meters = parseIndices(argument, getValue());
+        else if (argument == "--list") list = getValue();
+        else if (argument == "--stream") stream = getValue();
+        else if (argument == "--trace") trace = getValue();
+        else if (argument == "--trace-events")
+            TraceRecorder::getInstance().setBufferCapacity(std::max(1, parseCount(argument, getValue())));
+        else if (argument == "--quiet") quiet = true;
+        else if (argument.size() > 2 && argument.compare(0, 2, "--") == 0)
+            throw std::domain_error("Unknown option " + argument + "!");
+        else files.push_back(argument);
+    }
+    if (files.empty() + list.empty() + stream.empty() != 2) throw std::domain_error("Give exactly one kind of input!");
+
+    if (!trace.empty()) TraceRecorder::setEnabled(true);
+    BatchPipeline pipeline(options);
+    PipelineStatistics statistics;
+    if (!stream.empty()) statistics = pipeline.runStream(stream);
+    else {
+        if (!list.empty()) files = BatchPipeline::readFileList(list);
+        else if (files.size() == 1 && isDirectory(files[0])) files = BatchPipeline::listDirectory(files[0]);
+        statistics = pipeline.runFiles(files);
+    }
+    if (!quiet) statistics.print(std::cerr);
+    if (!trace.empty()) {
+        TraceRecorder &recorder = TraceRecorder::getInstance();
+        recorder.writeJson(trace);
+        if (!quiet)
+            std::cerr << recorder.getNumberOfEvents() << " trace events, " << recorder.getNumberOfDroppedEvents()
+                      << " dropped\n";
+    }
+    return statistics.numberOfFailures > 0 ? 2 : 0;
+}
+
+static int runGenerator(int argc, char *argv[]) {
+    if (argc < 3) throw std::domain_error("--generate needs a family!");
+    GeneratorOptions options;
+    options.family = CircuitGenerator::getFamily(argv[2]);
+    std::string output = "-";
+    bool binary = false;
+    for (int i = 3; i < argc; i++) {
+        std::string argument = argv[i];
+        auto getValue = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::domain_error(argument + " needs a value!");
+            return argv[++i];
+        };
+        if (argument == "--branches") options.numberOfBranches = parseCount(argument, getValue());
+        else if (argument == "--seed") options.seed = parseSeed(argument, getValue());
+        else if (argument == "--degree") options.degree = parseCount(argument, getValue());
+        else if (argument == "--resistance") {
+            std::string range = getValue();
+            size_t comma = range.find(',');
+            if (comma == std::string::npos) throw std::domain_error("Wrong value of " + argument + "!");
+            options.minResistance = parseValue(argument, range.substr(0, comma));
+            options.maxResistance = parseValue(argument, range.substr(comma + 1));
+        } else if (argument == "--voltage-sources") options.numberOfVoltageSources = parseCount(argument, getValue());
+        else if (argument == "--current-sources") options.numberOfCurrentSources = parseCount(argument, getValue());
+        else if (argument == "--voltage") options.voltage = parseValue(argument, getValue());
+        else if (argument == "--current") options.current = parseValue(argument, getValue());
+        else if (argument == "--placement") {
+            std::string placement = getValue();
+            if (placement == "pads") options.placement = SourcePlacement::PADS;
+            else if (placement == "random") options.placement = SourcePlacement::RANDOM;
+            else throw std::domain_error("Unknown placement " + placement + "!");
+        } else if (argument == "--format") {
+            std::string format = getValue();
+            if (format == "binary") binary = true;
+            else if (format != "netlist") throw std::domain_error("Unknown format " + format + "!");
+        } else if (argument == "--output") output = getValue();
+        else throw std::domain_error("Unknown option " + argument + "!");
+    }
+    if (binary && output == "-") throw std::domain_error("Binary circuits need an --output file!");
+
+    CircuitGenerator generator(options);
+    if (binary) generator.writeBinary(output);
+    else generator.writeNetlist(output);
+    return 0;
+}
+
+static int runInteractive() {
+    Circuit c;
+    char choice;
+    bool breakLoop = false;
+    int id = 0;
+    int node1, node2;
+    double resistance;
+    double voltage;
+    double current;
+    while (true) {
+        std::cout << "Enter R for resistor, C for current source, E for voltage source, A for ampermeter, "
+                     "or V for voltmeter (X for exit):\n";
+        if (!(std::cin >> choice)) break;
+        choice = toupper(choice);
+        switch (choice) {
+            case 'R':
+                std::cout << "Enter resistance:\n";
+                std::cin >> resistance;
+                std::cout << "Enter nodes (two integers):\n";
+                std::cin >> node1 >> node2;
+                c.addResistorToCircuit(Resistor(resistance, id++), node1, node2);
+                break;
+            case 'C':
+                std::cout << "Enter current:\n";
+                std::cin >> current;
+                std::cout << "Enter nodes (two integers):\n";
+                std::cin >> node1 >> node2;
+                std::cout << "Enter internal resistance (-1 for ideal):\n";
+                std::cin >> resistance;
+                c.addCurrentSourceToCircuit(CurrentSource(id++, current, resistance), node1, node2);
+                break;
+            case 'E':
+                std::cout << "Enter voltage:\n";
+                std::cin >> voltage;
+                std::cout << "Enter nodes (two integers):\n";
+                std::cin >> node1 >> node2;
+                std::cout << "Enter internal resistance (0 for ideal):\n";
+                std::cin >> resistance;
+                c.addVoltageSourceToCircuit(VoltageSource(id++, voltage, resistance), node1, node2);
+                break;
+            case 'A':
+                std::cout << "Enter internal resistance (0 for ideal):\n";
+                std::cin >> resistance;
+                std::cout << "Enter nodes (two integers):\n";
+                std::cin >> node1 >> node2;
+                c.addAmpermeterToCircuit(Ampermeter(id++, resistance), node1, node2);
+                break;
+            case 'V':
+                std::cout << "Enter internal resistance (-1 for ideal):\n";
+                std::cin >> resistance;
+                std::cout << "Enter nodes (two integers):\n";
+                std::cin >> node1 >> node2;
+                c.addVoltmeterToCircuit(Voltmeter(id++, resistance), node1, node2);
+                break;
+            case 'X':
+                breakLoop = true;
+                break;
+            default :
+                std::cout << "Wrong letter!\n";
+        }
+        if (breakLoop) break;
+    }
+    c.removeObsoleteBranches();
+    std::cout << c;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) return runInteractive();
+    if (strcmp(argv[1], "--help") == 0) {
+        std::cout << USAGE;
+        return 0;
+    }
+    bool generate = strcmp(argv[1], "--generate") == 0;
+    if (!generate && strcmp(argv[1], "--batch") != 0) {
+        std::cerr << USAGE;
+        return 1;
+    }
+    try {
+        return generate ? runGenerator(argc, argv) : runBatch(argc, argv);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,953 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <algorithm>
+#include <queue>
+#include "CompiledCircuit.h"
+#include "TopologyCache.h"
+
+static const int LOOP_SEARCH_BRANCHES = 1024;
+
+CircuitTopology::CircuitTopology(Circuit &circuit, bool dynamic) : dynamic(dynamic) {
+    PhaseTimer timer(phases, AnalysisPhase::TOPOLOGY);
+    vector<Branch> &branches = circuit.getBranches();
+    std::set<Node> nodes = circuit.getNodes();
+    for (const auto &n : nodes)
+        nodeIds.push_back(n.getId());
+
+    for (int i = 0; i < branches.size(); i++) {
+        Branch &b = branches.at(i);
+        branchIds.push_back(b.getId());
+        firstNodes.push_back(getNodeIndex(b.getFirstNode().getId()));
+        secondNodes.push_back(getNodeIndex(b.getSecondNode().getId()));
+        currentFixed.push_back(b.hasCurrentSources() || fabs(b.getResistance() + 1) < EPSILON ||
+                               (!dynamic && b.hasCapacitors()));
+
+        double fixedResistance = 0;
+        for (const auto &r : b.getResistors()) {
+            if (r.getId() == -1) {
+                if (!r.hasInfiniteResistance()) fixedResistance += r.getResistance();
+            } else {
+                resistorIds.push_back(r.getId());
+                resistorBranches.push_back(i);
+            }
+        }
+        fixedResistances.push_back(fixedResistance);
+
+        for (const auto &v : b.getVoltageSources()) {
+            voltageSourceIds.push_back(v.getId());
+            voltageSourceBranches.push_back(i);
+            voltageSourceOrientations.push_back(v.isNaturalOrientation() ? 1 : -1);
+        }
+
+        //all current sources in a branch have the same current, the first one sets it
+        branchCurrentSource.push_back(b.hasCurrentSources() ? (int) currentSourceIds.size() : -1);
+        for (const auto &c : b.getCurrentSources()) {
+            currentSourceIds.push_back(c.getId());
+            currentSourceBranches.push_back(i);
+            currentSourceOrientations.push_back(c.isNaturalOrientation() ? 1 : -1);
+        }
+
+        for (const auto &c : b.getCapacitors()) {
+            capacitorIds.push_back(c.getId());
+            capacitorBranches.push_back(i);
+        }
+        for (const auto &l : b.getInductors()) {
+            inductorIds.push_back(l.getId());
+            inductorBranches.push_back(i);
+        }
+        for (const auto &e : b.getNonlinearElements()) {
+            nonlinearIds.push_back(e->getId());
+            nonlinearBranches.push_back(i);
+        }
+    }
+
+    analyse(timer);
+}
+
+CircuitTopology::CircuitTopology(bool dynamic) : dynamic(dynamic) {}
+
+//Circuits that only differ in component values share the structure analysed for the first of them
+//timer is running the TOPOLOGY phase of this topology
+void CircuitTopology::analyse(PhaseTimer &timer) {
+    TopologyCache &cache = TopologyCache::getInstance();
+    vector<uint64_t> key = TopologyStructure::getKey(dynamic, getNumberOfNodes(), firstNodes, secondNodes,
+                                                     currentFixed);
+    uint64_t hash = 0;
+    for (auto x : key)
+        hash = mixHash(hash, x);
+    structureHash = hash;
+    std::shared_ptr<const TopologyStructure> structure = cache.find(key, hash);
+    cachedStructure = structure != nullptr;
+    if (structure != nullptr) {
+        setStructure(*structure);
+        return;
+    }
+
+    buildTree();
+    timer.next(AnalysisPhase::LOOPS);
+    buildLoops();
+    timer.next(AnalysisPhase::PATTERN);
+    buildPattern();
+    timer.stop();
+    cache.insert(getStructure(std::move(key), hash));
+}
+
+void CircuitTopology::setStructure(const TopologyStructure &structure) {
+    treeParentBranch = structure.treeParentBranch;
+    treeParentNode = structure.treeParentNode;
+    treeDepth = structure.treeDepth;
+    treeOrder = structure.treeOrder;
+    treeBranches = structure.treeBranches;
+    loops = structure.loops;
+    pattern = structure.pattern;
+    entryBranch = structure.entryBranch;
+    entrySign = structure.entrySign;
+    loopRows = structure.loopRows;
+    fixedCurrentRows = structure.fixedCurrentRows;
+    nodeRows = structure.nodeRows;
+    symbolic = structure.symbolic;
+}
+
+std::shared_ptr<const TopologyStructure> CircuitTopology::getStructure(vector<uint64_t> key, uint64_t hash) const {
+    auto structure = std::make_shared<TopologyStructure>();
+    structure->key = std::move(key);
+    structure->hash = hash;
+    structure->treeParentBranch = treeParentBranch;
+    structure->treeParentNode = treeParentNode;
+    structure->treeDepth = treeDepth;
+    structure->treeOrder = treeOrder;
+    structure->treeBranches = treeBranches;
+    structure->loops = loops;
+    structure->pattern = pattern;
+    structure->entryBranch = entryBranch;
+    structure->entrySign = entrySign;
+    structure->loopRows = loopRows;
+    structure->fixedCurrentRows = fixedCurrentRows;
+    structure->nodeRows = nodeRows;
+    structure->symbolic = symbolic;
+    return structure;
+}
+
+//Branches at every node, of the branches without fixed current that aren't a loop by themselves
+static void buildAdjacency(const CircuitTopology &t, vector<int> &adjacencyPointers, vector<int> &adjacentBranches) {
+    int numberOfNodes = t.getNumberOfNodes();
+    adjacencyPointers.assign(numberOfNodes + 1, 0);
+    for (int b = 0; b < t.getNumberOfBranches(); b++) {
+        if (t.currentFixed[b] || t.firstNodes[b] == t.secondNodes[b]) continue;
+        adjacencyPointers[t.firstNodes[b] + 1]++;
+        adjacencyPointers[t.secondNodes[b] + 1]++;
+    }
+    for (int n = 0; n < numberOfNodes; n++)
+        adjacencyPointers[n + 1] += adjacencyPointers[n];
+    adjacentBranches.resize(adjacencyPointers[numberOfNodes]);
+    vector<int> next(adjacencyPointers.begin(), adjacencyPointers.end() - 1);
+    for (int b = 0; b < t.getNumberOfBranches(); b++) {
+        if (t.currentFixed[b] || t.firstNodes[b] == t.secondNodes[b]) continue;
+        adjacentBranches[next[t.firstNodes[b]]++] = b;
+        adjacentBranches[next[t.secondNodes[b]]++] = b;
+    }
+}
+
+//Spanning tree (a forest if current sources split the circuit) built breadth first over branches without fixed current
+void CircuitTopology::buildTree() {
+    int numberOfNodes = getNumberOfNodes();
+    vector<int> adjacencyPointers, adjacentBranches;
+    buildAdjacency(*this, adjacencyPointers, adjacentBranches);
+
+    treeParentBranch.assign(numberOfNodes, -1);
+    treeParentNode.assign(numberOfNodes, -1);
+    treeDepth.assign(numberOfNodes, -1);
+    treeOrder.clear();
+    treeBranches.clear();
+    std::queue<int> nodesToVisit;
+    for (int root = 0; root < numberOfNodes; root++) {
+        if (treeDepth[root] >= 0) continue;
+        treeDepth[root] = 0;
+        nodesToVisit.push(root);
+        while (!nodesToVisit.empty()) {
+            int n = nodesToVisit.front();
+            nodesToVisit.pop();
+            treeOrder.push_back(n);
+            for (int p = adjacencyPointers[n]; p < adjacencyPointers[n + 1]; p++) {
+                int b = adjacentBranches[p];
+                int other = firstNodes[b] == n ? secondNodes[b] : firstNodes[b];
+                if (treeDepth[other] >= 0) continue;
+                treeDepth[other] = treeDepth[n] + 1;
+                treeParentNode[other] = n;
+                treeParentBranch[other] = b;
+                treeBranches.push_back(b);
+                nodesToVisit.push(other);
+            }
+        }
+    }
+}
+
+//Every branch outside of the tree (a chord) closes one loop. The loop returns from the second to the first node of
+//its chord over the shortest path through the tree and the chords before it, so every loop has one chord that no loop
+//before it has and the loops are independent. Chords are taken in the order of the depth of their nodes, the chords
+//around them come first: on a grid the loops are its meshes, not the long paths of the tree, and the equations stay
+//sparse. The search looks at most at LOOP_SEARCH_BRANCHES branches, past that the loop returns through the tree.
+void CircuitTopology::buildLoops() {
+    int numberOfNodes = getNumberOfNodes();
+    int numberOfBranches = getNumberOfBranches();
+    vector<bool> usable(numberOfBranches, false);
+    for (auto b : treeBranches)
+        usable[b] = true;
+    vector<int> chords;
+    for (int b = 0; b < numberOfBranches; b++)
+        if (!usable[b] && !currentFixed[b]) chords.push_back(b);
+    std::stable_sort(chords.begin(), chords.end(), [this](int a, int b) -> bool {
+        return std::max(treeDepth[firstNodes[a]], treeDepth[secondNodes[a]]) <
+               std::max(treeDepth[firstNodes[b]], treeDepth[secondNodes[b]]);
+    });
+    vector<int> adjacencyPointers, adjacentBranches;
+    buildAdjacency(*this, adjacencyPointers, adjacentBranches);
+
+    loops.clear();
+    vector<int> visited(numberOfNodes, -1), arrivedThrough(numberOfNodes, -1), nodesToVisit;
+    vector<LoopBranch> pathFromSecondNode;
+    vector<LoopBranch> pathFromFirstNode;
+    for (int c = 0; c < chords.size(); c++) {
+        int b = chords[c];
+        int fromSecond = secondNodes[b];
+        int fromFirst = firstNodes[b];
+        vector<LoopBranch> loop;
+        loop.push_back({b, 1});
+
+        //breadth first from the second node until the first one is reached
+        nodesToVisit.assign(1, fromSecond);
+        visited[fromSecond] = c;
+        bool found = fromSecond == fromFirst;
+        int budget = LOOP_SEARCH_BRANCHES;
+        for (int head = 0; head < nodesToVisit.size() && !found && budget > 0; head++) {
+            int n = nodesToVisit[head];
+            for (int p = adjacencyPointers[n]; p < adjacencyPointers[n + 1] && budget-- > 0; p++) {
+                int e = adjacentBranches[p];
+                int other = firstNodes[e] == n ? secondNodes[e] : firstNodes[e];
+                if (!usable[e] || visited[other] == c) continue;
+                visited[other] = c;
+                arrivedThrough[other] = e;
+                nodesToVisit.push_back(other);
+                if (other == fromFirst) {
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if (found) {
+            pathFromFirstNode.clear();
+            for (int n = fromFirst; n != fromSecond;) {
+                int e = arrivedThrough[n];
+                int previous = firstNodes[e] == n ? secondNodes[e] : firstNodes[e];
+                pathFromFirstNode.push_back({e, firstNodes[e] == previous ? 1 : -1});
+                n = previous;
+            }
+            loop.insert(loop.end(), pathFromFirstNode.rbegin(), pathFromFirstNode.rend());
+        } else {
+            //through the tree
+            pathFromSecondNode.clear();
+            pathFromFirstNode.clear();
+            while (fromSecond != fromFirst) {
+                if (treeDepth[fromSecond] >= treeDepth[fromFirst]) {
+                    int e = treeParentBranch[fromSecond];
+                    pathFromSecondNode.push_back({e, firstNodes[e] == fromSecond ? 1 : -1});
+                    fromSecond = treeParentNode[fromSecond];
+                } else {
+                    int e = treeParentBranch[fromFirst];
+                    pathFromFirstNode.push_back({e, firstNodes[e] == fromFirst ? -1 : 1});
+                    fromFirst = treeParentNode[fromFirst];
+                }
+            }
+            loop.insert(loop.end(), pathFromSecondNode.begin(), pathFromSecondNode.end());
+            loop.insert(loop.end(), pathFromFirstNode.rbegin(), pathFromFirstNode.rend());
+        }
+        loops.push_back(loop);
+        usable[b] = true;
+    }
+}
+
+void CircuitTopology::buildPattern() {
+    int numberOfBranches = getNumberOfBranches();
+    int numberOfNodes = getNumberOfNodes();
+    vector<vector<int>> columnRows(numberOfBranches);
+    vector<vector<int>> columnBranches(numberOfBranches);
+    vector<vector<double>> columnSigns(numberOfBranches);
+    int row = 0;
+
+    loopRows.clear();
+    for (const auto &loop : loops) {
+        for (const auto &lb : loop) {
+            columnRows[lb.branch].push_back(row);
+            columnBranches[lb.branch].push_back(lb.branch);
+            columnSigns[lb.branch].push_back(lb.orientation);
+        }
+        loopRows.push_back(row++);
+    }
+
+    fixedCurrentRows.assign(numberOfBranches, -1);
+    for (int b = 0; b < numberOfBranches; b++) {
+        if (!currentFixed[b]) continue;
+        columnRows[b].push_back(row);
+        columnBranches[b].push_back(-1);
+        columnSigns[b].push_back(1);
+        fixedCurrentRows[b] = row++;
+    }
+
+    //roots of the tree components are left out, their equations follow from the others
+    nodeRows.assign(numberOfNodes, -1);
+    for (int n = 0; n < numberOfNodes; n++)
+        if (treeParentBranch[n] >= 0) nodeRows[n] = row++;
+    for (int b = 0; b < numberOfBranches; b++) {
+        if (firstNodes[b] == secondNodes[b]) continue;
+        if (nodeRows[firstNodes[b]] >= 0) {
+            columnRows[b].push_back(nodeRows[firstNodes[b]]);
+            columnBranches[b].push_back(-1);
+            columnSigns[b].push_back(-1);
+        }
+        if (nodeRows[secondNodes[b]] >= 0) {
+            columnRows[b].push_back(nodeRows[secondNodes[b]]);
+            columnBranches[b].push_back(-1);
+            columnSigns[b].push_back(1);
+        }
+    }
+
+    if (row != numberOfBranches)
+        throw std::logic_error("Number of equations doesn't match the number of branches!");
+
+    auto newPattern = std::make_shared<SparsePattern>();
+    newPattern->size = numberOfBranches;
+    newPattern->columnPointers.push_back(0);
+    entryBranch.clear();
+    entrySign.clear();
+    for (int b = 0; b < numberOfBranches; b++) {
+        newPattern->rowIndices.insert(newPattern->rowIndices.end(), columnRows[b].begin(), columnRows[b].end());
+        entryBranch.insert(entryBranch.end(), columnBranches[b].begin(), columnBranches[b].end());
+        entrySign.insert(entrySign.end(), columnSigns[b].begin(), columnSigns[b].end());
+        newPattern->columnPointers.push_back(newPattern->rowIndices.size());
+    }
+    pattern = newPattern;
+    symbolic = SparseLU<double>(pattern).getSymbolic();
+}
+
+int CircuitTopology::getNumberOfBranches() const {
+    return branchIds.size();
+}
+
+int CircuitTopology::getNumberOfNodes() const {
+    return nodeIds.size();
+}
+
+int CircuitTopology::getNumberOfLoops() const {
+    return loops.size();
+}
+
+AnalysisStatistics CircuitTopology::getStatistics() const {
+    AnalysisStatistics statistics;
+    statistics.numberOfBranches = getNumberOfBranches();
+    statistics.numberOfNodes = getNumberOfNodes();
+    statistics.numberOfLoops = getNumberOfLoops();
+    statistics.matrixNonZeros = pattern->getNumberOfNonZeros();
+    statistics.cachedTopology = cachedStructure;
+    for (int i = 0; i < NUMBER_OF_TOPOLOGY_PHASES; i++)
+        statistics.phases[i] = phases[i];
+    return statistics;
+}
+
+int CircuitTopology::getNodeIndex(int nodeId) const {
+    auto it = std::lower_bound(nodeIds.begin(), nodeIds.end(), nodeId);
+    if (it == nodeIds.end() || *it != nodeId) return -1;
+    return it - nodeIds.begin();
+}
+
+int CircuitTopology::getBranchIndex(int branchId) const {
+    auto it = std::find(branchIds.begin(), branchIds.end(), branchId);
+    if (it == branchIds.end()) return -1;
+    return it - branchIds.begin();
+}
+
+int CircuitTopology::getResistorIndex(int resistorId) const {
+    auto it = std::find(resistorIds.begin(), resistorIds.end(), resistorId);
+    if (it == resistorIds.end()) return -1;
+    return it - resistorIds.begin();
+}
+
+int CircuitTopology::getVoltageSourceIndex(int voltageSourceId) const {
+    auto it = std::find(voltageSourceIds.begin(), voltageSourceIds.end(), voltageSourceId);
+    if (it == voltageSourceIds.end()) return -1;
+    return it - voltageSourceIds.begin();
+}
+
+int CircuitTopology::getCurrentSourceIndex(int currentSourceId) const {
+    auto it = std::find(currentSourceIds.begin(), currentSourceIds.end(), currentSourceId);
+    if (it == currentSourceIds.end()) return -1;
+    return it - currentSourceIds.begin();
+}
+
+int CircuitTopology::getComponentIndex(ComponentType type, int componentId) const {
+    const vector<int> *ids = &currentSourceIds;
+    if (type == ComponentType::RESISTOR) ids = &resistorIds;
+    else if (type == ComponentType::VOLTAGE_SOURCE) ids = &voltageSourceIds;
+    else if (type == ComponentType::CAPACITOR) ids = &capacitorIds;
+    else if (type == ComponentType::INDUCTOR) ids = &inductorIds;
+    auto it = std::find(ids->begin(), ids->end(), componentId);
+    if (it == ids->end()) return -1;
+    return it - ids->begin();
+}
+
+//Reads the component values of a circuit with the same structure as the one this topology was made from
+//Sources oriented against their orientation in the topology get negative values
+ComponentValues CircuitTopology::getValuesOf(Circuit &circuit) const {
+    ComponentValues values;
+    for (auto &b : circuit.getBranches()) {
+        for (const auto &r : b.getResistors())
+            if (r.getId() != -1) values.resistances.push_back(r.getResistance());
+        for (const auto &v : b.getVoltageSources()) {
+            int orientation = v.isNaturalOrientation() ? 1 : -1;
+            if (values.voltages.size() < voltageSourceIds.size())
+                orientation *= voltageSourceOrientations[values.voltages.size()];
+            values.voltages.push_back(orientation * v.getVoltage());
+        }
+        for (const auto &c : b.getCurrentSources()) {
+            int orientation = c.isNaturalOrientation() ? 1 : -1;
+            if (values.currents.size() < currentSourceIds.size())
+                orientation *= currentSourceOrientations[values.currents.size()];
+            values.currents.push_back(orientation * c.getCurrent());
+        }
+        for (const auto &c : b.getCapacitors())
+            values.capacitances.push_back(c.getCapacitance());
+        for (const auto &l : b.getInductors())
+            values.inductances.push_back(l.getInductance());
+    }
+    if (values.resistances.size() != resistorIds.size() || values.voltages.size() != voltageSourceIds.size() ||
+        values.currents.size() != currentSourceIds.size() || values.capacitances.size() != capacitorIds.size() ||
+        values.inductances.size() != inductorIds.size())
+        throw std::logic_error("Circuit doesn't match the topology!");
+    return values;
+}
+
+//Sums the component values into the resistance, voltage and source current of each branch
+void CircuitTopology::getBranchValues(const ComponentValues &values, vector<double> &resistances,
+                                      vector<double> &voltages, vector<double> &currents) const {
+    resistances = fixedResistances;
+    voltages.assign(getNumberOfBranches(), 0.0);
+    currents.assign(getNumberOfBranches(), 0.0);
+    for (int i = 0; i < resistorIds.size(); i++)
+        resistances[resistorBranches[i]] += values.resistances[i];
+    for (int i = 0; i < voltageSourceIds.size(); i++)
+        voltages[voltageSourceBranches[i]] += voltageSourceOrientations[i] * values.voltages[i];
+    for (int b = 0; b < getNumberOfBranches(); b++) {
+        int c = branchCurrentSource[b];
+        if (c >= 0) currents[b] = currentSourceOrientations[c] * values.currents[c];
+    }
+}
+
+//Series capacitance (0 if the branch has no capacitor) and inductance of each branch
+void CircuitTopology::getBranchReactiveValues(const ComponentValues &values, vector<double> &capacitances,
+                                              vector<double> &inductances) const {
+    vector<double> inverseCapacitances(getNumberOfBranches(), 0.0);
+    inductances.assign(getNumberOfBranches(), 0.0);
+    for (int i = 0; i < capacitorIds.size(); i++)
+        inverseCapacitances[capacitorBranches[i]] += 1 / values.capacitances[i];
+    for (int i = 0; i < inductorIds.size(); i++)
+        inductances[inductorBranches[i]] += values.inductances[i];
+    capacitances.assign(getNumberOfBranches(), 0.0);
+    for (int b = 0; b < getNumberOfBranches(); b++)
+        if (inverseCapacitances[b] > 0) capacitances[b] = 1 / inverseCapacitances[b];
+}
+
+//Root of the tree of node, nodes in different trees (split by current sources) have no path between them
+int CircuitTopology::getTreeRoot(int node) const {
+    while (treeParentNode[node] >= 0)
+        node = treeParentNode[node];
+    return node;
+}
+
+//Tree branches between two nodes with the sign of their E - I * R in V(secondNode) - V(firstNode)
+vector<LoopBranch> CircuitTopology::getNodeVoltagePath(int firstNode, int secondNode) const {
+    vector<LoopBranch> path;
+    while (firstNode != secondNode && (treeParentBranch[firstNode] >= 0 || treeParentBranch[secondNode] >= 0)) {
+        if (treeDepth[secondNode] >= treeDepth[firstNode]) {
+            int b = treeParentBranch[secondNode];
+            path.push_back({b, firstNodes[b] == treeParentNode[secondNode] ? 1 : -1});
+            secondNode = treeParentNode[secondNode];
+        } else {
+            int b = treeParentBranch[firstNode];
+            path.push_back({b, firstNodes[b] == treeParentNode[firstNode] ? -1 : 1});
+            firstNode = treeParentNode[firstNode];
+        }
+    }
+    return path;
+}
+
+vector<double> CircuitTopology::getNodeVoltages(const ComponentValues &values,
+                                                const vector<double> &branchCurrents) const {
+    vector<double> resistances, voltages, currents, nodeVoltages;
+    getBranchValues(values, resistances, voltages, currents);
+    getNodeVoltages(resistances, voltages, branchCurrents, nodeVoltages);
+    return nodeVoltages;
+}
+
+//Node voltages follow from the branch currents along the tree, the root of each tree component is at 0V
+//For every branch: V(secondNode) = V(firstNode) + E - I * R
+void CircuitTopology::getNodeVoltages(const vector<double> &branchResistances, const vector<double> &branchVoltages,
+                                      const vector<double> &branchCurrents, vector<double> &nodeVoltages) const {
+    nodeVoltages.assign(getNumberOfNodes(), 0.0);
+    for (auto n : treeOrder) {
+        int b = treeParentBranch[n];
+        if (b < 0) continue;
+        double drop = branchVoltages[b] - branchCurrents[b] * branchResistances[b];
+        if (firstNodes[b] == treeParentNode[n]) nodeVoltages[n] = nodeVoltages[treeParentNode[n]] + drop;
+        else nodeVoltages[n] = nodeVoltages[treeParentNode[n]] - drop;
+    }
+}
+
+CompiledCircuit::CompiledCircuit(Circuit &circuit) : CompiledCircuit(std::make_shared<CircuitTopology>(circuit)) {
+    PhaseTimer timer(statistics, AnalysisPhase::ASSEMBLY);
+    refactor(topology->getValuesOf(circuit), timer);
+}
+
+CompiledCircuit::CompiledCircuit(std::shared_ptr<const CircuitTopology> topology) :
+        topology(topology), lu(topology->pattern, topology->symbolic),
+        singleLu(topology->pattern, topology->symbolic), statistics(topology->getStatistics()) {}
+
+const std::shared_ptr<const CircuitTopology> &CompiledCircuit::getTopology() const {
+    return topology;
+}
+
+const ComponentValues &CompiledCircuit::getValues() const {
+    return values;
+}
+
+const SparseLU<double> &CompiledCircuit::getFactorization() const {
+    return lu;
+}
+
+void CompiledCircuit::refactor(const ComponentValues &values) {
+    PhaseTimer timer(statistics, AnalysisPhase::ASSEMBLY);
+    refactor(values, timer);
+}
+
+//Lower level access for analyses that compute the branch values themselves (companion models)
+void CompiledCircuit::refactorBranches(const vector<double> &resistances) {
+    PhaseTimer timer(statistics, AnalysisPhase::ASSEMBLY);
+    refactorBranches(resistances, timer);
+}
+
+//timer is running the ASSEMBLY phase, so that one read of the clock separates it from the factorization
+void CompiledCircuit::refactor(const ComponentValues &values, PhaseTimer &timer) {
+    this->values = values;
+    vector<double> resistances;
+    topology->getBranchValues(values, resistances, branchVoltages, branchCurrentsFromSources);
+    refactorBranches(resistances, timer);
+}
+
+void CompiledCircuit::refactorBranches(const vector<double> &resistances, PhaseTimer &timer) {
+    const CircuitTopology &t = *topology;
+    branchResistances = resistances;
+    matrixValues.resize(t.entryBranch.size());
+    for (int p = 0; p < t.entryBranch.size(); p++) {
+        int b = t.entryBranch[p];
+        matrixValues[p] = b < 0 ? t.entrySign[p] : t.entrySign[p] * branchResistances[b];
+    }
+    timer.next(AnalysisPhase::FACTORIZATION);
+    singlePrecisionFactored = false;
+    if (precision == SolverPrecision::MIXED && !singlePrecisionFailed) {
+        vector<float> singleValues(matrixValues.begin(), matrixValues.end());
+        try {
+            singleLu.refactor(singleValues);
+            singlePrecisionFactored = true;
+        } catch (std::domain_error &e) {
+            //singular in single precision (or out of its range), the double factorization decides
+            refinementStatistics.fallbacks++;
+            singlePrecisionFailed = true;
+        }
+    }
+    //only one of the factorizations is kept
+    if (singlePrecisionFactored) lu.release();
+    else {
+        lu.refactor(matrixValues);
+        singleLu.release();
+    }
+    timer.stop();
+    const std::shared_ptr<const SparseLUSymbolic> &symbolic = singlePrecisionFactored ? singleLu.getSymbolic()
+                                                                                      : lu.getSymbolic();
+    //the first factorization of the structure chose the pivots, the next circuits with it reuse them
+    bool pivoted = singlePrecisionFactored ? !singleLu.hasReusedPivots() : !lu.hasReusedPivots();
+    if (pivoted && !t.symbolic->hasPivots) TopologyCache::getInstance().setPivots(t.structureHash, t.pattern, symbolic);
+    statistics.fillIn = symbolic->getFillIn(*t.pattern);
+    factoredResistances = branchResistances;
+    updatedBranches.clear();
+    updateDirections.clear();
+    resistanceChanges.clear();
+}
+
+void CompiledCircuit::setBranchSources(const vector<double> &voltages, const vector<double> &currents) {
+    branchVoltages = voltages;
+    branchCurrentsFromSources = currents;
+}
+
+//Gaussian elimination with partial pivoting of a small dense row-major matrix, false if it is singular
+static bool factorDenseMatrix(vector<double> &a, vector<int> &pivots, int n) {
+    pivots.resize(n);
+    for (int k = 0; k < n; k++) {
+        int pivotRow = k;
+        for (int i = k + 1; i < n; i++)
+            if (fabs(a[i * n + k]) > fabs(a[pivotRow * n + k])) pivotRow = i;
+        pivots[k] = pivotRow;
+        if (fabs(a[pivotRow * n + k]) < EPSILON * EPSILON) return false;
+        if (pivotRow != k)
+            for (int j = 0; j < n; j++)
+                std::swap(a[k * n + j], a[pivotRow * n + j]);
+        for (int i = k + 1; i < n; i++) {
+            a[i * n + k] /= a[k * n + k];
+            for (int j = k + 1; j < n; j++)
+                a[i * n + j] -= a[i * n + k] * a[k * n + j];
+        }
+    }
+    return true;
+}
+
+static void solveDenseMatrix(const vector<double> &a, const vector<int> &pivots, int n, vector<double> &b) {
+    for (int k = 0; k < n; k++)
+        std::swap(b[k], b[pivots[k]]);
+    for (int k = 0; k < n; k++) {
+        for (int i = k + 1; i < n; i++)
+            b[i] -= a[i * n + k] * b[k];
+    }
+    for (int k = n - 1; k >= 0; k--) {
+        for (int j = k + 1; j < n; j++)
+            b[k] -= a[k * n + j] * b[j];
+        b[k] /= a[k * n + k];
+    }
+}
+
+void CompiledCircuit::update(const ComponentValues &values) {
+    const CircuitTopology &t = *topology;
+    if (factoredResistances.empty()) {
+        refactor(values);
+        return;
+    }
+    vector<double> newResistances;
+    t.getBranchValues(values, newResistances, branchVoltages, branchCurrentsFromSources);
+
+    for (int b = 0; b < t.getNumberOfBranches(); b++) {
+        if (newResistances[b] == factoredResistances[b]) continue;
+        if (std::find(updatedBranches.begin(), updatedBranches.end(), b) != updatedBranches.end()) continue;
+        vector<double> direction(t.getNumberOfBranches(), 0.0);
+        bool inALoop = false;
+        for (int p = t.pattern->columnPointers[b]; p < t.pattern->columnPointers[b + 1]; p++) {
+            if (t.entryBranch[p] != b) continue;
+            direction[t.pattern->rowIndices[p]] = t.entrySign[p];
+            inALoop = true;
+        }
+        if (!inALoop) continue;
+        if (updatedBranches.size() == maximumUpdateRank) {
+            refactor(values);
+            return;
+        }
+        solveFactored(direction, false);
+        updatedBranches.push_back(b);
+        updateDirections.push_back(direction);
+    }
+
+    int k = updatedBranches.size();
+    resistanceChanges.resize(k);
+    for (int j = 0; j < k; j++)
+        resistanceChanges[j] = newResistances[updatedBranches[j]] - factoredResistances[updatedBranches[j]];
+    woodburyMatrix.assign(k * k, 0.0);
+    for (int i = 0; i < k; i++) {
+        for (int j = 0; j < k; j++)
+            woodburyMatrix[i * k + j] = updateDirections[j][updatedBranches[i]] * resistanceChanges[j];
+        woodburyMatrix[i * k + i] += 1;
+    }
+    if (!factorDenseMatrix(woodburyMatrix, woodburyPivots, k)) {
+        refactor(values);
+        return;
+    }
+    this->values = values;
+    branchResistances = newResistances;
+}
+
+int CompiledCircuit::getUpdateRank() const {
+    return updatedBranches.size();
+}
+
+int CompiledCircuit::getMaximumUpdateRank() const {
+    return maximumUpdateRank;
+}
+
+void CompiledCircuit::setMaximumUpdateRank(int maximumUpdateRank) {
+    CompiledCircuit::maximumUpdateRank = maximumUpdateRank;
+}
+
+SolverPrecision CompiledCircuit::getPrecision() const {
+    return precision;
+}
+
+//Takes effect with the next refactor
+void CompiledCircuit::setPrecision(SolverPrecision precision) {
+    CompiledCircuit::precision = precision;
+    singlePrecisionFailed = false;
+}
+
+const RefinementStatistics &CompiledCircuit::getRefinementStatistics() const {
+    return refinementStatistics;
+}
+
+const AnalysisStatistics &CompiledCircuit::getAnalysisStatistics() const {
+    return statistics;
+}
+
+//residual = b - A * x (or b - A^T * x), computed in double precision
+//Returns the componentwise backward error max |r_i| / (|A| |x| + |b|)_i, which also covers the tiny currents next
+//to huge ones that a normwise error would hide
+double CompiledCircuit::getRelativeResidual(const vector<double> &b, const vector<double> &x, bool transposed,
+                                            vector<double> &residual) const {
+    const SparsePattern &a = *topology->pattern;
+    residual = b;
+    vector<double> &scale = refinementScale;
+    scale.resize(a.size);
+    for (int i = 0; i < a.size; i++)
+        scale[i] = fabs(b[i]);
+    for (int j = 0; j < a.size; j++)
+        for (int p = a.columnPointers[j]; p < a.columnPointers[j + 1]; p++) {
+            int i = a.rowIndices[p];
+            if (transposed) {
+                residual[j] -= matrixValues[p] * x[i];
+                scale[j] += fabs(matrixValues[p] * x[i]);
+            } else {
+                residual[i] -= matrixValues[p] * x[j];
+                scale[i] += fabs(matrixValues[p] * x[j]);
+            }
+        }
+    double relativeResidual = 0;
+    for (int i = 0; i < a.size; i++) {
+        if (residual[i] == 0) continue;
+        if (scale[i] == 0) return INFINITY;
+        relativeResidual = std::max(relativeResidual, fabs(residual[i]) / scale[i]);
+    }
+    return relativeResidual;
+}
+
+//Solves with whichever factorization is current, in place like SparseLU::solve()
+//Mixed precision: x = LU_float \ b, then x += LU_float \ (b - A * x) until the residual is at double precision
+void CompiledCircuit::solveFactored(vector<double> &b, bool transposed) const {
+    if (!singlePrecisionFactored) {
+        if (transposed) lu.solveTransposed(b);
+        else lu.solve(b);
+        return;
+    }
+    int n = b.size();
+    vector<double> &rightHandSide = refinementRightHandSide;
+    vector<double> &residual = refinementResidual;
+    vector<float> &correction = refinementCorrection;
+    rightHandSide = b;
+    correction.assign(b.begin(), b.end());
+    if (transposed) singleLu.solveTransposed(correction);
+    else singleLu.solve(correction);
+    b.assign(correction.begin(), correction.end());
+    refinementStatistics.solves++;
+
+    double previousResidual = 0;
+    for (int step = 0;; step++) {
+        double relativeResidual = getRelativeResidual(rightHandSide, b, transposed, residual);
+        refinementStatistics.lastResidual = relativeResidual;
+        refinementStatistics.largestResidual = std::max(refinementStatistics.largestResidual, relativeResidual);
+        if (relativeResidual <= REFINEMENT_TOLERANCE) return;
+        if (step == MAXIMUM_REFINEMENT_STEPS || (step > 0 && relativeResidual > 0.5 * previousResidual)) break;
+        previousResidual = relativeResidual;
+        correction.assign(residual.begin(), residual.end());
+        if (transposed) singleLu.solveTransposed(correction);
+        else singleLu.solve(correction);
+        for (int i = 0; i < n; i++)
+            b[i] += correction[i];
+        refinementStatistics.refinementSteps++;
+    }
+
+    //refinement stalled, this matrix needs the double precision factorization, and so will the next values of the
+    //same circuit: their condition hardly changes
+    refinementStatistics.fallbacks++;
+    singlePrecisionFailed = true;
+    lu.refactor(matrixValues);
+    singleLu.release();
+    singlePrecisionFactored = false;
+    b = rightHandSide;
+    if (transposed) lu.solveTransposed(b);
+    else lu.solve(b);
+    refinementStatistics.lastResidual = getRelativeResidual(rightHandSide, b, transposed, residual);
+}
+
+vector<double> CompiledCircuit::solve() const {
+    vector<double> branchCurrents;
+    solve(branchCurrents);
+    return branchCurrents;
+}
+
+void CompiledCircuit::solve(vector<double> &branchCurrents) const {
+    const CircuitTopology &t = *topology;
+    PhaseTimer timer(statistics, AnalysisPhase::SOLUTION);
+    branchCurrents.assign(t.getNumberOfBranches(), 0.0);
+    for (int l = 0; l < t.getNumberOfLoops(); l++) {
+        double sumOfVoltageSourcesInLoop = 0;
+        for (const auto &lb : t.loops[l])
+            sumOfVoltageSourcesInLoop += lb.orientation * branchVoltages[lb.branch];
+        branchCurrents[t.loopRows[l]] = sumOfVoltageSourcesInLoop;
+    }
+    for (int b = 0; b < t.getNumberOfBranches(); b++)
+        if (t.fixedCurrentRows[b] >= 0) branchCurrents[t.fixedCurrentRows[b]] = branchCurrentsFromSources[b];
+    solveRightHandSide(branchCurrents);
+}
+
+//Solves with the factorization and the low-rank update, b is indexed by rows and the result by branches
+void CompiledCircuit::solveRightHandSide(vector<double> &b) const {
+    const CircuitTopology &t = *topology;
+    solveFactored(b, false);
+
+    //x = x0 - Z * D * (I + E^T * Z * D)^-1 * E^T * x0
+    int k = updatedBranches.size();
+    if (k == 0) return;
+    vector<double> correction(k);
+    for (int i = 0; i < k; i++)
+        correction[i] = b[updatedBranches[i]];
+    solveDenseMatrix(woodburyMatrix, woodburyPivots, k, correction);
+    for (int j = 0; j < k; j++) {
+        double scale = resistanceChanges[j] * correction[j];
+        for (int i = 0; i < t.getNumberOfBranches(); i++)
+            b[i] -= updateDirections[j][i] * scale;
+    }
+}
+
+vector<double> CompiledCircuit::getNodeVoltages(const vector<double> &branchCurrents) const {
+    vector<double> nodeVoltages;
+    getNodeVoltages(branchCurrents, nodeVoltages);
+    return nodeVoltages;
+}
+
+void CompiledCircuit::getNodeVoltages(const vector<double> &branchCurrents, vector<double> &nodeVoltages) const {
+    topology->getNodeVoltages(branchResistances, branchVoltages, branchCurrents, nodeVoltages);
+}
+
+//Voltage along a path of the tree (see CircuitTopology::getNodeVoltagePath()), only touches the branches of the path
+double CompiledCircuit::getPathVoltage(const vector<LoopBranch> &path, const vector<double> &branchCurrents) const {
+    double voltage = 0;
+    for (const auto &pb : path) {
+        int b = pb.branch;
+        voltage += pb.orientation * (branchVoltages[b] - branchCurrents[b] * branchResistances[b]);
+    }
+    return voltage;
+}
+
+//Adjoint method: with A * x = r and reading J(x, values), lambda = A^-T * dJ/dx gives
+//dJ/dp = lambda^T * (dr/dp - dA/dp * x) + partial J/partial p for every component p with one transposed solve
+Sensitivities CompiledCircuit::getSensitivities(const vector<double> &branchCurrents,
+                                                const vector<double> &readingGradient,
+                                                const vector<double> &resistanceTerms,
+                                                const vector<double> &voltageTerms) {
+    const CircuitTopology &t = *topology;
+    vector<double> adjoint = readingGradient;
+    solveFactored(adjoint, true);
+
+    //lambda^T times the loop entries of each branch column, both dA/dR and dr/dE of the branch are along them
+    vector<double> loopProjections(t.getNumberOfBranches(), 0.0);
+    for (int b = 0; b < t.getNumberOfBranches(); b++)
+        for (int p = t.pattern->columnPointers[b]; p < t.pattern->columnPointers[b + 1]; p++)
+            if (t.entryBranch[p] == b) loopProjections[b] += t.entrySign[p] * adjoint[t.pattern->rowIndices[p]];
+
+    Sensitivities sensitivities;
+    ComponentValues &gradient = sensitivities.gradient;
+    for (int i = 0; i < t.resistorIds.size(); i++) {
+        int b = t.resistorBranches[i];
+        gradient.resistances.push_back(resistanceTerms[b] - branchCurrents[b] * loopProjections[b]);
+    }
+    for (int i = 0; i < t.voltageSourceIds.size(); i++) {
+        int b = t.voltageSourceBranches[i];
+        gradient.voltages.push_back(t.voltageSourceOrientations[i] * (voltageTerms[b] + loopProjections[b]));
+    }
+    for (int i = 0; i < t.currentSourceIds.size(); i++) {
+        int b = t.currentSourceBranches[i];
+        if (t.branchCurrentSource[b] == i)
+            gradient.currents.push_back(t.currentSourceOrientations[i] * adjoint[t.fixedCurrentRows[b]]);
+        else gradient.currents.push_back(0);
+    }
+    //capacitors and inductors don't change a DC solution
+    gradient.capacitances.assign(t.capacitorIds.size(), 0.0);
+    gradient.inductances.assign(t.inductorIds.size(), 0.0);
+    return sensitivities;
+}
+
+Sensitivities CompiledCircuit::getCurrentSensitivities(int branch) {
+    if (!updatedBranches.empty()) refactor(values);
+    int numberOfBranches = topology->getNumberOfBranches();
+    vector<double> branchCurrents = solve();
+    vector<double> readingGradient(numberOfBranches, 0.0);
+    readingGradient[branch] = 1;
+    vector<double> noTerms(numberOfBranches, 0.0);
+    Sensitivities sensitivities = getSensitivities(branchCurrents, readingGradient, noTerms, noTerms);
+    sensitivities.reading = branchCurrents[branch];
+    return sensitivities;
+}
+
+//V(secondNode) - V(firstNode) = sum of sign * (E - I * R) over the tree path, which also depends on R and E directly
+Sensitivities CompiledCircuit::getVoltageSensitivities(int firstNode, int secondNode) {
+    if (!updatedBranches.empty()) refactor(values);
+    int numberOfBranches = topology->getNumberOfBranches();
+    vector<double> branchCurrents = solve();
+    vector<double> readingGradient(numberOfBranches, 0.0);
+    vector<double> resistanceTerms(numberOfBranches, 0.0);
+    vector<double> voltageTerms(numberOfBranches, 0.0);
+    double reading = 0;
+    for (const auto &pb : topology->getNodeVoltagePath(firstNode, secondNode)) {
+        int b = pb.branch;
+        reading += pb.orientation * (branchVoltages[b] - branchCurrents[b] * branchResistances[b]);
+        readingGradient[b] -= pb.orientation * branchResistances[b];
+        resistanceTerms[b] -= pb.orientation * branchCurrents[b];
+        voltageTerms[b] += pb.orientation;
+    }
+    Sensitivities sensitivities = getSensitivities(branchCurrents, readingGradient, resistanceTerms, voltageTerms);
+    sensitivities.reading = reading;
+    return sensitivities;
+}
+
+double TheveninEquivalent::getNortonCurrent() const {
+    if (resistance == 0) throw std::domain_error("Norton equivalent of an ideal voltage source doesn't exist!");
+    return voltage / resistance;
+}
+
+//Open-circuit voltage from the given solution. Resistance: with every source set to zero, a unit current injected
+//into firstNode and taken out of secondNode only changes two node rows of the right hand side, so it costs one
+//more solve with the existing factorization, and the voltage it makes between the nodes is the resistance.
+TheveninEquivalent CompiledCircuit::getTheveninEquivalent(int firstNode, int secondNode,
+                                                          const vector<double> &branchCurrents) const {
+    const CircuitTopology &t = *topology;
+    if (t.getTreeRoot(firstNode) != t.getTreeRoot(secondNode))
+        throw std::domain_error("Nodes aren't connected through branches without current sources!");
+    TheveninEquivalent equivalent;
+    if (firstNode == secondNode) return equivalent;
+
+    vector<double> injectedCurrents(t.getNumberOfBranches(), 0.0);
+    if (t.nodeRows[firstNode] >= 0) injectedCurrents[t.nodeRows[firstNode]] -= 1;
+    if (t.nodeRows[secondNode] >= 0) injectedCurrents[t.nodeRows[secondNode]] += 1;
+    solveRightHandSide(injectedCurrents);
+
+    for (const auto &pb : t.getNodeVoltagePath(secondNode, firstNode)) {
+        int b = pb.branch;
+        equivalent.voltage += pb.orientation * (branchVoltages[b] - branchCurrents[b] * branchResistances[b]);
+        equivalent.resistance -= pb.orientation * injectedCurrents[b] * branchResistances[b];
+    }
+    return equivalent;
+}
+
+TheveninEquivalent CompiledCircuit::getTheveninEquivalent(int firstNode, int secondNode) const {
+    return getTheveninEquivalent(firstNode, secondNode, solve());
+}
+
+//All ports share one solve for the open-circuit voltages, then each costs one solve for its resistance
+vector<TheveninEquivalent> CompiledCircuit::getTheveninEquivalents(const vector<std::pair<int, int>> &ports) const {
+    vector<double> branchCurrents = solve();
+    vector<TheveninEquivalent> equivalents;
+    for (const auto &port : ports)
+        equivalents.push_back(getTheveninEquivalent(port.first, port.second, branchCurrents));
+    return equivalents;
+}
@@ -0,0 +1,328 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_COMPILEDCIRCUIT_H
+#define CIRCUITANALYZER_COMPILEDCIRCUIT_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "Circuit.h"
+#include "SparseLU.h"
+#include "AnalysisStatistics.h"
+
+using std::vector;
+
+enum class ComponentType {
+    RESISTOR, VOLTAGE_SOURCE, CURRENT_SOURCE, CAPACITOR, INDUCTOR
+};
+
+//Values of all components of a compiled circuit, one array per component type (SoA)
+//Order of the elements is given by the id vectors of the topology (resistorIds, voltageSourceIds...)
+
+class ComponentValues {
+public:
+    vector<double> resistances;
+    vector<double> voltages;
+    vector<double> currents;
+    vector<double> capacitances;
+    vector<double> inductances;
+
+    vector<double> &getValues(ComponentType type) {
+        if (type == ComponentType::RESISTOR) return resistances;
+        if (type == ComponentType::VOLTAGE_SOURCE) return voltages;
+        if (type == ComponentType::CAPACITOR) return capacitances;
+        if (type == ComponentType::INDUCTOR) return inductances;
+        return currents;
+    }
+
+    const vector<double> &getValues(ComponentType type) const {
+        return const_cast<ComponentValues *>(this)->getValues(type);
+    }
+};
+
+//One branch of a loop, orientation is 1 if the loop goes through the branch from its first to its second node
+
+class LoopBranch {
+public:
+    int branch;
+    int orientation;
+};
+
+//DOUBLE factors and solves in double precision. MIXED factors in single precision and refines every solve with
+//residuals in double precision until it reaches double accuracy.
+//MIXED trades accuracy of the factors for memory, it isn't a speed-up: the factors take half the memory (the double
+//ones are released), but every refinement step is another solve and a residual, so a MIXED solve costs three to five
+//double ones on grids of 100 to 10000 branches. The loop equations of larger grids are too badly conditioned for
+//single precision, refinement stalls and the circuit falls back to DOUBLE until setPrecision().
+
+enum class SolverPrecision {
+    DOUBLE, MIXED
+};
+
+//Counters of the iterative refinement of a MIXED compiled circuit, residuals are componentwise backward errors
+//max |b - Ax|_i / (|A| |x| + |b|)_i
+
+class RefinementStatistics {
+public:
+    long solves = 0;
+    long refinementSteps = 0;
+    long fallbacks = 0;
+    double lastResidual = 0;
+    double largestResidual = 0;
+};
+
+//Derivatives of one reading (current or voltage) with respect to the value of every component
+//gradient is in the same order as ComponentValues
+
+class Sensitivities {
+public:
+    double reading = 0;
+    ComponentValues gradient;
+};
+
+//Equivalent of a circuit seen from two nodes: a voltage source V(first) - V(second) in series with a resistance,
+//or (Norton) a current source of voltage / resistance in parallel with the same resistance
+
+class TheveninEquivalent {
+public:
+    double voltage = 0;
+    double resistance = 0;
+
+    double getNortonCurrent() const;
+};
+
+//Everything about a circuit that depends only on its structure: nodes, spanning tree, loops, mapping of the components
+//to branches and the pattern of the branch current equations. It never changes after construction and is shared
+//between every CompiledCircuit made from it.
+//
+//Equations are in the same order as in measureCurrentsOfACircuit(): loops (Second Kirchoff's Law), then branches with
+//current sources or infinite resistance, then nodes (First Kirchoff's Law) without the root of each tree component.
+//Unknowns are the branch currents, in the order of the branches of the circuit.
+//
+//In a DC topology branches with capacitors are open and inductors are ignored. In a dynamic topology (transient,
+//AC) they are regular branches, and the analysis gives them their companion or complex values through the branches.
+//Nonlinear elements are left out of the branch values, NonlinearSolver linearizes them the same way.
+//The tree, loops, pattern and symbolic factorization are taken from TopologyCache when a circuit with the same
+//structure was compiled before, with the row pivots of the first factorization once a CompiledCircuit made one.
+
+class TopologyStructure;
+
+class MappedCircuit;
+
+class CircuitTopology {
+    friend class MappedCircuit;
+
+public:
+    vector<int> branchIds;
+    vector<int> firstNodes;              //node indices of each branch
+    vector<int> secondNodes;
+    vector<double> fixedResistances;     //resistance of parasite resistors (id -1) in each branch
+    vector<bool> currentFixed;           //branch has a current source, an infinite resistance or is open in DC
+    bool dynamic;
+
+    vector<int> nodeIds;                 //sorted ids of all nodes
+    vector<int> treeParentBranch;        //for each node, the tree branch towards the root (-1 for roots)
+    vector<int> treeParentNode;
+    vector<int> treeDepth;
+    vector<int> treeOrder;               //nodes ordered so that every node comes after its tree parent
+    vector<int> treeBranches;
+    vector<vector<LoopBranch>> loops;
+
+    vector<int> resistorIds;
+    vector<int> resistorBranches;
+    vector<int> voltageSourceIds;
+    vector<int> voltageSourceBranches;
+    vector<int> voltageSourceOrientations;
+    vector<int> currentSourceIds;
+    vector<int> currentSourceBranches;
+    vector<int> currentSourceOrientations;
+    vector<int> branchCurrentSource;     //index of the current source that sets the current of a branch, -1 if none
+    vector<int> capacitorIds;
+    vector<int> capacitorBranches;
+    vector<int> inductorIds;
+    vector<int> inductorBranches;
+    vector<int> nonlinearIds;
+    vector<int> nonlinearBranches;
+
+    std::shared_ptr<const SparsePattern> pattern;
+    vector<int> entryBranch;             //branch whose resistance the entry depends on, -1 for constant entries
+    vector<double> entrySign;
+    vector<int> loopRows;                //row of each loop
+    vector<int> fixedCurrentRows;        //row of each branch with fixed current, -1 for the others
+    vector<int> nodeRows;                //row of each node, -1 for the roots of the tree
+    std::shared_ptr<const SparseLUSymbolic> symbolic;
+    //only the phases of the topology, a whole AnalysisStatistics would push it past the sizes malloc caches per thread
+    PhaseStatistics phases[NUMBER_OF_TOPOLOGY_PHASES];
+    bool cachedStructure = false;        //tree, loops and pattern came from TopologyCache
+    uint64_t structureHash = 0;          //of the structure in TopologyCache
+
+    explicit CircuitTopology(Circuit &circuit, bool dynamic = false);
+
+    int getNumberOfBranches() const;
+
+    int getNumberOfNodes() const;
+
+    int getNumberOfLoops() const;
+
+    //Counters and the phases spent on this topology
+    AnalysisStatistics getStatistics() const;
+
+    int getNodeIndex(int nodeId) const;
+
+    int getBranchIndex(int branchId) const;
+
+    int getResistorIndex(int resistorId) const;
+
+    int getVoltageSourceIndex(int voltageSourceId) const;
+
+    int getCurrentSourceIndex(int currentSourceId) const;
+
+    int getComponentIndex(ComponentType type, int componentId) const;
+
+    ComponentValues getValuesOf(Circuit &circuit) const;
+
+    void getBranchValues(const ComponentValues &values, vector<double> &resistances, vector<double> &voltages,
+                         vector<double> &currents) const;
+
+    void getBranchReactiveValues(const ComponentValues &values, vector<double> &capacitances,
+                                 vector<double> &inductances) const;
+
+    int getTreeRoot(int node) const;
+
+    vector<LoopBranch> getNodeVoltagePath(int firstNode, int secondNode) const;
+
+    vector<double> getNodeVoltages(const ComponentValues &values, const vector<double> &branchCurrents) const;
+
+    void getNodeVoltages(const vector<double> &branchResistances, const vector<double> &branchVoltages,
+                         const vector<double> &branchCurrents, vector<double> &nodeVoltages) const;
+
+private:
+    explicit CircuitTopology(bool dynamic);
+
+    void analyse(PhaseTimer &timer);
+
+    void setStructure(const TopologyStructure &structure);
+
+    std::shared_ptr<const TopologyStructure> getStructure(vector<uint64_t> key, uint64_t hash) const;
+
+    void buildTree();
+
+    void buildLoops();
+
+    void buildPattern();
+};
+
+//A circuit whose topology has been analysed once, ready to be solved for many sets of component values.
+//refactor() only redoes the numeric factorization, solve() only does the triangular solves.
+//update() keeps the factorization and corrects the solution for changed resistances with a low-rank
+//(Sherman-Morrison-Woodbury) update: a resistance only scales the loop entries of its own branch column.
+//Changed sources only change the right hand side. Once more than maximumUpdateRank branches differ
+//from the factorization, update() refactors instead.
+//With MIXED precision a solve whose refinement stalls (a matrix too badly conditioned for single precision)
+//factors the same matrix in double and keeps factoring in double until the precision is set again.
+
+class CompiledCircuit {
+    std::shared_ptr<const CircuitTopology> topology;
+    mutable SparseLU<double> lu;
+    mutable SparseLU<float> singleLu;
+    SolverPrecision precision = SolverPrecision::DOUBLE;
+    mutable bool singlePrecisionFactored = false;
+    mutable bool singlePrecisionFailed = false;       //a MIXED factorization fell back, stay in double
+    mutable RefinementStatistics refinementStatistics;
+    mutable vector<double> refinementRightHandSide;   //buffers of solveFactored(), kept between solves
+    mutable vector<double> refinementResidual;
+    mutable vector<double> refinementScale;
+    mutable vector<float> refinementCorrection;
+    mutable AnalysisStatistics statistics;
+    ComponentValues values;
+    vector<double> branchResistances;
+    vector<double> branchVoltages;
+    vector<double> branchCurrentsFromSources;
+    vector<double> matrixValues;
+
+    vector<double> factoredResistances;
+    vector<int> updatedBranches;
+    vector<vector<double>> updateDirections;      //A^-1 times the loop entries of each updated branch
+    vector<double> resistanceChanges;
+    vector<double> woodburyMatrix;                //LU of I + E^T * A^-1 * S * D, k x k
+    vector<int> woodburyPivots;
+    int maximumUpdateRank = 32;
+
+    static const int MAXIMUM_REFINEMENT_STEPS = 10;
+    static constexpr double REFINEMENT_TOLERANCE = 1e-14;
+
+public:
+    explicit CompiledCircuit(Circuit &circuit);
+
+    explicit CompiledCircuit(std::shared_ptr<const CircuitTopology> topology);
+
+    const std::shared_ptr<const CircuitTopology> &getTopology() const;
+
+    const ComponentValues &getValues() const;
+
+    const SparseLU<double> &getFactorization() const;
+
+    void refactor(const ComponentValues &values);
+
+    void refactorBranches(const vector<double> &resistances);
+
+    void setBranchSources(const vector<double> &voltages, const vector<double> &currents);
+
+    void update(const ComponentValues &values);
+
+    int getUpdateRank() const;
+
+    int getMaximumUpdateRank() const;
+
+    void setMaximumUpdateRank(int maximumUpdateRank);
+
+    SolverPrecision getPrecision() const;
+
+    void setPrecision(SolverPrecision precision);
+
+    const RefinementStatistics &getRefinementStatistics() const;
+
+    //Statistics of the topology it was made from plus the time of every refactor and solve since
+    const AnalysisStatistics &getAnalysisStatistics() const;
+
+    vector<double> solve() const;
+
+    void solve(vector<double> &branchCurrents) const;
+
+    vector<double> getNodeVoltages(const vector<double> &branchCurrents) const;
+
+    void getNodeVoltages(const vector<double> &branchCurrents, vector<double> &nodeVoltages) const;
+
+    double getPathVoltage(const vector<LoopBranch> &path, const vector<double> &branchCurrents) const;
+
+    TheveninEquivalent getTheveninEquivalent(int firstNode, int secondNode) const;
+
+    vector<TheveninEquivalent> getTheveninEquivalents(const vector<std::pair<int, int>> &ports) const;
+
+    Sensitivities getCurrentSensitivities(int branch);
+
+    Sensitivities getVoltageSensitivities(int firstNode, int secondNode);
+
+private:
+    void refactor(const ComponentValues &values, PhaseTimer &timer);
+
+    void refactorBranches(const vector<double> &resistances, PhaseTimer &timer);
+
+    void solveRightHandSide(vector<double> &b) const;
+
+    TheveninEquivalent getTheveninEquivalent(int firstNode, int secondNode,
+                                             const vector<double> &branchCurrents) const;
+
+    void solveFactored(vector<double> &b, bool transposed) const;
+
+    double getRelativeResidual(const vector<double> &b, const vector<double> &x, bool transposed,
+                               vector<double> &residual) const;
+
+    Sensitivities getSensitivities(const vector<double> &branchCurrents, const vector<double> &readingGradient,
+                                   const vector<double> &resistanceTerms, const vector<double> &voltageTerms);
+};
+
+
+#endif //CIRCUITANALYZER_COMPILEDCIRCUIT_H
@@ -0,0 +1,41 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <chrono>
+#include <iostream>
+#include "CircuitFingerprint.h"
+#include "CircuitGenerator.h"
+
+//Fingerprints of ladders take linear time: 30000 branches in well under a second (a refinement round per node took
+//4 s at 10000 branches), and a circuit with its nodes renumbered gets the same fingerprint
+int main() {
+    int failures = 0;
+    for (int numberOfBranches : {10000, 30000}) {
+        GeneratorOptions options;
+        options.family = CircuitFamily::LADDER;
+        options.numberOfBranches = numberOfBranches;
+        options.numberOfVoltageSources = 1 + numberOfBranches / 1000;
+        options.numberOfCurrentSources = numberOfBranches / 1000;
+        CircuitArrays arrays = CircuitGenerator(options).generate();
+        Circuit circuit = toCircuit(arrays);
+        auto start = std::chrono::steady_clock::now();
+        CircuitFingerprint fingerprint(circuit);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        //node ids in the opposite order
+        int largestId = 0;
+        for (auto id : arrays.nodeIds)
+            largestId = std::max(largestId, (int) id);
+        for (auto &id : arrays.nodeIds)
+            id = largestId - id;
+        Circuit renumbered = toCircuit(arrays);
+        bool equal = CircuitFingerprint(renumbered) == fingerprint;
+
+        bool passed = seconds < 1 && equal;
+        std::cout << (passed ? "ok   " : "FAIL ") << numberOfBranches << " branch ladder: " << seconds << " s, "
+                  << (equal ? "renumbered equal" : "renumbered different") << "\n";
+        if (!passed) failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <fstream>
+#include <stdexcept>
+#include "MappedFile.h"
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#endif
+
+MappedFile::MappedFile(const std::string &path) {
+#ifndef _WIN32
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) throw std::runtime_error("Can't open " + path + "!");
+    struct stat status;
+    if (fstat(descriptor, &status) != 0) {
+        close(descriptor);
+        throw std::runtime_error("Can't read " + path + "!");
+    }
+    size = status.st_size;
+    if (size > 0) {
+        void *address = mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+        if (address != MAP_FAILED) {
+            madvise(address, size, MADV_SEQUENTIAL);
+            data = static_cast<const char *>(address);
+            mapped = true;
+        }
+    }
+    close(descriptor);
+    if (mapped || size == 0) return;
+#endif
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) throw std::runtime_error("Can't open " + path + "!");
+    contents.resize((size_t) file.tellg());
+    file.seekg(0);
+    if (!file.read(contents.data(), contents.size())) throw std::runtime_error("Can't read " + path + "!");
+    data = contents.data();
+    size = contents.size();
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (mapped) munmap(const_cast<char *>(data), size);
+#endif
+}
+
+const char *MappedFile::getData() const {
+    return data;
+}
+
+size_t MappedFile::getSize() const {
+    return size;
+}
+
+bool MappedFile::isMapped() const {
+    return mapped;
+}
@@ -0,0 +1,38 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_MAPPEDFILE_H
+#define CIRCUITANALYZER_MAPPEDFILE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+//Read-only view of a whole file, memory mapped (shared with other processes mapping the same file)
+//Where mmap isn't available the file is read into memory instead
+
+class MappedFile {
+    const char *data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+    std::vector<char> contents;
+
+public:
+    explicit MappedFile(const std::string &path);
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile();
+
+    const char *getData() const;
+
+    size_t getSize() const;
+
+    bool isMapped() const;
+};
+
+
+#endif //CIRCUITANALYZER_MAPPEDFILE_H
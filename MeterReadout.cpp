@@ -0,0 +1,83 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include "MeterReadout.h"
+
+MeterReadout::MeterReadout(const Circuit &circuit, std::shared_ptr<const CircuitTopology> topology) :
+        topology(topology) {
+    const CircuitTopology &t = *topology;
+    for (const auto &v : circuit.getVoltmeters()) {
+        MeterHandle handle;
+        handle.type = MeterType::VOLTMETER;
+        handle.meterId = v.getVoltmeter().getId();
+        handle.sign = v.getVoltmeter().isNaturalOrientation() ? 1 : -1;
+        int firstNode = t.getNodeIndex(v.getFirstNode().getId());
+        int secondNode = t.getNodeIndex(v.getSecondNode().getId());
+        if (firstNode < 0 || secondNode < 0) throw std::logic_error("Voltmeter is not in the circuit!");
+        if (t.getTreeRoot(firstNode) != t.getTreeRoot(secondNode))
+            throw std::domain_error("Voltmeter nodes aren't connected through branches without current sources!");
+        handle.path = t.getNodeVoltagePath(firstNode, secondNode);
+        handles.push_back(handle);
+    }
+    numberOfVoltmeters = handles.size();
+    for (const auto &a : circuit.getAmpermeters()) {
+        MeterHandle handle;
+        handle.meterId = a.getAmpermeter().getId();
+        handle.sign = a.getAmpermeter().isNaturalOrientation() ? 1 : -1;
+        handle.branch = t.getBranchIndex(a.getAmpermeterBranch().getId());
+        if (handle.branch < 0) throw std::logic_error("Ampermeter is not in the circuit!");
+        handles.push_back(handle);
+    }
+    numberOfAmpermeters = handles.size() - numberOfVoltmeters;
+    for (const auto &w : circuit.getWattmeters()) {
+        MeterHandle handle;
+        handle.type = MeterType::WATTMETER;
+        handle.meterId = w.getId();
+        handle.branch = t.getBranchIndex(w.getBranchId());
+        if (handle.branch < 0) throw std::logic_error("Wattmeter is not in the circuit!");
+        int firstNode = t.firstNodes[handle.branch];
+        int secondNode = t.secondNodes[handle.branch];
+        if (t.getTreeRoot(firstNode) != t.getTreeRoot(secondNode))
+            throw std::domain_error("Voltage of the wattmeter branch isn't defined!");
+        handle.path = t.getNodeVoltagePath(firstNode, secondNode);
+        handles.push_back(handle);
+    }
+}
+
+int MeterReadout::getNumberOfMeters() const {
+    return handles.size();
+}
+
+int MeterReadout::getNumberOfVoltmeters() const {
+    return numberOfVoltmeters;
+}
+
+int MeterReadout::getNumberOfAmpermeters() const {
+    return numberOfAmpermeters;
+}
+
+int MeterReadout::getNumberOfWattmeters() const {
+    return handles.size() - numberOfVoltmeters - numberOfAmpermeters;
+}
+
+const MeterHandle &MeterReadout::getHandle(int meter) const {
+    return handles.at(meter);
+}
+
+double MeterReadout::read(int meter, const CompiledCircuit &compiledCircuit,
+                          const vector<double> &branchCurrents) const {
+    const MeterHandle &handle = handles.at(meter);
+    if (handle.type == MeterType::VOLTMETER)
+        return handle.sign * compiledCircuit.getPathVoltage(handle.path, branchCurrents);
+    if (handle.type == MeterType::WATTMETER)
+        return -compiledCircuit.getPathVoltage(handle.path, branchCurrents) * branchCurrents[handle.branch];
+    return handle.sign * branchCurrents[handle.branch];
+}
+
+void MeterReadout::readAll(const CompiledCircuit &compiledCircuit, const vector<double> &branchCurrents,
+                           vector<double> &readings) const {
+    readings.resize(handles.size());
+    for (int m = 0; m < handles.size(); m++)
+        readings[m] = read(m, compiledCircuit, branchCurrents);
+}
@@ -0,0 +1,62 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_METERREADOUT_H
+#define CIRCUITANALYZER_METERREADOUT_H
+
+#include <vector>
+#include "CompiledCircuit.h"
+
+using std::vector;
+
+enum class MeterType {
+    VOLTMETER, AMPERMETER, WATTMETER
+};
+
+//A meter resolved against a topology
+//Ampermeter: the current of its branch. Voltmeter: V(second) - V(first) along the tree path between its nodes.
+//Wattmeter: -(V(second) - V(first)) * I of its branch, with the path between the nodes of the branch.
+//sign is -1 for meters that aren't in natural orientation.
+
+class MeterHandle {
+public:
+    MeterType type = MeterType::AMPERMETER;
+    int meterId = 0;
+    int sign = 1;
+    int branch = -1;
+    vector<LoopBranch> path;
+};
+
+//Readings of the meters of a circuit, computed from a solution only when they are asked for
+//Meters are resolved to branch indices and node paths once, so a reading costs only the branches it touches
+//instead of every branch current and node voltage. Voltmeters come first, then ampermeters and wattmeters, each in
+//the order in which they were added to the circuit.
+
+class MeterReadout {
+    std::shared_ptr<const CircuitTopology> topology;
+    vector<MeterHandle> handles;
+    int numberOfVoltmeters = 0;
+    int numberOfAmpermeters = 0;
+
+public:
+    MeterReadout(const Circuit &circuit, std::shared_ptr<const CircuitTopology> topology);
+
+    int getNumberOfMeters() const;
+
+    int getNumberOfVoltmeters() const;
+
+    int getNumberOfAmpermeters() const;
+
+    int getNumberOfWattmeters() const;
+
+    const MeterHandle &getHandle(int meter) const;
+
+    double read(int meter, const CompiledCircuit &compiledCircuit, const vector<double> &branchCurrents) const;
+
+    void readAll(const CompiledCircuit &compiledCircuit, const vector<double> &branchCurrents,
+                 vector<double> &readings) const;
+};
+
+
+#endif //CIRCUITANALYZER_METERREADOUT_H
@@ -0,0 +1,272 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include "MonteCarlo.h"
+#include "ThreadPool.h"
+
+ComponentDistribution::ComponentDistribution(ComponentType type, int componentId, DistributionType distribution,
+                                             double tolerance) :
+        type(type), componentId(componentId), distribution(distribution), tolerance(tolerance) {
+    if (tolerance < 0) throw std::domain_error("Tolerance can't be negative!");
+}
+
+ComponentDistribution ComponentDistribution::uniform(ComponentType type, int componentId, double tolerance) {
+    return ComponentDistribution(type, componentId, DistributionType::UNIFORM, tolerance);
+}
+
+ComponentDistribution ComponentDistribution::normal(ComponentType type, int componentId, double sigma) {
+    return ComponentDistribution(type, componentId, DistributionType::NORMAL, sigma);
+}
+
+ComponentType ComponentDistribution::getType() const {
+    return type;
+}
+
+int ComponentDistribution::getComponentId() const {
+    return componentId;
+}
+
+double ComponentDistribution::sample(double nominal, std::mt19937_64 &generator) const {
+    bool positive = nominal > 0 && type != ComponentType::VOLTAGE_SOURCE && type != ComponentType::CURRENT_SOURCE;
+    double value;
+    do {
+        if (distribution == DistributionType::UNIFORM)
+            value = nominal * (1 + std::uniform_real_distribution<double>(-tolerance, tolerance)(generator));
+        else value = nominal * (1 + std::normal_distribution<double>(0, tolerance)(generator));
+    } while (positive && value <= 0);
+    return value;
+}
+
+RunningStatistics::RunningStatistics(double histogramLower, double histogramUpper, int numberOfBins) :
+        histogramLower(histogramLower), histogramUpper(histogramUpper), histogram(numberOfBins, 0) {}
+
+void RunningStatistics::add(double value) {
+    numberOfSamples++;
+    double delta = value - mean;
+    mean += delta / numberOfSamples;
+    sumOfSquaredDeviations += delta * (value - mean);
+    if (numberOfSamples == 1 || value < minimum) minimum = value;
+    if (numberOfSamples == 1 || value > maximum) maximum = value;
+
+    if (histogram.empty()) return;
+    if (value < histogramLower) underflow++;
+    else if (value >= histogramUpper) overflow++;
+    else histogram[(int) ((value - histogramLower) / (histogramUpper - histogramLower) * histogram.size())]++;
+}
+
+//Chan's formula for combining the statistics of two sets of samples
+void RunningStatistics::merge(const RunningStatistics &other) {
+    if (other.numberOfSamples == 0) return;
+    if (numberOfSamples == 0) {
+        *this = other;
+        return;
+    }
+    long total = numberOfSamples + other.numberOfSamples;
+    double delta = other.mean - mean;
+    mean += delta * other.numberOfSamples / total;
+    sumOfSquaredDeviations += other.sumOfSquaredDeviations +
+                              delta * delta * ((double) numberOfSamples * other.numberOfSamples / total);
+    numberOfSamples = total;
+    minimum = std::min(minimum, other.minimum);
+    maximum = std::max(maximum, other.maximum);
+    for (int i = 0; i < histogram.size() && i < other.histogram.size(); i++)
+        histogram[i] += other.histogram[i];
+    underflow += other.underflow;
+    overflow += other.overflow;
+}
+
+long RunningStatistics::getNumberOfSamples() const {
+    return numberOfSamples;
+}
+
+double RunningStatistics::getMean() const {
+    return mean;
+}
+
+double RunningStatistics::getVariance() const {
+    return numberOfSamples < 2 ? 0 : sumOfSquaredDeviations / (numberOfSamples - 1);
+}
+
+double RunningStatistics::getStandardDeviation() const {
+    return sqrt(getVariance());
+}
+
+double RunningStatistics::getMinimum() const {
+    return minimum;
+}
+
+double RunningStatistics::getMaximum() const {
+    return maximum;
+}
+
+double RunningStatistics::getHistogramLower() const {
+    return histogramLower;
+}
+
+double RunningStatistics::getHistogramUpper() const {
+    return histogramUpper;
+}
+
+const vector<long> &RunningStatistics::getHistogram() const {
+    return histogram;
+}
+
+long RunningStatistics::getUnderflow() const {
+    return underflow;
+}
+
+long RunningStatistics::getOverflow() const {
+    return overflow;
+}
+
+double MonteCarloResults::getYield() const {
+    return numberOfSamples == 0 ? 0 : (double) numberOfPassingSamples / numberOfSamples;
+}
+
+const int MonteCarlo::SAMPLES_PER_CHUNK;
+const int MonteCarlo::PILOT_CHUNKS;
+
+MonteCarlo::MonteCarlo(Circuit &circuit, int numberOfThreads) :
+        compiledCircuit(circuit), numberOfThreads(numberOfThreads) {}
+
+MonteCarlo::MonteCarlo(const CompiledCircuit &compiledCircuit, int numberOfThreads) :
+        compiledCircuit(compiledCircuit), numberOfThreads(numberOfThreads) {}
+
+void MonteCarlo::addDistribution(const ComponentDistribution &distribution) {
+    int index = compiledCircuit.getTopology()->getComponentIndex(distribution.getType(),
+                                                                 distribution.getComponentId());
+    if (index < 0) throw std::domain_error("Component with tolerance is not in the circuit!");
+    distributions.push_back(distribution);
+    distributionIndices.push_back(index);
+}
+
+void MonteCarlo::addBranchCurrentLimits(int branchId, double lowerLimit, double upperLimit) {
+    int index = compiledCircuit.getTopology()->getBranchIndex(branchId);
+    if (index < 0) throw std::domain_error("Branch is not in the circuit!");
+    limitedBranches.push_back(index);
+    lowerLimits.push_back(lowerLimit);
+    upperLimits.push_back(upperLimit);
+}
+
+void MonteCarlo::setSeed(unsigned long seed) {
+    MonteCarlo::seed = seed;
+}
+
+void MonteCarlo::setNumberOfBins(int numberOfBins) {
+    if (numberOfBins < 1) throw std::domain_error("Histogram needs at least one bin!");
+    MonteCarlo::numberOfBins = numberOfBins;
+}
+
+void MonteCarlo::solveSample(CompiledCircuit &worker, ComponentValues &values, std::mt19937_64 &generator,
+                             vector<double> &currents, vector<double> &voltages) const {
+    const ComponentValues &nominal = compiledCircuit.getValues();
+    for (int d = 0; d < distributions.size(); d++) {
+        ComponentType type = distributions[d].getType();
+        int index = distributionIndices[d];
+        values.getValues(type)[index] = distributions[d].sample(nominal.getValues(type)[index], generator);
+    }
+    worker.refactor(values);
+    worker.solve(currents);
+    worker.getNodeVoltages(currents, voltages);
+}
+
+bool MonteCarlo::isWithinLimits(const vector<double> &currents) const {
+    for (int l = 0; l < limitedBranches.size(); l++) {
+        double current = currents[limitedBranches[l]];
+        if (current < lowerLimits[l] || current > upperLimits[l]) return false;
+    }
+    return true;
+}
+
+MonteCarloResults MonteCarlo::run(long numberOfSamples) const {
+    const CircuitTopology &topology = *compiledCircuit.getTopology();
+    int numberOfBranches = topology.getNumberOfBranches();
+    int numberOfNodes = topology.getNumberOfNodes();
+    int numberOfChunks = (numberOfSamples + SAMPLES_PER_CHUNK - 1) / SAMPLES_PER_CHUNK;
+    int pilotChunks = std::min(numberOfChunks, PILOT_CHUNKS);
+    int threads = std::max(1, std::min(getNumberOfThreads(numberOfThreads), numberOfChunks));
+
+    vector<CompiledCircuit> workers(threads, compiledCircuit);
+    vector<ComponentValues> workerValues(threads, compiledCircuit.getValues());
+    vector<vector<double>> workerCurrents(threads);
+    vector<vector<double>> workerVoltages(threads);
+
+    auto forEachSampleOfChunk = [&](int thread, int chunk, const std::function<void(long, const vector<double> &,
+                                                                                    const vector<double> &)> &use) {
+        std::seed_seq sequence{(unsigned long) seed, (unsigned long) chunk};
+        std::mt19937_64 generator(sequence);
+        long end = std::min(numberOfSamples, (long) (chunk + 1) * SAMPLES_PER_CHUNK);
+        for (long sample = (long) chunk * SAMPLES_PER_CHUNK; sample < end; sample++) {
+            solveSample(workers[thread], workerValues[thread], generator, workerCurrents[thread],
+                        workerVoltages[thread]);
+            use(sample, workerCurrents[thread], workerVoltages[thread]);
+        }
+    };
+
+    //pilot run, only to find the histogram ranges: extremes of every value, every thread keeps its own
+    int numberOfValues = numberOfBranches + numberOfNodes;
+    vector<vector<double>> workerLower(threads, vector<double>(numberOfValues));
+    vector<vector<double>> workerUpper(threads, vector<double>(numberOfValues));
+    vector<char> workerSampled(threads, false);
+    parallelFor(pilotChunks, threads, [&](int thread, int chunk) -> void {
+        vector<double> &lower = workerLower[thread], &upper = workerUpper[thread];
+        forEachSampleOfChunk(thread, chunk, [&](long, const vector<double> &currents,
+                                                const vector<double> &voltages) {
+            bool first = !workerSampled[thread];
+            workerSampled[thread] = true;
+            for (int v = 0; v < numberOfValues; v++) {
+                double value = v < numberOfBranches ? currents[v] : voltages[v - numberOfBranches];
+                if (first || value < lower[v]) lower[v] = value;
+                if (first || value > upper[v]) upper[v] = value;
+            }
+        });
+    });
+
+    vector<RunningStatistics> initialStatistics;
+    for (int v = 0; v < numberOfValues; v++) {
+        double lower = 0, upper = 0;
+        bool first = true;
+        for (int t = 0; t < threads; t++) {
+            if (!workerSampled[t]) continue;
+            if (first || workerLower[t][v] < lower) lower = workerLower[t][v];
+            if (first || workerUpper[t][v] > upper) upper = workerUpper[t][v];
+            first = false;
+        }
+        double margin = std::max((upper - lower) * 0.25, std::max(fabs(upper), fabs(lower)) * 1e-9 + 1e-15);
+        initialStatistics.emplace_back(lower - margin, upper + margin, numberOfBins);
+    }
+    workerLower.clear();
+    workerUpper.clear();
+
+    //every chunk, the pilot ones again: their random streams give the same samples
+    vector<vector<RunningStatistics>> workerStatistics(threads, initialStatistics);
+    vector<long> workerPassing(threads, 0);
+    parallelFor(numberOfChunks, threads, [&](int thread, int chunk) -> void {
+        vector<RunningStatistics> &statistics = workerStatistics[thread];
+        forEachSampleOfChunk(thread, chunk, [&](long, const vector<double> &currents,
+                                                const vector<double> &voltages) {
+            for (int b = 0; b < numberOfBranches; b++)
+                statistics[b].add(currents[b]);
+            for (int n = 0; n < numberOfNodes; n++)
+                statistics[numberOfBranches + n].add(voltages[n]);
+            if (isWithinLimits(currents)) workerPassing[thread]++;
+        });
+    });
+
+    MonteCarloResults results;
+    results.numberOfSamples = numberOfSamples;
+    results.branchIds = topology.branchIds;
+    results.nodeIds = topology.nodeIds;
+    for (int t = 1; t < threads; t++)
+        for (int v = 0; v < numberOfValues; v++)
+            workerStatistics[0][v].merge(workerStatistics[t][v]);
+    for (int t = 0; t < threads; t++)
+        results.numberOfPassingSamples += workerPassing[t];
+    results.branchCurrents.assign(workerStatistics[0].begin(), workerStatistics[0].begin() + numberOfBranches);
+    results.nodeVoltages.assign(workerStatistics[0].begin() + numberOfBranches, workerStatistics[0].end());
+    return results;
+}
@@ -0,0 +1,143 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_MONTECARLO_H
+#define CIRCUITANALYZER_MONTECARLO_H
+
+#include <vector>
+#include <random>
+#include "CompiledCircuit.h"
+
+using std::vector;
+
+enum class DistributionType {
+    UNIFORM, NORMAL
+};
+
+//Tolerance of one component, relative to its nominal value
+//Uniform: value = nominal * (1 + u), u in [-tolerance, tolerance]
+//Normal: value = nominal * (1 + n), n with standard deviation of tolerance
+//Values of resistors, capacitors and inductors are drawn again until they are positive, sources can change sign
+
+class ComponentDistribution {
+    ComponentType type;
+    int componentId;
+    DistributionType distribution;
+    double tolerance;
+public:
+    ComponentDistribution(ComponentType type, int componentId, DistributionType distribution, double tolerance);
+
+    static ComponentDistribution uniform(ComponentType type, int componentId, double tolerance);
+
+    static ComponentDistribution normal(ComponentType type, int componentId, double sigma);
+
+    ComponentType getType() const;
+
+    int getComponentId() const;
+
+    double sample(double nominal, std::mt19937_64 &generator) const;
+};
+
+//Mean, variance, extremes and histogram of a value, updated one sample at a time (Welford)
+//Values outside of the histogram range are counted in underflow and overflow
+
+class RunningStatistics {
+    long numberOfSamples = 0;
+    double mean = 0;
+    double sumOfSquaredDeviations = 0;
+    double minimum = 0;
+    double maximum = 0;
+    double histogramLower = 0;
+    double histogramUpper = 0;
+    vector<long> histogram;
+    long underflow = 0;
+    long overflow = 0;
+public:
+    RunningStatistics() = default;
+
+    RunningStatistics(double histogramLower, double histogramUpper, int numberOfBins);
+
+    void add(double value);
+
+    void merge(const RunningStatistics &other);
+
+    long getNumberOfSamples() const;
+
+    double getMean() const;
+
+    double getVariance() const;
+
+    double getStandardDeviation() const;
+
+    double getMinimum() const;
+
+    double getMaximum() const;
+
+    double getHistogramLower() const;
+
+    double getHistogramUpper() const;
+
+    const vector<long> &getHistogram() const;
+
+    long getUnderflow() const;
+
+    long getOverflow() const;
+};
+
+class MonteCarloResults {
+public:
+    long numberOfSamples = 0;
+    long numberOfPassingSamples = 0;
+    vector<int> branchIds;
+    vector<int> nodeIds;
+    vector<RunningStatistics> branchCurrents;
+    vector<RunningStatistics> nodeVoltages;
+
+    double getYield() const;
+};
+
+//Monte Carlo tolerance analysis: samples component values, solves each sample and keeps only running statistics
+//Samples are split into chunks with their own random stream seeded from (seed, chunk), so the sampled values
+//don't depend on the number of threads. Every thread refactors its own copy of the compiled circuit.
+//The histogram range of each value is taken from the extremes of a pilot run of the first chunks, which are solved
+//again for the statistics instead of keeping their samples.
+
+class MonteCarlo {
+    CompiledCircuit compiledCircuit;
+    vector<ComponentDistribution> distributions;
+    vector<int> distributionIndices;
+    vector<int> limitedBranches;
+    vector<double> lowerLimits;
+    vector<double> upperLimits;
+    unsigned long seed = 1;
+    int numberOfBins = 50;
+    int numberOfThreads;
+
+    static const int SAMPLES_PER_CHUNK = 256;
+    static const int PILOT_CHUNKS = 4;
+
+public:
+    explicit MonteCarlo(Circuit &circuit, int numberOfThreads = 0);
+
+    explicit MonteCarlo(const CompiledCircuit &compiledCircuit, int numberOfThreads = 0);
+
+    void addDistribution(const ComponentDistribution &distribution);
+
+    void addBranchCurrentLimits(int branchId, double lowerLimit, double upperLimit);
+
+    void setSeed(unsigned long seed);
+
+    void setNumberOfBins(int numberOfBins);
+
+    MonteCarloResults run(long numberOfSamples) const;
+
+private:
+    void solveSample(CompiledCircuit &worker, ComponentValues &values, std::mt19937_64 &generator,
+                     vector<double> &currents, vector<double> &voltages) const;
+
+    bool isWithinLimits(const vector<double> &currents) const;
+};
+
+
+#endif //CIRCUITANALYZER_MONTECARLO_H
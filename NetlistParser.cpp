@@ -0,0 +1,350 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cmath>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include "NetlistParser.h"
+#include "MappedFile.h"
+
+static const char RESISTOR_CARD = 'R';
+static const char VOLTAGE_SOURCE_CARD = 'V';
+static const char CURRENT_SOURCE_CARD = 'I';
+static const char VOLTMETER_CARD = 'V';
+static const char AMPERMETER_CARD = 'A';
+static const char WATTMETER_CARD = 'W';
+static const int MAXIMUM_FIELDS = 8;
+static const int MAXIMUM_VALUE_LENGTH = 64;
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+//FNV-1a of the upper case name
+static uint64_t hashName(const char *begin, const char *end) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char *p = begin; p < end; p++) {
+        hash ^= (unsigned char) toupper((unsigned char) *p);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//keyword is given in upper case
+static bool isKeyword(const char *begin, const char *end, const char *keyword) {
+    size_t length = strlen(keyword);
+    if (end - begin != length) return false;
+    for (size_t i = 0; i < length; i++)
+        if (toupper((unsigned char) begin[i]) != keyword[i]) return false;
+    return true;
+}
+
+NetlistError::NetlistError(int line, const std::string &message) :
+        std::domain_error("Line " + std::to_string(line) + ": " + message), line(line) {}
+
+int NetlistError::getLine() const {
+    return line;
+}
+
+NetlistParser::NetlistParser(std::istream &input, size_t chunkSize) : input(&input),
+                                                                     buffer(std::max<size_t>(chunkSize, 64)) {
+    data = buffer.data();
+}
+
+//Parses the memory in place, it has to stay valid while the parser is used
+NetlistParser::NetlistParser(const char *begin, const char *end) : data(begin), filled(end - begin),
+                                                                   endOfInput(true) {}
+
+//Reads the next netlist (up to .END or the end of the input), returns false if there is none left
+//A netlist with an error is skipped up to its .END before the error is thrown, so the next one can still be read
+bool NetlistParser::next(Circuit &circuit) {
+    try {
+        const char *begin, *end;
+        while (nextLine(begin, end)) {
+            parseLine(begin, end);
+            if (ended) break;
+        }
+        if (!ended && cardTypes.empty() && meterTypes.empty()) {
+            clear();
+            return false;
+        }
+        build(circuit);
+    } catch (const NetlistError &) {
+        skipNetlist();
+        clear();
+        throw;
+    }
+    clear();
+    return true;
+}
+
+int NetlistParser::getLineNumber() const {
+    return lineNumber;
+}
+
+Circuit NetlistParser::parse(const char *begin, const char *end) {
+    NetlistParser parser(begin, end);
+    Circuit circuit;
+    parser.next(circuit);
+    return circuit;
+}
+
+Circuit NetlistParser::parse(const std::string &text) {
+    return parse(text.data(), text.data() + text.size());
+}
+
+Circuit NetlistParser::parseFile(const std::string &path) {
+    MappedFile file(path);
+    return parse(file.getData(), file.getData() + file.getSize());
+}
+
+bool NetlistParser::nextLine(const char *&begin, const char *&end) {
+    while (true) {
+        const char *start = data + position;
+        const char *newline = nullptr;
+        if (position < filled) newline = static_cast<const char *>(memchr(start, '\n', filled - position));
+        if (newline != nullptr) {
+            begin = start;
+            end = newline;
+            position = newline - data + 1;
+            lineNumber++;
+            return true;
+        }
+        if (endOfInput) {
+            if (position == filled) return false;
+            begin = start;
+            end = data + filled;
+            position = filled;
+            lineNumber++;
+            return true;
+        }
+        //the unfinished line moves to the front of the buffer, which grows only for lines longer than a chunk
+        size_t remaining = filled - position;
+        memmove(buffer.data(), buffer.data() + position, remaining);
+        if (remaining == buffer.size()) buffer.resize(2 * buffer.size());
+        data = buffer.data();
+        position = 0;
+        input->read(buffer.data() + remaining, buffer.size() - remaining);
+        filled = remaining + input->gcount();
+        if (!*input) endOfInput = true;
+    }
+}
+
+void NetlistParser::parseLine(const char *begin, const char *end) {
+    const char *fieldBegins[MAXIMUM_FIELDS], *fieldEnds[MAXIMUM_FIELDS];
+    int numberOfFields = 0;
+    const char *p = begin;
+    while (true) {
+        while (p < end && isSpace(*p)) p++;
+        if (p == end || *p == ';') break;
+        if (numberOfFields == MAXIMUM_FIELDS) throw NetlistError(lineNumber, "Too many fields!");
+        fieldBegins[numberOfFields] = p;
+        while (p < end && !isSpace(*p) && *p != ';') p++;
+        fieldEnds[numberOfFields++] = p;
+    }
+    if (numberOfFields == 0 || *fieldBegins[0] == '*') return;
+
+    char kind = toupper((unsigned char) *fieldBegins[0]);
+    if (kind == '.') {
+        char meter;
+        if (isKeyword(fieldBegins[0], fieldEnds[0], ".END")) {
+            ended = true;
+            return;
+        } else if (isKeyword(fieldBegins[0], fieldEnds[0], ".VOLTMETER")) meter = VOLTMETER_CARD;
+        else if (isKeyword(fieldBegins[0], fieldEnds[0], ".AMMETER")) meter = AMPERMETER_CARD;
+        else if (isKeyword(fieldBegins[0], fieldEnds[0], ".WATTMETER")) meter = WATTMETER_CARD;
+        else return;
+
+        if (numberOfFields != (meter == WATTMETER_CARD ? 3 : 4))
+            throw NetlistError(lineNumber, meter == WATTMETER_CARD ? "Wattmeter needs a name and an element!"
+                                                                   : "Meter needs a name and two nodes!");
+        if (!meterNames.emplace(hashName(fieldBegins[1], fieldEnds[1]), meterTypes.size()).second)
+            throw NetlistError(lineNumber, "Duplicate meter name!");
+        meterTypes.push_back(meter);
+        meterLines.push_back(lineNumber);
+        if (meter == WATTMETER_CARD) {
+            meterFirstNodes.push_back(0);
+            meterSecondNodes.push_back(0);
+            meterElements.push_back(hashName(fieldBegins[2], fieldEnds[2]));
+        } else {
+            meterFirstNodes.push_back(parseNode(fieldBegins[2], fieldEnds[2]));
+            meterSecondNodes.push_back(parseNode(fieldBegins[3], fieldEnds[3]));
+            meterElements.push_back(0);
+        }
+        return;
+    }
+    if (kind == '+') throw NetlistError(lineNumber, "Continuation lines aren't supported!");
+    if (kind != RESISTOR_CARD && kind != VOLTAGE_SOURCE_CARD && kind != CURRENT_SOURCE_CARD)
+        throw NetlistError(lineNumber, "Unknown card!");
+
+    int valueField = 3;
+    if (kind != RESISTOR_CARD && numberOfFields == 5 && isKeyword(fieldBegins[3], fieldEnds[3], "DC"))
+        valueField = 4;
+    if (numberOfFields != valueField + 1) throw NetlistError(lineNumber, "Element needs two nodes and a value!");
+    int positiveNode = parseNode(fieldBegins[1], fieldEnds[1]);
+    int negativeNode = parseNode(fieldBegins[2], fieldEnds[2]);
+    double value = parseValue(fieldBegins[valueField], fieldEnds[valueField]);
+    if (kind == RESISTOR_CARD && value < 0) throw NetlistError(lineNumber, "Resistance can't be negative!");
+
+    //a voltage source raises the potential from the first to the second node of its branch
+    bool reversed = kind == VOLTAGE_SOURCE_CARD;
+    cardTypes.push_back(kind);
+    firstNodes.push_back(reversed ? negativeNode : positiveNode);
+    secondNodes.push_back(reversed ? positiveNode : negativeNode);
+    values.push_back(value);
+    elementNames.push_back(hashName(fieldBegins[0], fieldEnds[0]));
+    cardLines.push_back(lineNumber);
+}
+
+//Numbered nodes keep their number, named ones are numbered -1, -2, ... until the netlist is built
+int NetlistParser::parseNode(const char *begin, const char *end) {
+    long number = 0;
+    const char *p = begin;
+    while (p < end && isdigit((unsigned char) *p)) {
+        number = 10 * number + (*p - '0');
+        if (number > INT_MAX) throw NetlistError(lineNumber, "Node number is too large!");
+        p++;
+    }
+    if (p == end) {
+        largestNode = std::max(largestNode, (int) number);
+        return number;
+    }
+    if (isKeyword(begin, end, "GND")) return 0;
+    auto it = nodeNames.emplace(hashName(begin, end), nodeNames.size()).first;
+    return -it->second - 1;
+}
+
+double NetlistParser::parseValue(const char *begin, const char *end) const {
+    if (end - begin >= MAXIMUM_VALUE_LENGTH) throw NetlistError(lineNumber, "Value is too long!");
+    char text[MAXIMUM_VALUE_LENGTH];
+    memcpy(text, begin, end - begin);
+    text[end - begin] = '\0';
+    char *suffix;
+    double value = strtod(text, &suffix);
+    if (suffix == text) throw NetlistError(lineNumber, "Invalid value!");
+
+    double scale = 1;
+    char first = toupper((unsigned char) *suffix);
+    if (first == 'M' && toupper((unsigned char) suffix[1]) == 'E' && toupper((unsigned char) suffix[2]) == 'G') {
+        scale = 1e6;
+        suffix += 3;
+    } else {
+        switch (first) {
+            case 'F':
+                scale = 1e-15;
+                break;
+            case 'P':
+                scale = 1e-12;
+                break;
+            case 'N':
+                scale = 1e-9;
+                break;
+            case 'U':
+                scale = 1e-6;
+                break;
+            case 'M':
+                scale = 1e-3;
+                break;
+            case 'K':
+                scale = 1e3;
+                break;
+            case 'G':
+                scale = 1e9;
+                break;
+            case 'T':
+                scale = 1e12;
+                break;
+            default:
+                break;
+        }
+        if (scale != 1) suffix++;
+    }
+    for (; *suffix != '\0'; suffix++)
+        if (!isalpha((unsigned char) *suffix)) throw NetlistError(lineNumber, "Invalid value!");
+    value *= scale;
+    if (!std::isfinite(value)) throw NetlistError(lineNumber, "Invalid value!");
+    return value;
+}
+
+void NetlistParser::build(Circuit &circuit) {
+    circuit = Circuit();
+    int firstNamedNode = largestNode + 1;
+    auto node = [firstNamedNode](int n) -> int { return n >= 0 ? n : firstNamedNode - n - 1; };
+
+    //meters go in first, while the circuit is still small enough for its branch id lookup
+    int numberOfVoltmeters = 0, numberOfAmpermeters = 0;
+    for (int m = 0; m < meterTypes.size(); m++) {
+        if (meterTypes[m] == VOLTMETER_CARD)
+            circuit.addVoltmeterToCircuit(Voltmeter(numberOfVoltmeters++), node(meterSecondNodes[m]),
+                                          node(meterFirstNodes[m]));
+        else if (meterTypes[m] == AMPERMETER_CARD)
+            circuit.addAmpermeterToCircuit(Ampermeter(numberOfAmpermeters++, 0), node(meterFirstNodes[m]),
+                                           node(meterSecondNodes[m]));
+    }
+
+    vector<Branch> &branches = circuit.getBranches();
+    int firstBranchId = branches.size() + 1;
+    int numberOfResistors = 0, numberOfVoltageSources = 0, numberOfCurrentSources = 0;
+    branches.reserve(branches.size() + cardTypes.size());
+    for (int c = 0; c < cardTypes.size(); c++) {
+        branches.emplace_back(firstBranchId + c, Node(node(firstNodes[c])), Node(node(secondNodes[c])));
+        Branch &b = branches.back();
+        double value = values[c];
+        if (cardTypes[c] == RESISTOR_CARD)
+            b.addResistor(Resistor(value, numberOfResistors++));
+        else if (cardTypes[c] == VOLTAGE_SOURCE_CARD)
+            b.addVoltageSource(VoltageSource(numberOfVoltageSources++, fabs(value), 0, value >= 0));
+        else
+            b.addCurrentSource(CurrentSource(numberOfCurrentSources++, fabs(value), -1, value >= 0));
+    }
+
+    //sorted (name, card) pairs, a repeated name is reported at its later card
+    vector<std::pair<uint64_t, int>> sortedNames(cardTypes.size());
+    for (int c = 0; c < cardTypes.size(); c++)
+        sortedNames[c] = {elementNames[c], c};
+    std::sort(sortedNames.begin(), sortedNames.end());
+    for (int i = 1; i < sortedNames.size(); i++)
+        if (sortedNames[i].first == sortedNames[i - 1].first)
+            throw NetlistError(cardLines[sortedNames[i].second], "Duplicate element name!");
+
+    int numberOfWattmeters = 0;
+    for (int m = 0; m < meterTypes.size(); m++) {
+        if (meterTypes[m] != WATTMETER_CARD) continue;
+        auto it = std::lower_bound(sortedNames.begin(), sortedNames.end(), std::make_pair(meterElements[m], 0));
+        if (it == sortedNames.end() || it->first != meterElements[m])
+            throw NetlistError(meterLines[m], "Unknown element!");
+        circuit.addWattmeterToCircuit(Wattmeter(numberOfWattmeters++, firstBranchId + it->second));
+    }
+}
+
+void NetlistParser::skipNetlist() {
+    const char *begin, *end;
+    while (!ended && nextLine(begin, end)) {
+        while (begin < end && isSpace(*begin)) begin++;
+        const char *p = begin;
+        while (p < end && !isSpace(*p) && *p != ';') p++;
+        if (isKeyword(begin, p, ".END")) ended = true;
+    }
+}
+
+void NetlistParser::clear() {
+    cardTypes.clear();
+    firstNodes.clear();
+    secondNodes.clear();
+    values.clear();
+    elementNames.clear();
+    cardLines.clear();
+    meterTypes.clear();
+    meterFirstNodes.clear();
+    meterSecondNodes.clear();
+    meterElements.clear();
+    meterLines.clear();
+    meterNames.clear();
+    nodeNames.clear();
+    largestNode = 0;
+    ended = false;
+}
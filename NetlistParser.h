@@ -0,0 +1,107 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_NETLISTPARSER_H
+#define CIRCUITANALYZER_NETLISTPARSER_H
+
+#include <vector>
+#include <string>
+#include <istream>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include "Circuit.h"
+
+using std::vector;
+
+//Error in a netlist, what() starts with the line in which it was found
+
+class NetlistError : public std::domain_error {
+    int line;
+public:
+    NetlistError(int line, const std::string &message);
+
+    int getLine() const;
+};
+
+//Reader of netlists in a SPICE-like subset, one card per line, names and keywords are case insensitive
+//
+//  Rname n1 n2 value             resistor
+//  Vname n+ n- [DC] value        ideal voltage source, V(n+) - V(n-) = value
+//  Iname n+ n- [DC] value        ideal current source, value flows from n+ through the source to n-
+//  .VOLTMETER name n+ n-         ideal voltmeter, reads V(n+) - V(n-)
+//  .AMMETER name n1 n2           ideal ampermeter, a short circuit between n1 and n2 reading the current n1 -> n2
+//  .WATTMETER name element       power absorbed by the branch of an R, V or I card
+//  .END                          end of the netlist
+//
+//Values take the SPICE suffixes f, p, n, u, m, k, meg, g and t, letters after them (units) are ignored.
+//Nodes are non-negative integers, 0 and gnd are the ground, any other name gets an id above the numbered nodes.
+//Lines starting with * and everything after ; are comments, other dot cards (.OP, .OPTIONS, ...) are ignored.
+//Components and meters get ids in the order of their cards, counted separately for every kind starting at 0.
+//Meter branches come first in the circuit, then one branch per R, V and I card in the order of the cards.
+//
+//The input is scanned in place with a hand-written tokenizer (a memory mapped file, or large chunks read from a
+//stream), so no string is made per line. Names are only kept as 64-bit hashes. Cards are collected in flat arrays
+//and turned into branches once the netlist ends, duplicate element names are found then by sorting the hashes.
+//A stream may hold many netlists, each ended by .END. After an error in one of them, next() goes on with the
+//netlist after its .END.
+
+class NetlistParser {
+    std::istream *input = nullptr;
+    vector<char> buffer;
+    const char *data = nullptr;
+    size_t position = 0;
+    size_t filled = 0;
+    bool endOfInput = false;
+    int lineNumber = 0;
+
+    vector<char> cardTypes;
+    vector<int> firstNodes;
+    vector<int> secondNodes;
+    vector<double> values;
+    vector<uint64_t> elementNames;
+    vector<int> cardLines;
+    vector<char> meterTypes;
+    vector<int> meterFirstNodes;
+    vector<int> meterSecondNodes;
+    vector<uint64_t> meterElements;
+    vector<int> meterLines;
+    std::unordered_map<uint64_t, int> meterNames;
+    std::unordered_map<uint64_t, int> nodeNames;
+    int largestNode = 0;
+    bool ended = false;
+
+public:
+    explicit NetlistParser(std::istream &input, size_t chunkSize = 1 << 20);
+
+    NetlistParser(const char *begin, const char *end);
+
+    bool next(Circuit &circuit);
+
+    int getLineNumber() const;
+
+    static Circuit parse(const char *begin, const char *end);
+
+    static Circuit parse(const std::string &text);
+
+    static Circuit parseFile(const std::string &path);
+
+private:
+    bool nextLine(const char *&begin, const char *&end);
+
+    void parseLine(const char *begin, const char *end);
+
+    int parseNode(const char *begin, const char *end);
+
+    double parseValue(const char *begin, const char *end) const;
+
+    void build(Circuit &circuit);
+
+    void skipNetlist();
+
+    void clear();
+};
+
+
+#endif //CIRCUITANALYZER_NETLISTPARSER_H
@@ -0,0 +1,166 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cmath>
+#include <algorithm>
+#include "NonlinearSolver.h"
+
+NonlinearSolver::NonlinearSolver(Circuit &circuit) :
+        topology(std::make_shared<CircuitTopology>(circuit)), compiledCircuit(topology) {
+    for (auto &b : circuit.getBranches())
+        for (const auto &e : b.getNonlinearElements())
+            elements.push_back(e);
+    ComponentValues values = topology->getValuesOf(circuit);
+    topology->getBranchValues(values, resistances, voltages, sourceCurrents);
+}
+
+void NonlinearSolver::setTolerances(double relativeTolerance, double voltageTolerance, double currentTolerance) {
+    if (relativeTolerance < 0 || voltageTolerance <= 0 || currentTolerance <= 0)
+        throw std::domain_error("Tolerances must be positive!");
+    NonlinearSolver::relativeTolerance = relativeTolerance;
+    NonlinearSolver::voltageTolerance = voltageTolerance;
+    NonlinearSolver::currentTolerance = currentTolerance;
+}
+
+void NonlinearSolver::setMaximumIterations(int maximumIterations) {
+    if (maximumIterations < 1) throw std::domain_error("Newton-Raphson needs at least one iteration!");
+    NonlinearSolver::maximumIterations = maximumIterations;
+}
+
+const NonlinearSolverStatistics &NonlinearSolver::getStatistics() const {
+    return statistics;
+}
+
+const AnalysisStatistics &NonlinearSolver::getAnalysisStatistics() const {
+    return compiledCircuit.getAnalysisStatistics();
+}
+
+void NonlinearSolver::getNonlinearVoltages(const vector<double> &branchCurrents, vector<double> &nonlinearVoltages,
+                                           vector<double> &derivatives) const {
+    const CircuitTopology &t = *topology;
+    nonlinearVoltages.assign(t.getNumberOfBranches(), 0.0);
+    derivatives.assign(t.getNumberOfBranches(), 0.0);
+    for (int i = 0; i < elements.size(); i++) {
+        int b = t.nonlinearBranches[i];
+        nonlinearVoltages[b] += elements[i]->getVoltage(branchCurrents[b]);
+        derivatives[b] += elements[i]->getDerivative(branchCurrents[b]);
+    }
+}
+
+//Euclidean norm of the loop residuals (Second Kirchoff's Law); converged tells if every loop is within tolerance
+double NonlinearSolver::getResidual(double level, const vector<double> &branchCurrents, bool &converged) const {
+    const CircuitTopology &t = *topology;
+    vector<double> nonlinearVoltages, derivatives;
+    getNonlinearVoltages(branchCurrents, nonlinearVoltages, derivatives);
+    double sumOfSquares = 0;
+    converged = true;
+    for (const auto &loop : t.loops) {
+        double residual = 0, scale = 0;
+        for (const auto &lb : loop) {
+            int b = lb.branch;
+            double drop = resistances[b] * branchCurrents[b];
+            residual += lb.orientation * (drop + nonlinearVoltages[b] - level * voltages[b]);
+            scale += fabs(drop) + fabs(nonlinearVoltages[b]) + fabs(level * voltages[b]);
+        }
+        sumOfSquares += residual * residual;
+        if (fabs(residual) > voltageTolerance + relativeTolerance * scale) converged = false;
+    }
+    return sqrt(sumOfSquares);
+}
+
+//Newton-Raphson with all sources scaled by level, starting from branchCurrents
+//The first step is always taken in full, so that the currents satisfy the linear equations (First Kirchoff's Law
+//and the current sources) of this level; damped steps stay on them.
+bool NonlinearSolver::solveAtSourceLevel(double level, vector<double> &branchCurrents) {
+    int numberOfBranches = topology->getNumberOfBranches();
+    vector<double> nonlinearVoltages, derivatives, factoredDerivatives;
+    vector<double> companionVoltages(numberOfBranches), companionCurrents(numberOfBranches);
+    vector<double> newtonCurrents, trialCurrents(numberOfBranches);
+    for (int b = 0; b < numberOfBranches; b++)
+        companionCurrents[b] = level * sourceCurrents[b];
+
+    bool converged;
+    double residual = getResidual(level, branchCurrents, converged);
+    bool needsFactorization = true;
+    bool freshFactorization = false;
+
+    for (int iteration = 0; iteration < maximumIterations; iteration++) {
+        statistics.iterations++;
+        getNonlinearVoltages(branchCurrents, nonlinearVoltages, derivatives);
+        if (needsFactorization) {
+            factoredDerivatives = derivatives;
+            vector<double> tangentResistances = resistances;
+            for (int b = 0; b < numberOfBranches; b++)
+                tangentResistances[b] += derivatives[b];
+            compiledCircuit.refactorBranches(tangentResistances);
+            statistics.factorizations++;
+            needsFactorization = false;
+            freshFactorization = true;
+        }
+        for (int b = 0; b < numberOfBranches; b++)
+            companionVoltages[b] = level * voltages[b] - nonlinearVoltages[b] +
+                                   factoredDerivatives[b] * branchCurrents[b];
+        compiledCircuit.setBranchSources(companionVoltages, companionCurrents);
+        compiledCircuit.solve(newtonCurrents);
+
+        double damping = 1;
+        double trialResidual = 0;
+        for (int halving = 0;; halving++) {
+            for (int b = 0; b < numberOfBranches; b++)
+                trialCurrents[b] = branchCurrents[b] + damping * (newtonCurrents[b] - branchCurrents[b]);
+            trialResidual = getResidual(level, trialCurrents, converged);
+            if (iteration == 0 || trialResidual < residual || halving == MAXIMUM_HALVINGS) break;
+            if (halving == 0) statistics.dampedSteps++;
+            damping /= 2;
+        }
+
+        bool smallStep = true;
+        for (int b = 0; b < numberOfBranches; b++)
+            if (fabs(trialCurrents[b] - branchCurrents[b]) > relativeTolerance * fabs(trialCurrents[b]) +
+                                                             currentTolerance)
+                smallStep = false;
+        if (converged && smallStep) {
+            branchCurrents.swap(trialCurrents);
+            return true;
+        }
+
+        if (iteration > 0 && trialResidual >= residual) {
+            //an old Jacobian can stall, a fresh one that can't reduce the residual even with damping has failed
+            if (freshFactorization) return false;
+            needsFactorization = true;
+            continue;
+        }
+        needsFactorization = trialResidual > CHORD_CONTRACTION * residual;
+        freshFactorization = false;
+        residual = trialResidual;
+        branchCurrents.swap(trialCurrents);
+    }
+    return false;
+}
+
+vector<double> NonlinearSolver::solve() {
+    statistics = NonlinearSolverStatistics();
+    vector<double> branchCurrents(topology->getNumberOfBranches(), 0.0);
+    if (solveAtSourceLevel(1, branchCurrents)) return branchCurrents;
+
+    //source stepping: with all sources at zero every current is zero
+    std::fill(branchCurrents.begin(), branchCurrents.end(), 0.0);
+    vector<double> lastConverged = branchCurrents;
+    double level = 0, step = 0.1;
+    while (level < 1) {
+        if (statistics.sourceSteps == MAXIMUM_SOURCE_STEPS || step < 1e-6)
+            throw std::domain_error("Newton-Raphson didn't converge!");
+        statistics.sourceSteps++;
+        double nextLevel = level + step > 1 ? 1 : level + step;
+        if (solveAtSourceLevel(nextLevel, branchCurrents)) {
+            level = nextLevel;
+            lastConverged = branchCurrents;
+            step *= 2;
+        } else {
+            branchCurrents = lastConverged;
+            step /= 2;
+        }
+    }
+    return branchCurrents;
+}
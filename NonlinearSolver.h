@@ -0,0 +1,72 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_NONLINEARSOLVER_H
+#define CIRCUITANALYZER_NONLINEARSOLVER_H
+
+#include <vector>
+#include <memory>
+#include "CompiledCircuit.h"
+
+using std::vector;
+
+class NonlinearSolverStatistics {
+public:
+    int iterations = 0;
+    int factorizations = 0;
+    int sourceSteps = 0;
+    int dampedSteps = 0;
+};
+
+//DC operating point of a circuit with nonlinear elements (Newton-Raphson on the branch currents)
+//Around the current I0 every nonlinear branch is replaced by its tangent: resistance dV/dI and source
+//dV/dI * I0 - V(I0), so each iteration is a linear solve of the compiled circuit with the same pattern and symbolic
+//factorization. The tangent resistances are only refactored when the last step didn't reduce the loop residual
+//by at least CHORD_CONTRACTION, otherwise the old factorization is reused (chord method).
+//A step that doesn't reduce the residual is halved (damping). If Newton doesn't converge with the full sources,
+//they are ramped up from zero (source stepping), starting every level from the solution of the previous one.
+
+class NonlinearSolver {
+    std::shared_ptr<const CircuitTopology> topology;
+    CompiledCircuit compiledCircuit;
+    vector<std::shared_ptr<const NonlinearElement>> elements;
+    vector<double> resistances;
+    vector<double> voltages;
+    vector<double> sourceCurrents;
+    NonlinearSolverStatistics statistics;
+
+    double relativeTolerance = 1e-9;
+    double voltageTolerance = 1e-9;
+    double currentTolerance = 1e-12;
+    int maximumIterations = 100;
+
+    static constexpr double CHORD_CONTRACTION = 0.25;
+    static const int MAXIMUM_HALVINGS = 10;
+    static const int MAXIMUM_SOURCE_STEPS = 1000;
+
+public:
+    explicit NonlinearSolver(Circuit &circuit);
+
+    void setTolerances(double relativeTolerance, double voltageTolerance, double currentTolerance);
+
+    void setMaximumIterations(int maximumIterations);
+
+    const NonlinearSolverStatistics &getStatistics() const;
+
+    //Phases of every Newton iteration added up
+    const AnalysisStatistics &getAnalysisStatistics() const;
+
+    vector<double> solve();
+
+private:
+    bool solveAtSourceLevel(double level, vector<double> &branchCurrents);
+
+    void getNonlinearVoltages(const vector<double> &branchCurrents, vector<double> &nonlinearVoltages,
+                              vector<double> &derivatives) const;
+
+    double getResidual(double level, const vector<double> &branchCurrents, bool &converged) const;
+};
+
+
+#endif //CIRCUITANALYZER_NONLINEARSOLVER_H
@@ -0,0 +1,111 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cmath>
+#include "ParameterSweep.h"
+#include "ThreadPool.h"
+
+SweepParameter::SweepParameter(ComponentType type, int componentId, const vector<double> &values) :
+        type(type), componentId(componentId), values(values) {
+    if (values.empty()) throw std::domain_error("A sweep needs at least one value!");
+}
+
+SweepParameter SweepParameter::linear(ComponentType type, int componentId, double start, double stop,
+                                      int numberOfPoints) {
+    if (numberOfPoints < 1) throw std::domain_error("A sweep needs at least one value!");
+    vector<double> values;
+    for (int i = 0; i < numberOfPoints; i++)
+        values.push_back(numberOfPoints == 1 ? start : start + (stop - start) * i / (numberOfPoints - 1));
+    return SweepParameter(type, componentId, values);
+}
+
+SweepParameter SweepParameter::logarithmic(ComponentType type, int componentId, double start, double stop,
+                                           int numberOfPoints) {
+    if (start <= 0 || stop <= 0) throw std::domain_error("Logarithmic sweep needs positive values!");
+    SweepParameter parameter = linear(type, componentId, log(start), log(stop), numberOfPoints);
+    for (auto &v : parameter.values)
+        v = exp(v);
+    return parameter;
+}
+
+ComponentType SweepParameter::getType() const {
+    return type;
+}
+
+int SweepParameter::getComponentId() const {
+    return componentId;
+}
+
+const vector<double> &SweepParameter::getValues() const {
+    return values;
+}
+
+int SweepResults::getNumberOfPoints() const {
+    return numberOfBranches == 0 ? 0 : branchCurrents.size() / numberOfBranches;
+}
+
+double SweepResults::getParameterValue(int point, int parameter) const {
+    return parameterValues.at(point * numberOfParameters + parameter);
+}
+
+double SweepResults::getBranchCurrent(int point, int branch) const {
+    return branchCurrents.at(point * numberOfBranches + branch);
+}
+
+const double *SweepResults::getBranchCurrentsOfPoint(int point) const {
+    return branchCurrents.data() + point * numberOfBranches;
+}
+
+ParameterSweep::ParameterSweep(Circuit &circuit, int numberOfThreads) :
+        compiledCircuit(circuit), numberOfThreads(numberOfThreads) {}
+
+ParameterSweep::ParameterSweep(const CompiledCircuit &compiledCircuit, int numberOfThreads) :
+        compiledCircuit(compiledCircuit), numberOfThreads(numberOfThreads) {}
+
+void ParameterSweep::addParameter(const SweepParameter &parameter) {
+    int index = compiledCircuit.getTopology()->getComponentIndex(parameter.getType(), parameter.getComponentId());
+    if (index < 0) throw std::domain_error("Swept component is not in the circuit!");
+    parameters.push_back(parameter);
+    parameterIndices.push_back(index);
+}
+
+int ParameterSweep::getNumberOfPoints() const {
+    int numberOfPoints = 1;
+    for (const auto &p : parameters)
+        numberOfPoints *= p.getValues().size();
+    return numberOfPoints;
+}
+
+SweepResults ParameterSweep::run() const {
+    SweepResults results;
+    int numberOfPoints = getNumberOfPoints();
+    results.numberOfParameters = parameters.size();
+    results.numberOfBranches = compiledCircuit.getTopology()->getNumberOfBranches();
+    results.branchIds = compiledCircuit.getTopology()->branchIds;
+    results.parameterValues.resize((size_t) numberOfPoints * results.numberOfParameters);
+    results.branchCurrents.resize((size_t) numberOfPoints * results.numberOfBranches);
+
+    int threads = std::max(1, std::min(getNumberOfThreads(numberOfThreads), numberOfPoints));
+    vector<CompiledCircuit> workers(threads, compiledCircuit);
+    vector<ComponentValues> workerValues(threads, compiledCircuit.getValues());
+    vector<vector<double>> workerCurrents(threads);
+
+    parallelFor(numberOfPoints, threads, [&](int thread, int point) -> void {
+        ComponentValues &values = workerValues[thread];
+        int rest = point;
+        for (int p = parameters.size() - 1; p >= 0; p--) {
+            const vector<double> &parameterValues = parameters[p].getValues();
+            double value = parameterValues[rest % parameterValues.size()];
+            rest /= parameterValues.size();
+            values.getValues(parameters[p].getType())[parameterIndices[p]] = value;
+            results.parameterValues[(size_t) point * results.numberOfParameters + p] = value;
+        }
+        workers[thread].refactor(values);
+        vector<double> &currents = workerCurrents[thread];
+        workers[thread].solve(currents);
+        std::copy(currents.begin(), currents.end(),
+                  results.branchCurrents.begin() + (size_t) point * results.numberOfBranches);
+    });
+    return results;
+}
@@ -0,0 +1,75 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_PARAMETERSWEEP_H
+#define CIRCUITANALYZER_PARAMETERSWEEP_H
+
+#include <vector>
+#include "CompiledCircuit.h"
+
+using std::vector;
+
+//One swept component: its type, id and the list of values it takes
+
+class SweepParameter {
+    ComponentType type;
+    int componentId;
+    vector<double> values;
+public:
+    SweepParameter(ComponentType type, int componentId, const vector<double> &values);
+
+    static SweepParameter linear(ComponentType type, int componentId, double start, double stop, int numberOfPoints);
+
+    static SweepParameter logarithmic(ComponentType type, int componentId, double start, double stop,
+                                      int numberOfPoints);
+
+    ComponentType getType() const;
+
+    int getComponentId() const;
+
+    const vector<double> &getValues() const;
+};
+
+//Dense results of a sweep, one row per point
+//Points are ordered like nested loops over the parameters, the last parameter changes fastest
+
+class SweepResults {
+public:
+    int numberOfParameters = 0;
+    int numberOfBranches = 0;
+    vector<int> branchIds;
+    vector<double> parameterValues;
+    vector<double> branchCurrents;
+
+    int getNumberOfPoints() const;
+
+    double getParameterValue(int point, int parameter) const;
+
+    double getBranchCurrent(int point, int branch) const;
+
+    const double *getBranchCurrentsOfPoint(int point) const;
+};
+
+//Sweeps any number of component values (nested) over a circuit whose topology is analysed only once
+//Points are solved in parallel, every thread refactoring its own copy of the compiled circuit
+
+class ParameterSweep {
+    CompiledCircuit compiledCircuit;
+    vector<SweepParameter> parameters;
+    vector<int> parameterIndices;
+    int numberOfThreads;
+public:
+    explicit ParameterSweep(Circuit &circuit, int numberOfThreads = 0);
+
+    explicit ParameterSweep(const CompiledCircuit &compiledCircuit, int numberOfThreads = 0);
+
+    void addParameter(const SweepParameter &parameter);
+
+    int getNumberOfPoints() const;
+
+    SweepResults run() const;
+};
+
+
+#endif //CIRCUITANALYZER_PARAMETERSWEEP_H
@@ -0,0 +1,72 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cmath>
+#include "PowerAccounting.h"
+
+//One pass over each component array (SoA), the branch resistances and voltages needed by the current sources are
+//gathered on the way
+PowerReport::PowerReport(const CompiledCircuit &compiledCircuit, const vector<double> &branchCurrents) {
+    const CircuitTopology &t = *compiledCircuit.getTopology();
+    const ComponentValues &values = compiledCircuit.getValues();
+    int numberOfBranches = t.getNumberOfBranches();
+    vector<double> nodeVoltages;
+    compiledCircuit.getNodeVoltages(branchCurrents, nodeVoltages);
+    vector<double> branchResistances = t.fixedResistances;
+    vector<double> branchVoltages(numberOfBranches, 0.0);
+    double sumOfMagnitudes = 0;
+
+    parasitePowers.resize(numberOfBranches);
+    for (int b = 0; b < numberOfBranches; b++) {
+        parasitePowers[b] = branchCurrents[b] * branchCurrents[b] * t.fixedResistances[b];
+        totalDissipated += parasitePowers[b];
+    }
+
+    resistorPowers.resize(t.resistorIds.size());
+    for (int i = 0; i < t.resistorIds.size(); i++) {
+        int b = t.resistorBranches[i];
+        double resistance = values.resistances[i] < 0 ? 0 : values.resistances[i];   //infinite carries no current
+        resistorPowers[i] = branchCurrents[b] * branchCurrents[b] * resistance;
+        branchResistances[b] += resistance;
+        totalDissipated += resistorPowers[i];
+    }
+
+    voltageSourcePowers.resize(t.voltageSourceIds.size());
+    for (int i = 0; i < t.voltageSourceIds.size(); i++) {
+        int b = t.voltageSourceBranches[i];
+        double voltage = t.voltageSourceOrientations[i] * values.voltages[i];
+        voltageSourcePowers[i] = voltage * branchCurrents[b];
+        branchVoltages[b] += voltage;
+        totalDelivered += voltageSourcePowers[i];
+        sumOfMagnitudes += fabs(voltageSourcePowers[i]);
+    }
+
+    //V(second) - V(first) = E - I * R + U, where U is the voltage across the current sources of the branch
+    currentSourcePowers.assign(t.currentSourceIds.size(), 0.0);
+    for (int i = 0; i < t.currentSourceIds.size(); i++) {
+        int b = t.currentSourceBranches[i];
+        if (t.branchCurrentSource[b] != i) continue;
+        int first = t.firstNodes[b], second = t.secondNodes[b];
+        if (t.getTreeRoot(first) != t.getTreeRoot(second)) continue;
+        double voltage = nodeVoltages[second] - nodeVoltages[first] - branchVoltages[b] +
+                         branchCurrents[b] * branchResistances[b];
+        currentSourcePowers[i] = voltage * branchCurrents[b];
+        totalDelivered += currentSourcePowers[i];
+        sumOfMagnitudes += fabs(currentSourcePowers[i]);
+    }
+
+    branchPowers.resize(numberOfBranches);
+    for (int b = 0; b < numberOfBranches; b++)
+        branchPowers[b] = (nodeVoltages[t.firstNodes[b]] - nodeVoltages[t.secondNodes[b]]) * branchCurrents[b];
+    balanceScale = sumOfMagnitudes + totalDissipated;
+}
+
+//Delivered minus dissipated power, zero up to rounding for a correct solution
+double PowerReport::getBalanceResidual() const {
+    return totalDelivered - totalDissipated;
+}
+
+double PowerReport::getRelativeBalanceResidual() const {
+    return balanceScale == 0 ? 0 : fabs(getBalanceResidual()) / balanceScale;
+}
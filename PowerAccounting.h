@@ -0,0 +1,40 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_POWERACCOUNTING_H
+#define CIRCUITANALYZER_POWERACCOUNTING_H
+
+#include <vector>
+#include "CompiledCircuit.h"
+
+using std::vector;
+
+//Power of every component of a solved DC circuit
+//Dissipated: I^2 * R of each resistor (same order as ComponentValues::resistances) and of the parasite resistances
+//of each branch. Delivered: E * I of each voltage source and U * I of each current source, where U is the voltage
+//the current source needs to keep its current (only the first current source of a branch carries it).
+//branchPowers is the power absorbed by each branch, (V(first) - V(second)) * I.
+//In DC nothing stores energy, so delivered and dissipated power must balance.
+
+class PowerReport {
+    double balanceScale = 0;
+
+public:
+    vector<double> resistorPowers;
+    vector<double> parasitePowers;
+    vector<double> voltageSourcePowers;
+    vector<double> currentSourcePowers;
+    vector<double> branchPowers;
+    double totalDissipated = 0;
+    double totalDelivered = 0;
+
+    PowerReport(const CompiledCircuit &compiledCircuit, const vector<double> &branchCurrents);
+
+    double getBalanceResidual() const;
+
+    double getRelativeBalanceResidual() const;
+};
+
+
+#endif //CIRCUITANALYZER_POWERACCOUNTING_H
@@ -0,0 +1,602 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "ResultWriter.h"
+
+#ifndef _WIN32
+
+#include <cerrno>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#endif
+
+//Grisu2 (Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers")
+//A double is a 64-bit significand with a binary exponent, value = f * 2^e.
+
+class DiyFp {
+public:
+    uint64_t f;
+    int e;
+};
+
+static DiyFp multiply(const DiyFp &x, const DiyFp &y) {
+    uint64_t a = x.f >> 32, b = x.f & 0xFFFFFFFFu, c = y.f >> 32, d = y.f & 0xFFFFFFFFu;
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t middle = (bd >> 32) + (ad & 0xFFFFFFFFu) + (bc & 0xFFFFFFFFu) + (1u << 31);
+    return {ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64};
+}
+
+static DiyFp normalize(DiyFp x) {
+    while (!(x.f & (1ull << 63))) {
+        x.f <<= 1;
+        x.e--;
+    }
+    return x;
+}
+
+static const int SMALLEST_POWER = -348;
+static const int LARGEST_POWER = 348;
+
+//Big integer (32-bit words, least significant first), only used to build the table of powers
+static void multiplyByTen(vector<uint32_t> &number) {
+    uint64_t carry = 0;
+    for (auto &word : number) {
+        carry += (uint64_t) word * 10;
+        word = (uint32_t) carry;
+        carry >>= 32;
+    }
+    if (carry) number.push_back((uint32_t) carry);
+}
+
+static void divideByTen(vector<uint32_t> &number) {
+    uint64_t remainder = 0;
+    for (int i = (int) number.size() - 1; i >= 0; i--) {
+        uint64_t current = (remainder << 32) | number[i];
+        number[i] = (uint32_t) (current / 10);
+        remainder = current % 10;
+    }
+    while (!number.empty() && number.back() == 0) number.pop_back();
+}
+
+//Top 64 bits of the number rounded to nearest, e is set so that number ~ f * 2^e
+static DiyFp getLeadingBits(const vector<uint32_t> &number) {
+    int length = 32 * ((int) number.size() - 1);
+    for (uint32_t top = number.back(); top; top >>= 1) length++;
+    auto getBit = [&](int i) -> uint64_t {
+        return i < 0 ? 0 : (number[i / 32] >> (i % 32)) & 1;
+    };
+    uint64_t f = 0;
+    for (int i = length - 1; i >= length - 64; i--)
+        f = (f << 1) | getBit(i);
+    DiyFp result = {f, length - 64};
+    if (getBit(length - 65)) {
+        result.f++;
+        if (result.f == 0) result = {1ull << 63, length - 63};
+    }
+    return result;
+}
+
+//10^p for every p from SMALLEST_POWER to LARGEST_POWER, normalized and correctly rounded
+static const vector<DiyFp> &getPowersOfTen() {
+    static const vector<DiyFp> powers = [] {
+        vector<DiyFp> result(LARGEST_POWER - SMALLEST_POWER + 1);
+        vector<uint32_t> number = {1};
+        for (int p = 0; p <= LARGEST_POWER; p++) {
+            result[p - SMALLEST_POWER] = getLeadingBits(number);
+            multiplyByTen(number);
+        }
+        //10^-p = floor(2^shift / 10^p) * 2^-shift, with at least 128 bits left for the smallest power
+        const int shift = 1280;
+        number.assign(shift / 32 + 1, 0);
+        number.back() = 1;
+        for (int p = 0; p >= SMALLEST_POWER; p--) {
+            DiyFp power = getLeadingBits(number);
+            result[p - SMALLEST_POWER] = {power.f, power.e - shift};
+            divideByTen(number);
+        }
+        return result;
+    }();
+    return powers;
+}
+
+static const uint32_t POWERS_OF_TEN[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+                                         1000000000};
+
+static void roundDigit(char *digits, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance) {
+    while (rest < distance && delta - rest >= tenKappa &&
+           (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance)) {
+        digits[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+//Digits of a number between low and high (high - low = delta), as close to w as they can be
+static int generateDigits(const DiyFp &w, const DiyFp &high, uint64_t delta, char *digits, int &exponent) {
+    const DiyFp one = {1ull << -high.e, high.e};
+    const uint64_t distance = high.f - w.f;
+    uint32_t integral = (uint32_t) (high.f >> -one.e);
+    uint64_t fractional = high.f & (one.f - 1);
+    int kappa = 0;
+    while (kappa < 10 && integral >= POWERS_OF_TEN[kappa]) kappa++;
+    int length = 0;
+    while (kappa > 0) {
+        uint32_t digit = integral / POWERS_OF_TEN[kappa - 1];
+        integral %= POWERS_OF_TEN[kappa - 1];
+        if (digit || length) digits[length++] = (char) ('0' + digit);
+        kappa--;
+        uint64_t rest = ((uint64_t) integral << -one.e) + fractional;
+        if (rest <= delta) {
+            exponent += kappa;
+            roundDigit(digits, length, delta, rest, (uint64_t) POWERS_OF_TEN[kappa] << -one.e, distance);
+            return length;
+        }
+    }
+    while (true) {
+        fractional *= 10;
+        delta *= 10;
+        char digit = (char) (fractional >> -one.e);
+        if (digit || length) digits[length++] = (char) ('0' + digit);
+        fractional &= one.f - 1;
+        kappa--;
+        if (fractional < delta) {
+            exponent += kappa;
+            roundDigit(digits, length, delta, fractional, one.f, -kappa < 10 ? distance * POWERS_OF_TEN[-kappa] : 0);
+            return length;
+        }
+    }
+}
+
+//Shortest digits of a positive finite value, value ~ digits * 10^exponent
+static int getShortestDigits(double value, char *digits, int &exponent) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint64_t hiddenBit = 1ull << 52;
+    int biasedExponent = (int) ((bits >> 52) & 0x7FF);
+    uint64_t significand = bits & (hiddenBit - 1);
+    DiyFp v = biasedExponent ? DiyFp{significand | hiddenBit, biasedExponent - 1075} : DiyFp{significand, -1074};
+
+    //Halfway to the neighbouring doubles, closer below at powers of two
+    DiyFp high = normalize({(v.f << 1) + 1, v.e - 1});
+    DiyFp low = v.f == hiddenBit && biasedExponent > 1 ? DiyFp{(v.f << 2) - 1, v.e - 2} : DiyFp{(v.f << 1) - 1,
+                                                                                                  v.e - 1};
+    low.f <<= low.e - high.e;
+    low.e = high.e;
+
+    //Scale by a power of ten so that the product exponent is in [-60, -32]
+    const vector<DiyFp> &powers = getPowersOfTen();
+    int p = (int) std::ceil((-47 - high.e) * 0.30102999566398114);
+    while (p < LARGEST_POWER && high.e + powers[p - SMALLEST_POWER].e + 64 < -60) p++;
+    while (p > SMALLEST_POWER && high.e + powers[p - SMALLEST_POWER].e + 64 > -32) p--;
+    const DiyFp &power = powers[p - SMALLEST_POWER];
+
+    DiyFp w = multiply(normalize(v), power);
+    DiyFp scaledHigh = multiply(high, power);
+    DiyFp scaledLow = multiply(low, power);
+    scaledLow.f++;
+    scaledHigh.f--;
+    exponent = -p;
+    return generateDigits(w, scaledHigh, scaledHigh.f - scaledLow.f, digits, exponent);
+}
+
+int formatInteger(long long value, char *text) {
+    char reversed[24];
+    int length = 0;
+    unsigned long long magnitude = value < 0 ? 0ull - (unsigned long long) value : (unsigned long long) value;
+    do {
+        reversed[length++] = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    int position = 0;
+    if (value < 0) text[position++] = '-';
+    while (length) text[position++] = reversed[--length];
+    return position;
+}
+
+int formatShortest(double value, char *text) {
+    if (std::isnan(value)) {
+        memcpy(text, "nan", 3);
+        return 3;
+    }
+    int position = 0;
+    if (std::signbit(value)) {
+        text[position++] = '-';
+        value = -value;
+    }
+    if (std::isinf(value)) {
+        memcpy(text + position, "inf", 3);
+        return position + 3;
+    }
+    if (value == 0) {
+        text[position++] = '0';
+        return position;
+    }
+    char digits[20];
+    int exponent;
+    int length = getShortestDigits(value, digits, exponent);
+    int point = length + exponent;
+    if (length <= point && point <= 21) {
+        //Integer: 1500
+        memcpy(text + position, digits, length);
+        memset(text + position + length, '0', point - length);
+        return position + point;
+    } else if (0 < point && point <= 21) {
+        //1.25
+        memcpy(text + position, digits, point);
+        text[position + point] = '.';
+        memcpy(text + position + point + 1, digits + point, length - point);
+        return position + length + 1;
+    } else if (-6 < point && point <= 0) {
+        //0.00125
+        text[position++] = '0';
+        text[position++] = '.';
+        memset(text + position, '0', -point);
+        memcpy(text + position - point, digits, length);
+        return position - point + length;
+    }
+    //1.25e-7
+    text[position++] = digits[0];
+    if (length > 1) {
+        text[position++] = '.';
+        memcpy(text + position, digits + 1, length - 1);
+        position += length - 1;
+    }
+    text[position++] = 'e';
+    return position + formatInteger(point - 1, text + position);
+}
+
+static const char RESULTS_MAGIC[8] = {'R', 'E', 'S', 'U', 'L', 'T', 'S', '\0'};
+
+static const uint32_t RESULTS_VERSION = 1;
+
+class BinaryResultHeader {
+public:
+    int64_t index;
+    uint32_t numberOfBranches;
+    uint32_t numberOfNodes;
+    uint32_t numberOfMeters;
+    uint32_t errorLength;
+};
+
+ResultWriter::ResultWriter(const std::string &path, ResultFormat format, size_t bufferSize) :
+        format(format), buffer(std::max<size_t>(bufferSize, 4096)) {
+    if (path == "-") file = stdout;
+    else {
+        file = fopen(path.c_str(), "wb");
+        if (!file) throw std::runtime_error("Can't open " + path + "!");
+        ownsFile = true;
+    }
+    if (format == ResultFormat::BINARY) {
+        append(RESULTS_MAGIC, sizeof(RESULTS_MAGIC));
+        uint32_t version[2] = {RESULTS_VERSION, 0};
+        append(reinterpret_cast<const char *>(version), sizeof(version));
+    }
+}
+
+ResultWriter::~ResultWriter() {
+    try {
+        close();
+    } catch (const std::exception &) {
+    }
+}
+
+const ResultColumns &ResultWriter::getColumns() const {
+    return columns;
+}
+
+void ResultWriter::setColumns(const ResultColumns &columns) {
+    this->columns = columns;
+}
+
+long ResultWriter::getNumberOfResults() const {
+    return numberOfResults;
+}
+
+long long ResultWriter::getNumberOfBytes() const {
+    return numberOfBytes + used;
+}
+
+void ResultWriter::write(long index, const vector<int> &branchIds, const vector<double> &branchCurrents,
+                         const vector<int> &nodeIds, const vector<double> &nodeVoltages,
+                         const vector<double> &meterReadings) {
+    static const std::string noError;
+    writeRecord(index, branchIds, branchCurrents, nodeIds, nodeVoltages, meterReadings, noError);
+}
+
+//Node voltages are only computed when they are written
+void ResultWriter::write(long index, const CompiledCircuit &compiledCircuit, const vector<double> &branchCurrents,
+                         const vector<double> &meterReadings) {
+    static const vector<int> noIds;
+    const CircuitTopology &topology = *compiledCircuit.getTopology();
+    if (columns.nodeVoltages) compiledCircuit.getNodeVoltages(branchCurrents, nodeVoltages);
+    else nodeVoltages.clear();
+    write(index, topology.branchIds, branchCurrents, columns.nodeVoltages ? topology.nodeIds : noIds, nodeVoltages,
+          meterReadings);
+}
+
+void ResultWriter::write(const BatchResult &result) {
+    static const vector<int> noIds;
+    static const vector<double> noValues;
+    if (!result.isSolved()) writeError(result.index, result.error);
+    else write(result.index, result.branchIds, result.branchCurrents, noIds, noValues, result.meterReadings);
+}
+
+void ResultWriter::writeError(long index, const std::string &error) {
+    static const vector<int> noIds;
+    static const vector<double> noValues;
+    writeRecord(index, noIds, noValues, noIds, noValues, noValues, error.empty() ? "Not solved" : error);
+}
+
+//Gathers the selected values, a selection can't be applied to a result that doesn't have the values at all
+template<typename T>
+static const vector<T> &selectColumns(const vector<T> &values, const vector<int> &selection, vector<T> &selected) {
+    if (selection.empty() || values.empty()) return values;
+    selected.clear();
+    for (auto i : selection) {
+        if (i < 0 || i >= values.size()) throw std::domain_error("Selected column isn't in the result!");
+        selected.push_back(values[i]);
+    }
+    return selected;
+}
+
+void ResultWriter::writeRecord(long index, const vector<int> &branchIds, const vector<double> &branchCurrents,
+                               const vector<int> &nodeIds, const vector<double> &nodeVoltages,
+                               const vector<double> &meterReadings, const std::string &error) {
+    static const vector<int> noIds;
+    static const vector<double> noValues;
+    if (!file) throw std::logic_error("Result writer is closed!");
+    if (branchIds.size() != branchCurrents.size() || nodeIds.size() != nodeVoltages.size())
+        throw std::logic_error("Ids and values of a result don't match!");
+    bool currents = columns.branchCurrents, voltages = columns.nodeVoltages, meters = columns.meterReadings;
+    const vector<int> &b = currents ? selectColumns(branchIds, columns.branches, selectedBranchIds) : noIds;
+    const vector<double> &i = currents ? selectColumns(branchCurrents, columns.branches, selectedCurrents) : noValues;
+    const vector<int> &n = voltages ? selectColumns(nodeIds, columns.nodes, selectedNodeIds) : noIds;
+    const vector<double> &v = voltages ? selectColumns(nodeVoltages, columns.nodes, selectedVoltages) : noValues;
+    const vector<double> &m = meters ? selectColumns(meterReadings, columns.meters, selectedReadings) : noValues;
+    switch (format) {
+        case ResultFormat::CSV:
+            writeCsv(index, b, i, n, v, m, error);
+            break;
+        case ResultFormat::JSON_LINES:
+            writeJson(index, b, i, n, v, m, error);
+            break;
+        case ResultFormat::BINARY:
+            writeBinary(index, b, i, n, v, m, error);
+            break;
+    }
+    numberOfResults++;
+}
+
+void ResultWriter::writeCsv(long index, const vector<int> &branchIds, const vector<double> &branchCurrents,
+                            const vector<int> &nodeIds, const vector<double> &nodeVoltages,
+                            const vector<double> &meterReadings, const std::string &error) {
+    if (headerMeters < 0 || (error.empty() && (branchIds != headerBranchIds || nodeIds != headerNodeIds ||
+                                               meterReadings.size() != headerMeters)))
+        writeCsvHeader(branchIds, nodeIds, (int) meterReadings.size());
+    appendInteger(index);
+    if (!error.empty()) {
+        //Empty values in the columns of the last header
+        size_t numberOfColumns = headerBranchIds.size() + headerNodeIds.size() + headerMeters + 1;
+        memset(reserve(numberOfColumns), ',', numberOfColumns);
+        used += numberOfColumns;
+        appendString(error, false);
+        append("\n", 1);
+        return;
+    }
+    for (auto value : branchCurrents) {
+        append(",", 1);
+        appendDouble(value, false);
+    }
+    for (auto value : nodeVoltages) {
+        append(",", 1);
+        appendDouble(value, false);
+    }
+    for (auto value : meterReadings) {
+        append(",", 1);
+        appendDouble(value, false);
+    }
+    append(",\n", 2);
+}
+
+void ResultWriter::writeCsvHeader(const vector<int> &branchIds, const vector<int> &nodeIds, int numberOfMeters) {
+    headerBranchIds = branchIds;
+    headerNodeIds = nodeIds;
+    headerMeters = numberOfMeters;
+    append("index", 5);
+    for (auto id : branchIds) {
+        append(",I", 2);
+        appendInteger(id);
+    }
+    for (auto id : nodeIds) {
+        append(",V", 2);
+        appendInteger(id);
+    }
+    for (int m = 0; m < numberOfMeters; m++) {
+        append(",M", 2);
+        appendInteger(m);
+    }
+    append(",error\n", 7);
+}
+
+void ResultWriter::writeJson(long index, const vector<int> &branchIds, const vector<double> &branchCurrents,
+                             const vector<int> &nodeIds, const vector<double> &nodeVoltages,
+                             const vector<double> &meterReadings, const std::string &error) {
+    append("{\"index\":", 9);
+    appendInteger(index);
+    if (!error.empty()) {
+        append(",\"error\":", 9);
+        appendString(error, true);
+        append("}\n", 2);
+        return;
+    }
+    auto appendIds = [&](const char *name, const vector<int> &ids) -> void {
+        append(name, strlen(name));
+        for (int k = 0; k < ids.size(); k++) {
+            if (k) append(",", 1);
+            appendInteger(ids[k]);
+        }
+        append("]", 1);
+    };
+    auto appendValues = [&](const char *name, const vector<double> &values) -> void {
+        append(name, strlen(name));
+        for (int k = 0; k < values.size(); k++) {
+            if (k) append(",", 1);
+            appendDouble(values[k], true);
+        }
+        append("]", 1);
+    };
+    if (!branchIds.empty()) {
+        appendIds(",\"branches\":[", branchIds);
+        appendValues(",\"currents\":[", branchCurrents);
+    }
+    if (!nodeIds.empty()) {
+        appendIds(",\"nodes\":[", nodeIds);
+        appendValues(",\"voltages\":[", nodeVoltages);
+    }
+    if (!meterReadings.empty()) appendValues(",\"meters\":[", meterReadings);
+    append("}\n", 2);
+}
+
+void ResultWriter::writeBinary(long index, const vector<int> &branchIds, const vector<double> &branchCurrents,
+                               const vector<int> &nodeIds, const vector<double> &nodeVoltages,
+                               const vector<double> &meterReadings, const std::string &error) {
+    static const char padding[8] = {};
+    BinaryResultHeader header = {index, (uint32_t) branchIds.size(), (uint32_t) nodeIds.size(),
+                                 (uint32_t) meterReadings.size(), (uint32_t) error.size()};
+    const void *pieces[] = {&header, branchCurrents.data(), nodeVoltages.data(), meterReadings.data(),
+                            branchIds.data(), nodeIds.data(), error.data(), padding};
+    size_t sizes[] = {sizeof(header), branchCurrents.size() * sizeof(double), nodeVoltages.size() * sizeof(double),
+                      meterReadings.size() * sizeof(double), branchIds.size() * sizeof(int32_t),
+                      nodeIds.size() * sizeof(int32_t), error.size(), 0};
+    size_t size = 0;
+    for (auto s : sizes) size += s;
+    sizes[7] = (8 - size % 8) % 8;
+    size += sizes[7];
+    if (size <= buffer.size() / 2) {
+        for (int k = 0; k < 8; k++)
+            append(static_cast<const char *>(pieces[k]), sizes[k]);
+        return;
+    }
+    //Large record: the buffered data and the columns in one writev
+    const void *all[9] = {buffer.data()};
+    size_t allSizes[9] = {used};
+    for (int k = 0; k < 8; k++) {
+        all[k + 1] = pieces[k];
+        allSizes[k + 1] = sizes[k];
+    }
+    writeOut(all, allSizes, 9);
+    used = 0;
+}
+
+char *ResultWriter::reserve(size_t size) {
+    if (used + size > buffer.size()) {
+        flush();
+        if (size > buffer.size()) buffer.resize(size);
+    }
+    return buffer.data() + used;
+}
+
+void ResultWriter::append(const char *text, size_t size) {
+    if (size > buffer.size() / 2) {
+        const void *pieces[] = {buffer.data(), text};
+        size_t sizes[] = {used, size};
+        writeOut(pieces, sizes, 2);
+        used = 0;
+        return;
+    }
+    memcpy(reserve(size), text, size);
+    used += size;
+}
+
+void ResultWriter::appendInteger(long long value) {
+    used += formatInteger(value, reserve(24));
+}
+
+void ResultWriter::appendDouble(double value, bool json) {
+    if (json && !std::isfinite(value)) append("null", 4);
+    else used += formatShortest(value, reserve(32));
+}
+
+std::string getJsonString(const std::string &text) {
+    std::string json = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') json += '\\';
+        if ((unsigned char) c < 0x20) {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            json += escaped;
+        } else json += c;
+    }
+    return json + "\"";
+}
+
+void ResultWriter::appendString(const std::string &text, bool json) {
+    append("\"", 1);
+    for (char c : text) {
+        if (c == '"') append(json ? "\\\"" : "\"\"", 2);
+        else if (json && c == '\\') append("\\\\", 2);
+        else if (json && (unsigned char) c < 0x20) {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            append(escaped, 6);
+        } else append(&c, 1);
+    }
+    append("\"", 1);
+}
+
+void ResultWriter::writeOut(const void *const *pieces, const size_t *sizes, int count) {
+    fflush(file);
+#ifndef _WIN32
+    const int maximumPieces = 16;
+    iovec vectors[maximumPieces];
+    int numberOfVectors = 0;
+    for (int k = 0; k < count && numberOfVectors < maximumPieces; k++) {
+        if (sizes[k] == 0) continue;
+        vectors[numberOfVectors++] = {const_cast<void *>(pieces[k]), sizes[k]};
+        numberOfBytes += sizes[k];
+    }
+    int first = 0;
+    while (first < numberOfVectors) {
+        ssize_t written = writev(fileno(file), vectors + first, numberOfVectors - first);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Can't write the results!");
+        }
+        //Skip what was written, a partial write continues inside a piece
+        while (first < numberOfVectors && (size_t) written >= vectors[first].iov_len)
+            written -= vectors[first++].iov_len;
+        if (first < numberOfVectors) {
+            vectors[first].iov_base = static_cast<char *>(vectors[first].iov_base) + written;
+            vectors[first].iov_len -= written;
+        }
+    }
+#else
+    for (int k = 0; k < count; k++) {
+        if (sizes[k] && fwrite(pieces[k], 1, sizes[k], file) != sizes[k])
+            throw std::runtime_error("Can't write the results!");
+        numberOfBytes += sizes[k];
+    }
+#endif
+}
+
+void ResultWriter::flush() {
+    if (!file || used == 0) return;
+    const void *pieces[] = {buffer.data()};
+    size_t sizes[] = {used};
+    writeOut(pieces, sizes, 1);
+    used = 0;
+}
+
+void ResultWriter::close() {
+    if (!file) return;
+    flush();
+    FILE *closed = file;
+    file = nullptr;
+    if (ownsFile) {
+        if (fclose(closed) != 0) throw std::runtime_error("Can't write the results!");
+    } else if (fflush(closed) != 0) throw std::runtime_error("Can't write the results!");
+}
@@ -0,0 +1,144 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_RESULTWRITER_H
+#define CIRCUITANALYZER_RESULTWRITER_H
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include "BatchSolver.h"
+
+using std::vector;
+
+//Writes a decimal form of value that reads back as the same double (at most 25 characters, no '\0')
+//Digits come from Grisu2 with integer arithmetic only, about 4 times faster than snprintf("%.17g"). The result is the
+//shortest one except for a few values in ten thousand, which get one digit more. nan and inf are written as nan, inf.
+int formatShortest(double value, char *text);
+
+//Writes value in decimal (at most 20 characters, no '\0')
+int formatInteger(long long value, char *text);
+
+//text as a quoted JSON string
+std::string getJsonString(const std::string &text);
+
+enum class ResultFormat {
+    CSV, BINARY, JSON_LINES
+};
+
+//Which values of a result are written
+//The selections are indices: branches in the order of the circuit, nodes in the order of the sorted node ids and
+//meters in the order of MeterReadout. An empty selection writes all of them.
+
+class ResultColumns {
+public:
+    bool branchCurrents = true;
+    bool nodeVoltages = true;
+    bool meterReadings = true;
+    vector<int> branches;
+    vector<int> nodes;
+    vector<int> meters;
+};
+
+//Sink for solutions of many circuits, written straight from the solution vectors
+//
+//  CSV         one row per result: index, I<branch id>..., V<node id>..., M<meter>..., error
+//              A header row is written before the first result and again whenever the columns change.
+//  JSON_LINES  one object per result: {"index":0,"branches":[...],"currents":[...],"nodes":[...],"voltages":[...],
+//              "meters":[...]} or {"index":0,"error":"..."}, nan and inf are written as null
+//  BINARY      header "RESULTS\0", version (uint32), 0 (uint32), then one record per result: index (int64), number
+//              of branches, nodes, meters and error length (uint32), currents, voltages and meter readings (double),
+//              branch and node ids (int32), the error text, zeros up to a multiple of 8 bytes
+//
+//Text is formatted into one large buffer that is written when it fills up. Binary records are copied into the buffer
+//too, unless they are large, then the buffer and the columns are written by a single writev without copying.
+//The path "-" writes to the standard output. A writer isn't thread safe, BatchSolver calls its consumer one result
+//at a time.
+
+class ResultWriter {
+    FILE *file = nullptr;
+    bool ownsFile = false;
+    ResultFormat format;
+    ResultColumns columns;
+    vector<char> buffer;
+    size_t used = 0;
+    long numberOfResults = 0;
+    long long numberOfBytes = 0;
+
+    vector<int> headerBranchIds;
+    vector<int> headerNodeIds;
+    int headerMeters = -1;
+    vector<int> selectedBranchIds;
+    vector<double> selectedCurrents;
+    vector<int> selectedNodeIds;
+    vector<double> selectedVoltages;
+    vector<double> selectedReadings;
+    vector<double> nodeVoltages;
+
+public:
+    ResultWriter(const std::string &path, ResultFormat format, size_t bufferSize = 1 << 20);
+
+    ResultWriter(const ResultWriter &) = delete;
+
+    ResultWriter &operator=(const ResultWriter &) = delete;
+
+    ~ResultWriter();
+
+    const ResultColumns &getColumns() const;
+
+    void setColumns(const ResultColumns &columns);
+
+    long getNumberOfResults() const;
+
+    long long getNumberOfBytes() const;
+
+    void write(long index, const vector<int> &branchIds, const vector<double> &branchCurrents,
+               const vector<int> &nodeIds, const vector<double> &nodeVoltages, const vector<double> &meterReadings);
+
+    void write(long index, const CompiledCircuit &compiledCircuit, const vector<double> &branchCurrents,
+               const vector<double> &meterReadings);
+
+    void write(const BatchResult &result);
+
+    void writeError(long index, const std::string &error);
+
+    void flush();
+
+    void close();
+
+private:
+    void writeRecord(long index, const vector<int> &branchIds, const vector<double> &branchCurrents,
+                     const vector<int> &nodeIds, const vector<double> &nodeVoltages,
+                     const vector<double> &meterReadings, const std::string &error);
+
+    void writeCsv(long index, const vector<int> &branchIds, const vector<double> &branchCurrents,
+                  const vector<int> &nodeIds, const vector<double> &nodeVoltages,
+                  const vector<double> &meterReadings, const std::string &error);
+
+    void writeCsvHeader(const vector<int> &branchIds, const vector<int> &nodeIds, int numberOfMeters);
+
+    void writeJson(long index, const vector<int> &branchIds, const vector<double> &branchCurrents,
+                   const vector<int> &nodeIds, const vector<double> &nodeVoltages,
+                   const vector<double> &meterReadings, const std::string &error);
+
+    void writeBinary(long index, const vector<int> &branchIds, const vector<double> &branchCurrents,
+                     const vector<int> &nodeIds, const vector<double> &nodeVoltages,
+                     const vector<double> &meterReadings, const std::string &error);
+
+    char *reserve(size_t size);
+
+    void append(const char *text, size_t size);
+
+    void appendInteger(long long value);
+
+    void appendDouble(double value, bool json);
+
+    void appendString(const std::string &text, bool json);
+
+    void writeOut(const void *const *pieces, const size_t *sizes, int count);
+};
+
+
+#endif //CIRCUITANALYZER_RESULTWRITER_H
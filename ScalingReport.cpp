@@ -0,0 +1,231 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <map>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include "ScalingReport.h"
+#include "ResultWriter.h"
+
+static const char *STATUS_NAMES[] = {"unfitted", "insufficient", "new", "ok", "improved", "regressed"};
+
+static const char *CSV_HEADER = "benchmark,family,points,min_branches,max_branches,exponent,seconds,"
+                                "peak_rss_bytes,rss_growth_bytes,baseline_exponent,status";
+
+//Least squares slope of log(y) over log(x)
+static double getExponent(const vector<std::pair<double, double>> &points) {
+    double meanX = 0, meanY = 0;
+    for (const auto &p : points) {
+        meanX += std::log(p.first);
+        meanY += std::log(p.second);
+    }
+    meanX /= points.size();
+    meanY /= points.size();
+    double covariance = 0, variance = 0;
+    for (const auto &p : points) {
+        double x = std::log(p.first) - meanX;
+        covariance += x * (std::log(p.second) - meanY);
+        variance += x * x;
+    }
+    return variance > 0 ? covariance / variance : 0;
+}
+
+ScalingReport::ScalingReport(const vector<BenchmarkResult> &results) {
+    //results of every benchmark and family, in the order of the run (sizes go up)
+    std::map<std::pair<std::string, int>, int> indices;
+    for (const auto &r : results) {
+        auto key = std::make_pair(r.name, (int) r.family);
+        auto found = indices.find(key);
+        if (found == indices.end()) {
+            found = indices.emplace(key, (int) fits.size()).first;
+            ScalingFit fit;
+            fit.name = r.name;
+            fit.family = r.family;
+            fits.push_back(fit);
+            measured.emplace_back();
+        }
+        if (r.skipped.empty() && r.minSeconds > 0 && r.numberOfBranches > 0) measured[found->second].push_back(r);
+    }
+    for (int f = 0; f < fits.size(); f++)
+        fitRange(f, 0, std::numeric_limits<int>::max());
+}
+
+void ScalingReport::fitRange(int index, int minBranches, int maxBranches) {
+    ScalingFit &fit = fits[index];
+    vector<const BenchmarkResult *> inRange;
+    for (const auto &r : measured[index])
+        if (r.numberOfBranches >= minBranches && r.numberOfBranches <= maxBranches) inRange.push_back(&r);
+    fit.points = fit.minBranches = fit.maxBranches = 0;
+    fit.exponent = fit.seconds = 0;
+    fit.peakResidentBytes = fit.residentGrowthBytes = 0;
+    fit.status = ScalingStatus::UNFITTED;
+    if (inRange.empty()) return;
+    int first = std::max(0, (int) inRange.size() - MAXIMUM_FIT_POINTS);
+    vector<std::pair<double, double>> points;
+    for (int i = first; i < inRange.size(); i++)
+        points.emplace_back(inRange[i]->numberOfBranches, inRange[i]->minSeconds);
+    const BenchmarkResult &largest = *inRange.back();
+    fit.points = points.size();
+    fit.minBranches = inRange[first]->numberOfBranches;
+    fit.maxBranches = largest.numberOfBranches;
+    fit.seconds = largest.minSeconds;
+    fit.peakResidentBytes = largest.peakResidentBytes;
+    if (largest.startResidentBytes > 0)
+        fit.residentGrowthBytes = largest.peakResidentBytes - largest.startResidentBytes;
+    if (fit.points >= MINIMUM_FIT_POINTS && fit.maxBranches > fit.minBranches) {
+        fit.exponent = getExponent(points);
+        fit.status = ScalingStatus::NEW;
+    }
+}
+
+const vector<ScalingFit> &ScalingReport::getFits() const {
+    return fits;
+}
+
+static vector<std::string> splitCsvLine(const std::string &line) {
+    vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, ','))
+        fields.push_back(field);
+    return fields;
+}
+
+void ScalingReport::compare(const std::string &baselinePath, double tolerance) {
+    std::ifstream file(baselinePath);
+    if (!file) throw std::runtime_error("Can't open " + baselinePath + "!");
+    std::string line;
+    std::getline(file, line);
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    vector<std::string> header = splitCsvLine(line);
+    int nameColumn = -1, familyColumn = -1, exponentColumn = -1, statusColumn = -1, minColumn = -1, maxColumn = -1;
+    for (int i = 0; i < header.size(); i++) {
+        if (header[i] == "benchmark") nameColumn = i;
+        else if (header[i] == "min_branches") minColumn = i;
+        else if (header[i] == "max_branches") maxColumn = i;
+        else if (header[i] == "family") familyColumn = i;
+        else if (header[i] == "exponent") exponentColumn = i;
+        else if (header[i] == "status") statusColumn = i;
+    }
+    if (nameColumn < 0 || familyColumn < 0 || exponentColumn < 0)
+        throw std::domain_error(baselinePath + " isn't a scaling baseline!");
+
+    //exponent, min and max branches of every benchmark and family
+    std::map<std::pair<std::string, std::string>, ScalingFit> baseline;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        vector<std::string> fields = splitCsvLine(line);
+        if (fields.size() != header.size()) continue;
+        if (statusColumn >= 0 && (fields[statusColumn] == getStatusName(ScalingStatus::UNFITTED) ||
+                                  fields[statusColumn] == getStatusName(ScalingStatus::INSUFFICIENT)))
+            continue;
+        if (fields[exponentColumn].empty()) continue;
+        ScalingFit &fit = baseline[std::make_pair(fields[nameColumn], fields[familyColumn])];
+        fit.exponent = std::atof(fields[exponentColumn].c_str());
+        fit.minBranches = minColumn >= 0 ? std::atoi(fields[minColumn].c_str()) : 0;
+        fit.maxBranches = maxColumn >= 0 ? std::atoi(fields[maxColumn].c_str()) : 0;
+    }
+
+    for (int f = 0; f < fits.size(); f++) {
+        ScalingFit &fit = fits[f];
+        auto found = baseline.find(std::make_pair(fit.name, CircuitGenerator::getFamilyName(fit.family)));
+        fit.hasBaseline = found != baseline.end();
+        if (fit.hasBaseline) {
+            fit.baselineExponent = found->second.exponent;
+            fit.baselineMinBranches = found->second.minBranches;
+            fit.baselineMaxBranches = found->second.maxBranches;
+            if (found->second.maxBranches > found->second.minBranches && fit.status != ScalingStatus::UNFITTED) {
+                //only over the sizes of the baseline, an exponent over other sizes can't be compared with it
+                fitRange(f, found->second.minBranches, found->second.maxBranches);
+                if (fit.status == ScalingStatus::UNFITTED) {
+                    fit.status = ScalingStatus::INSUFFICIENT;
+                    continue;
+                }
+            }
+        }
+        if (fit.status == ScalingStatus::UNFITTED) continue;
+        if (!fit.hasBaseline) fit.status = ScalingStatus::NEW;
+        else if (fit.exponent > fit.baselineExponent + tolerance) fit.status = ScalingStatus::REGRESSED;
+        else if (fit.exponent < fit.baselineExponent - tolerance) fit.status = ScalingStatus::IMPROVED;
+        else fit.status = ScalingStatus::OK;
+    }
+}
+
+int ScalingReport::getNumberOfRegressions() const {
+    int regressions = 0;
+    for (const auto &fit : fits)
+        if (fit.status == ScalingStatus::REGRESSED) regressions++;
+    return regressions;
+}
+
+void ScalingReport::print(std::ostream &os) const {
+    char line[300];
+    snprintf(line, sizeof(line), "%-32s %-7s %6s %19s %8s %8s %11s %9s %9s  %s\n", "benchmark", "family",
+             "points", "branches", "exponent", "baseline", "seconds", "peak MB", "growth MB", "status");
+    os << line;
+    for (const auto &fit : fits) {
+        char range[32] = "-", exponent[16] = "-", baseline[16] = "-", seconds[16] = "-", memory[16] = "-",
+                growth[16] = "-";
+        if (fit.points > 0) {
+            snprintf(range, sizeof(range), "%d-%d", fit.minBranches, fit.maxBranches);
+            snprintf(seconds, sizeof(seconds), "%.3e", fit.seconds);
+        }
+        if (fit.status != ScalingStatus::UNFITTED && fit.status != ScalingStatus::INSUFFICIENT)
+            snprintf(exponent, sizeof(exponent), "%.2f", fit.exponent);
+        if (fit.hasBaseline) snprintf(baseline, sizeof(baseline), "%.2f", fit.baselineExponent);
+        if (fit.peakResidentBytes > 0) {
+            snprintf(memory, sizeof(memory), "%.1f", fit.peakResidentBytes / 1048576.0);
+            snprintf(growth, sizeof(growth), "%.1f", fit.residentGrowthBytes / 1048576.0);
+        }
+        char status[64];
+        if (fit.status == ScalingStatus::INSUFFICIENT)
+            snprintf(status, sizeof(status), "insufficient sizes (baseline ran %d-%d branches)",
+                     fit.baselineMinBranches, fit.baselineMaxBranches);
+        else
+            snprintf(status, sizeof(status), "%s",
+                     fit.status == ScalingStatus::REGRESSED ? "REGRESSED" : getStatusName(fit.status));
+        snprintf(line, sizeof(line), "%-32s %-7s %6d %19s %8s %8s %11s %9s %9s  %s\n", fit.name.c_str(),
+                 CircuitGenerator::getFamilyName(fit.family).c_str(), fit.points, range, exponent, baseline, seconds,
+                 memory, growth, status);
+        os << line;
+    }
+}
+
+static std::string getCsvNumber(double value) {
+    char text[32];
+    return std::string(text, formatShortest(value, text));
+}
+
+void ScalingReport::writeCsv(const std::string &path) const {
+    std::ofstream file;
+    if (path != "-") {
+        file.open(path);
+        if (!file) throw std::runtime_error("Can't open " + path + "!");
+    }
+    std::ostream &os = path == "-" ? std::cout : file;
+    os << CSV_HEADER << "\n";
+    char exponent[16];
+    for (const auto &fit : fits) {
+        exponent[0] = 0;
+        if (fit.status != ScalingStatus::UNFITTED && fit.status != ScalingStatus::INSUFFICIENT)
+            snprintf(exponent, sizeof(exponent), "%.3f", fit.exponent);
+        os << fit.name << "," << CircuitGenerator::getFamilyName(fit.family) << "," << fit.points << ","
+           << fit.minBranches << "," << fit.maxBranches << "," << exponent << "," << getCsvNumber(fit.seconds) << ","
+           << fit.peakResidentBytes << "," << fit.residentGrowthBytes << ","
+           << (fit.hasBaseline ? getCsvNumber(fit.baselineExponent) : "") << ","
+           << getStatusName(fit.status) << "\n";
+    }
+    if (!os) throw std::runtime_error("Can't write " + path + "!");
+}
+
+const char *ScalingReport::getStatusName(ScalingStatus status) {
+    return STATUS_NAMES[(int) status];
+}
@@ -0,0 +1,81 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_SCALINGREPORT_H
+#define CIRCUITANALYZER_SCALINGREPORT_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include "BenchmarkSuite.h"
+
+using std::vector;
+
+//UNFITTED: fewer than MINIMUM_FIT_POINTS sizes ran, INSUFFICIENT: fewer than MINIMUM_FIT_POINTS sizes of the baseline
+//ran, NEW: not in the baseline, OK: within the tolerance of the baseline, IMPROVED and REGRESSED: exponent below or
+//above the baseline by more than the tolerance
+enum class ScalingStatus {
+    UNFITTED, INSUFFICIENT, NEW, OK, IMPROVED, REGRESSED
+};
+
+//Empirical exponent k of time ~ branches^k of one benchmark on one family of circuits
+class ScalingFit {
+public:
+    std::string name;
+    CircuitFamily family = CircuitFamily::GRID_2D;
+    int points = 0;                      //sizes the exponent was fitted to
+    int minBranches = 0;
+    int maxBranches = 0;
+    double exponent = 0;
+    double seconds = 0;                  //minimum time of one iteration at maxBranches
+    long peakResidentBytes = 0;          //at maxBranches
+    long residentGrowthBytes = 0;        //peak RSS above the RSS before the setup, at maxBranches
+    bool hasBaseline = false;
+    double baselineExponent = 0;
+    int baselineMinBranches = 0;
+    int baselineMaxBranches = 0;
+    ScalingStatus status = ScalingStatus::UNFITTED;
+};
+
+//Complexity curves of the benchmarks of a BenchmarkSuite run over growing sizes
+//The exponent is the least squares slope of log(time) over log(branches) of the largest sizes that ran (at most
+//MAXIMUM_FIT_POINTS), where fixed costs no longer hide the growth. Two sizes are too few to tell a trend from noise,
+//benchmarks that only ran on two (slow routines stopped by the time limit) stay unfitted.
+//A baseline is a CSV written by writeCsv(), of a run that is known to be good. Only the exponents are compared, so a
+//baseline from another machine still works.
+//Which sizes run depends on the time limit of the suite, and most curves aren't a single power of the size, so a
+//comparison fits the exponent again over the sizes it shares with the baseline. A shorter time limit, or a slower
+//machine, stops a run before the largest of them, so it is compared over fewer sizes; with fewer than
+//MINIMUM_FIT_POINTS of them it has no comparable exponent and is reported as insufficient, not as a regression.
+
+class ScalingReport {
+    vector<ScalingFit> fits;
+    vector<vector<BenchmarkResult>> measured;   //sizes that ran, of every fit
+
+public:
+    static const int MINIMUM_FIT_POINTS = 3;
+    static const int MAXIMUM_FIT_POINTS = 4;
+
+    explicit ScalingReport(const vector<BenchmarkResult> &results);
+
+    const vector<ScalingFit> &getFits() const;
+
+    //Marks every fit against the exponents of the baseline, an exponent may exceed them by tolerance
+    void compare(const std::string &baselinePath, double tolerance);
+
+    int getNumberOfRegressions() const;
+
+    void print(std::ostream &os) const;
+
+    void writeCsv(const std::string &path) const;
+
+    static const char *getStatusName(ScalingStatus status);
+
+private:
+    //Fits to the largest sizes between minBranches and maxBranches
+    void fitRange(int index, int minBranches, int maxBranches);
+};
+
+
+#endif //CIRCUITANALYZER_SCALINGREPORT_H
@@ -0,0 +1,179 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cmath>
+#include <algorithm>
+#include "SparseLU.h"
+
+//Removes column from the list of its degree
+static void unlink(int column, int degree, vector<int> &heads, vector<int> &next, vector<int> &previous) {
+    if (previous[column] >= 0) next[previous[column]] = next[column];
+    else heads[degree] = next[column];
+    if (next[column] >= 0) previous[next[column]] = previous[column];
+}
+
+static void link(int column, int degree, vector<int> &heads, vector<int> &next, vector<int> &previous) {
+    previous[column] = -1;
+    next[column] = heads[degree];
+    if (heads[degree] >= 0) previous[heads[degree]] = column;
+    heads[degree] = column;
+}
+
+//Columns are eliminated as supervariables: columns in the same elements stay in the same elements, so they are merged
+//into one principal column with the sum of their weights and eliminated together. Elements list principal columns,
+//merged and eliminated ones are skipped where they are met.
+vector<int> getColumnOrdering(const SparsePattern &pattern) {
+    int n = pattern.size;
+    vector<int> order;
+    order.reserve(n);
+    if (n == 0) return order;
+    int dense = std::max(16, (int) (10 * std::sqrt((double) n)));
+
+    //rows of the pattern, dense ones are left out
+    vector<int> rowCounts(n, 0);
+    for (int p = 0; p < pattern.getNumberOfNonZeros(); p++)
+        rowCounts[pattern.rowIndices[p]]++;
+    vector<bool> denseColumn(n);
+    for (int j = 0; j < n; j++)
+        denseColumn[j] = pattern.columnPointers[j + 1] - pattern.columnPointers[j] > dense;
+
+    //elements (rows first, then one for every eliminated supervariable), the columns in them and their weight
+    vector<vector<int>> elementColumns(2 * n);
+    vector<long> elementWeights(2 * n, 0);
+    vector<vector<int>> columnElements(n);
+    for (int j = 0; j < n; j++) {
+        if (denseColumn[j]) continue;
+        for (int p = pattern.columnPointers[j]; p < pattern.columnPointers[j + 1]; p++) {
+            int i = pattern.rowIndices[p];
+            if (rowCounts[i] > dense) continue;
+            elementColumns[i].push_back(j);
+            elementWeights[i]++;
+            columnElements[j].push_back(i);
+        }
+    }
+    vector<bool> elementAlive(2 * n, false);
+    for (int i = 0; i < n; i++)
+        elementAlive[i] = !elementColumns[i].empty();
+
+    //approximate external degree: weight of the other columns of its elements, kept in lists by degree
+    int remaining = 0;
+    vector<int> weights(n, 0), degrees(n, 0), heads(n, -1), next(n, -1), previous(n, -1);
+    vector<vector<int>> merged(n);
+    for (int j = 0; j < n; j++) {
+        if (denseColumn[j]) continue;
+        remaining++;
+        weights[j] = 1;
+        long degree = 0;
+        for (int e : columnElements[j])
+            degree += elementWeights[e] - 1;
+        degrees[j] = (int) std::min(degree, (long) n - 1);
+    }
+    for (int j = n - 1; j >= 0; j--)
+        if (!denseColumn[j]) link(j, degrees[j], heads, next, previous);
+
+    vector<bool> eliminated(n, false);
+    vector<int> marks(n, -1), newColumns;
+    vector<int> externalMarks(2 * n, -1);
+    vector<long> externalWeights(2 * n, 0);
+    vector<std::pair<long, int>> hashes;
+    int minimum = 0;
+    for (int element = n; remaining > 0; element++) {
+        while (heads[minimum] < 0) minimum++;
+        int pivot = heads[minimum];
+        unlink(pivot, minimum, heads, next, previous);
+        eliminated[pivot] = true;
+        remaining -= weights[pivot];
+        order.push_back(pivot);
+        order.insert(order.end(), merged[pivot].begin(), merged[pivot].end());
+
+        //the new element has the columns of all elements of pivot, which are absorbed into it
+        newColumns.clear();
+        long newWeight = 0;
+        for (int e : columnElements[pivot]) {
+            if (!elementAlive[e]) continue;
+            for (int j : elementColumns[e]) {
+                if (eliminated[j] || weights[j] == 0 || marks[j] == element) continue;
+                marks[j] = element;
+                newColumns.push_back(j);
+                newWeight += weights[j];
+            }
+            elementAlive[e] = false;
+            vector<int>().swap(elementColumns[e]);
+        }
+        vector<int>().swap(columnElements[pivot]);
+        if (newColumns.empty()) continue;
+        elementAlive[element] = true;
+        elementColumns[element] = newColumns;
+        elementWeights[element] = newWeight;
+
+        //externalWeights[e] = weight of the columns of element e outside the new element
+        for (int j : newColumns)
+            for (int e : columnElements[j]) {
+                if (!elementAlive[e]) continue;
+                if (externalMarks[e] != element) {
+                    externalMarks[e] = element;
+                    externalWeights[e] = elementWeights[e];
+                }
+                externalWeights[e] -= weights[j];
+            }
+
+        //new degrees, elements inside the new element are absorbed (aggressive absorption)
+        hashes.clear();
+        for (int j : newColumns) {
+            long external = 0, hash = element;
+            int kept = 0;
+            vector<int> &elements = columnElements[j];
+            for (int e : elements) {
+                if (!elementAlive[e]) continue;
+                if (externalWeights[e] == 0) {
+                    elementAlive[e] = false;
+                    vector<int>().swap(elementColumns[e]);
+                    continue;
+                }
+                external += externalWeights[e];
+                hash += e;
+                elements[kept++] = e;
+            }
+            elements.resize(kept);
+            elements.push_back(element);
+            long degree = std::min((long) degrees[j], external) + newWeight - weights[j];
+            degree = std::max(std::min(degree, (long) remaining - weights[j]), 0L);
+            unlink(j, degrees[j], heads, next, previous);
+            degrees[j] = (int) degree;
+            hashes.emplace_back(hash, j);
+        }
+
+        //columns with the same elements become one supervariable
+        std::sort(hashes.begin(), hashes.end());
+        for (int a = 0; a < hashes.size(); a++) {
+            int j = hashes[a].second;
+            if (weights[j] == 0) continue;
+            for (int b = a + 1; b < hashes.size() && hashes[b].first == hashes[a].first; b++) {
+                int other = hashes[b].second;
+                if (weights[other] == 0 || columnElements[other].size() != columnElements[j].size()) continue;
+                std::sort(columnElements[j].begin(), columnElements[j].end());
+                std::sort(columnElements[other].begin(), columnElements[other].end());
+                if (columnElements[other] != columnElements[j]) continue;
+                weights[j] += weights[other];
+                degrees[j] = std::max(degrees[j] - weights[other], 0);
+                weights[other] = 0;
+                merged[j].push_back(other);
+                merged[j].insert(merged[j].end(), merged[other].begin(), merged[other].end());
+                vector<int>().swap(merged[other]);
+                vector<int>().swap(columnElements[other]);
+            }
+        }
+        for (const auto &h : hashes) {
+            int j = h.second;
+            if (weights[j] == 0) continue;
+            link(j, degrees[j], heads, next, previous);
+            minimum = std::min(minimum, degrees[j]);
+        }
+    }
+
+    //dense columns go last
+    for (int j = 0; j < n; j++)
+        if (denseColumn[j]) order.push_back(j);
+    return order;
+}
@@ -0,0 +1,309 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_SPARSELU_H
+#define CIRCUITANALYZER_SPARSELU_H
+
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <algorithm>
+
+using std::vector;
+
+//Sparsity pattern of a square matrix in compressed column form
+//Row indices of column j are rowIndices[columnPointers[j]] ... rowIndices[columnPointers[j + 1] - 1]
+//Values belonging to the pattern are kept outside of it, in the same order as rowIndices
+
+class SparsePattern {
+public:
+    int size = 0;
+    vector<int> columnPointers;
+    vector<int> rowIndices;
+
+    int getNumberOfNonZeros() const {
+        return columnPointers.empty() ? 0 : columnPointers.back();
+    }
+};
+
+//Everything about the factorization that does not depend on the values:
+//column ordering (computed once from the pattern), row pivots and the patterns of L and U (computed by the
+//first pivoting factorization). It is immutable once built, so it can be shared between threads and circuits.
+
+class SparseLUSymbolic {
+public:
+    vector<int> columnOrder;      //k-th pivot column is columnOrder[k]
+    vector<int> rowCounts;        //number of entries in each row of the pattern, used to break pivot ties
+    bool hasPivots = false;
+    vector<int> pivotPositions;   //row i of the matrix is the pivotPositions[i]-th pivot row
+    vector<int> lowerPointers;    //L is unit lower triangular, column k starts with its diagonal
+    vector<int> lowerIndices;
+    vector<int> upperPointers;    //U column k ends with its diagonal
+    vector<int> upperIndices;
+
+    long getFillIn(const SparsePattern &pattern) const {
+        if (!hasPivots) return 0;
+        return (long) lowerIndices.size() + (long) upperIndices.size() - pattern.size - pattern.getNumberOfNonZeros();
+    }
+};
+
+//Fill-reducing order of the columns of a pattern: approximate minimum degree on the pattern of A^T * A (as COLAMD),
+//worked out on the rows of A without forming A^T * A. Rows and columns with more than max(16, 10 * sqrt(n)) entries
+//are left out of the degrees, dense columns come last.
+vector<int> getColumnOrdering(const SparsePattern &pattern);
+
+//Left-looking sparse LU (Gilbert-Peierls) split into a symbolic and a numeric part.
+//factor() chooses row pivots (threshold partial pivoting, preferring sparse rows) and records the patterns of L and U.
+//refactor() reuses them and only redoes the arithmetic, falling back to factor() if a pivot became too small.
+
+template<typename Scalar>
+class SparseLU {
+    std::shared_ptr<const SparsePattern> pattern;
+    std::shared_ptr<const SparseLUSymbolic> symbolic;
+    vector<Scalar> lowerValues;
+    vector<Scalar> upperValues;
+    bool lastRefactorReusedPivots = false;
+    mutable vector<Scalar> work;
+
+    static constexpr double PIVOT_THRESHOLD = 0.1;
+    static constexpr double REFACTOR_THRESHOLD = 1e-3;
+
+    static std::shared_ptr<SparseLUSymbolic> analyze(const SparsePattern &pattern) {
+        auto result = std::make_shared<SparseLUSymbolic>();
+        result->rowCounts.assign(pattern.size, 0);
+        for (int p = 0; p < pattern.getNumberOfNonZeros(); p++)
+            result->rowCounts[pattern.rowIndices[p]]++;
+        result->columnOrder = getColumnOrdering(pattern);
+        return result;
+    }
+
+    //depth first search over the graph of L, pushes the reached rows onto stack in topological order
+    static int reach(const SparsePattern &pattern, int column, const SparseLUSymbolic &s, const vector<int> &pivots,
+                     vector<int> &stack, vector<int> &marks, vector<int> &dfsStack, vector<int> &dfsNext, int mark) {
+        int n = pattern.size;
+        int top = n;
+        for (int p = pattern.columnPointers[column]; p < pattern.columnPointers[column + 1]; p++) {
+            int start = pattern.rowIndices[p];
+            if (marks[start] == mark) continue;
+            int head = 0;
+            dfsStack[0] = start;
+            while (head >= 0) {
+                int j = dfsStack[head];
+                int pivot = pivots[j];
+                if (marks[j] != mark) {
+                    marks[j] = mark;
+                    dfsNext[head] = pivot < 0 ? 0 : s.lowerPointers[pivot] + 1;
+                }
+                bool done = true;
+                int end = pivot < 0 ? 0 : s.lowerPointers[pivot + 1];
+                for (int q = dfsNext[head]; q < end; q++) {
+                    int i = s.lowerIndices[q];
+                    if (marks[i] == mark) continue;
+                    dfsNext[head] = q + 1;
+                    dfsStack[++head] = i;
+                    done = false;
+                    break;
+                }
+                if (done) {
+                    head--;
+                    stack[--top] = j;
+                }
+            }
+        }
+        return top;
+    }
+
+public:
+    explicit SparseLU(std::shared_ptr<const SparsePattern> pattern,
+                      std::shared_ptr<const SparseLUSymbolic> symbolic = nullptr) : pattern(pattern) {
+        if (symbolic == nullptr) this->symbolic = analyze(*pattern);
+        else this->symbolic = symbolic;
+    }
+
+    const std::shared_ptr<const SparsePattern> &getPattern() const {
+        return pattern;
+    }
+
+    const std::shared_ptr<const SparseLUSymbolic> &getSymbolic() const {
+        return symbolic;
+    }
+
+    bool hasReusedPivots() const {
+        return lastRefactorReusedPivots;
+    }
+
+    //full factorization with pivoting, values are in the order of pattern->rowIndices
+    void factor(const vector<Scalar> &values) {
+        const SparsePattern &a = *pattern;
+        int n = a.size;
+        auto result = std::make_shared<SparseLUSymbolic>();
+        result->columnOrder = symbolic->columnOrder;
+        result->rowCounts = symbolic->rowCounts;
+        result->pivotPositions.assign(n, -1);
+        result->lowerPointers.assign(n + 1, 0);
+        result->upperPointers.assign(n + 1, 0);
+        lowerValues.clear();
+        upperValues.clear();
+
+        vector<Scalar> x(n, Scalar(0));
+        vector<int> stack(n), marks(n, -1), dfsStack(n), dfsNext(n);
+        vector<int> &pivots = result->pivotPositions;
+
+        for (int k = 0; k < n; k++) {
+            int column = result->columnOrder[k];
+            result->lowerPointers[k] = result->lowerIndices.size();
+            result->upperPointers[k] = result->upperIndices.size();
+
+            //x = L \ A(:, column)
+            int top = reach(a, column, *result, pivots, stack, marks, dfsStack, dfsNext, k);
+            for (int p = a.columnPointers[column]; p < a.columnPointers[column + 1]; p++)
+                x[a.rowIndices[p]] = values[p];
+            for (int px = top; px < n; px++) {
+                int j = stack[px];
+                int pivot = pivots[j];
+                if (pivot < 0) continue;
+                for (int q = result->lowerPointers[pivot] + 1; q < result->lowerPointers[pivot + 1]; q++)
+                    x[result->lowerIndices[q]] -= lowerValues[q] * x[j];
+            }
+
+            //choose the pivot row among the rows that are not yet pivotal
+            double largest = -1;
+            for (int px = top; px < n; px++) {
+                int i = stack[px];
+                if (pivots[i] < 0) largest = std::max(largest, (double) std::abs(x[i]));
+            }
+            if (largest <= 0) throw std::domain_error("Circuit equations are singular!");
+            int pivotRow = -1;
+            for (int px = top; px < n; px++) {
+                int i = stack[px];
+                if (pivots[i] >= 0) {
+                    result->upperIndices.push_back(pivots[i]);
+                    upperValues.push_back(x[i]);
+                } else if (std::abs(x[i]) >= PIVOT_THRESHOLD * largest &&
+                           (pivotRow < 0 || result->rowCounts[i] < result->rowCounts[pivotRow]))
+                    pivotRow = i;
+            }
+            Scalar pivotValue = x[pivotRow];
+            pivots[pivotRow] = k;
+            result->upperIndices.push_back(k);
+            upperValues.push_back(pivotValue);
+            result->lowerIndices.push_back(pivotRow);
+            lowerValues.push_back(Scalar(1));
+            for (int px = top; px < n; px++) {
+                int i = stack[px];
+                if (pivots[i] < 0) {
+                    result->lowerIndices.push_back(i);
+                    lowerValues.push_back(x[i] / pivotValue);
+                }
+                x[i] = Scalar(0);
+            }
+        }
+        result->lowerPointers[n] = result->lowerIndices.size();
+        result->upperPointers[n] = result->upperIndices.size();
+        //from now on rows of L are numbered by pivot position
+        for (auto &i : result->lowerIndices)
+            i = pivots[i];
+        result->hasPivots = true;
+        symbolic = result;
+        lastRefactorReusedPivots = false;
+    }
+
+    //numeric factorization reusing the pivots and patterns of the previous factor()
+    void refactor(const vector<Scalar> &values) {
+        const SparsePattern &a = *pattern;
+        const SparseLUSymbolic &s = *symbolic;
+        int n = a.size;
+        if (!s.hasPivots) {
+            factor(values);
+            return;
+        }
+        lowerValues.resize(s.lowerIndices.size());
+        upperValues.resize(s.upperIndices.size());
+        work.assign(n, Scalar(0));
+        vector<Scalar> &x = work;
+
+        for (int k = 0; k < n; k++) {
+            int column = s.columnOrder[k];
+            for (int p = a.columnPointers[column]; p < a.columnPointers[column + 1]; p++)
+                x[s.pivotPositions[a.rowIndices[p]]] = values[p];
+            int diagonal = s.upperPointers[k + 1] - 1;
+            for (int p = s.upperPointers[k]; p < diagonal; p++) {
+                int j = s.upperIndices[p];
+                upperValues[p] = x[j];
+                for (int q = s.lowerPointers[j] + 1; q < s.lowerPointers[j + 1]; q++)
+                    x[s.lowerIndices[q]] -= lowerValues[q] * x[j];
+                x[j] = Scalar(0);
+            }
+            Scalar pivotValue = x[k];
+            x[k] = Scalar(0);
+            double largest = 0;
+            for (int q = s.lowerPointers[k] + 1; q < s.lowerPointers[k + 1]; q++)
+                largest = std::max(largest, (double) std::abs(x[s.lowerIndices[q]]));
+            if (std::abs(pivotValue) == 0 || std::abs(pivotValue) < REFACTOR_THRESHOLD * largest) {
+                factor(values);
+                return;
+            }
+            upperValues[diagonal] = pivotValue;
+            lowerValues[s.lowerPointers[k]] = Scalar(1);
+            for (int q = s.lowerPointers[k] + 1; q < s.lowerPointers[k + 1]; q++) {
+                lowerValues[q] = x[s.lowerIndices[q]] / pivotValue;
+                x[s.lowerIndices[q]] = Scalar(0);
+            }
+        }
+        lastRefactorReusedPivots = true;
+    }
+
+    //frees the values of the factors (the pattern and pivots stay), the next refactor() computes them again
+    void release() {
+        vector<Scalar>().swap(lowerValues);
+        vector<Scalar>().swap(upperValues);
+        vector<Scalar>().swap(work);
+    }
+
+    //solves A * x = b in place, b is indexed by rows and the result by columns of A
+    void solve(vector<Scalar> &b) const {
+        const SparseLUSymbolic &s = *symbolic;
+        int n = pattern->size;
+        work.resize(n);
+        vector<Scalar> &y = work;
+        for (int i = 0; i < n; i++)
+            y[s.pivotPositions[i]] = b[i];
+        for (int j = 0; j < n; j++)
+            for (int q = s.lowerPointers[j] + 1; q < s.lowerPointers[j + 1]; q++)
+                y[s.lowerIndices[q]] -= lowerValues[q] * y[j];
+        for (int j = n - 1; j >= 0; j--) {
+            int diagonal = s.upperPointers[j + 1] - 1;
+            y[j] /= upperValues[diagonal];
+            for (int p = s.upperPointers[j]; p < diagonal; p++)
+                y[s.upperIndices[p]] -= upperValues[p] * y[j];
+        }
+        for (int k = 0; k < n; k++)
+            b[s.columnOrder[k]] = y[k];
+    }
+
+    //solves A^T * x = b in place with the same factors (U^T and L^T), b is indexed by columns and the result by rows
+    void solveTransposed(vector<Scalar> &b) const {
+        const SparseLUSymbolic &s = *symbolic;
+        int n = pattern->size;
+        work.resize(n);
+        vector<Scalar> &y = work;
+        for (int k = 0; k < n; k++)
+            y[k] = b[s.columnOrder[k]];
+        for (int j = 0; j < n; j++) {
+            int diagonal = s.upperPointers[j + 1] - 1;
+            for (int p = s.upperPointers[j]; p < diagonal; p++)
+                y[j] -= upperValues[p] * y[s.upperIndices[p]];
+            y[j] /= upperValues[diagonal];
+        }
+        for (int j = n - 1; j >= 0; j--)
+            for (int q = s.lowerPointers[j] + 1; q < s.lowerPointers[j + 1]; q++)
+                y[j] -= lowerValues[q] * y[s.lowerIndices[q]];
+        for (int i = 0; i < n; i++)
+            b[i] = y[s.pivotPositions[i]];
+    }
+};
+
+#endif //CIRCUITANALYZER_SPARSELU_H
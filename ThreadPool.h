@@ -0,0 +1,142 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_THREADPOOL_H
+#define CIRCUITANALYZER_THREADPOOL_H
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <exception>
+#include <mutex>
+#include <algorithm>
+#include <string>
+#include "TraceRecorder.h"
+
+//Number of worker threads to use, 0 or less means one per core
+inline int getNumberOfThreads(int requested) {
+    if (requested > 0) return requested;
+    int cores = std::thread::hardware_concurrency();
+    return cores > 0 ? cores : 1;
+}
+
+//Names the worker threads in a trace, the calling thread (index 0) keeps its name
+inline void setWorkerName(int threadIndex) {
+    if (threadIndex > 0 && TraceRecorder::isEnabled())
+        TraceRecorder::getInstance().setThreadName("worker " + std::to_string(threadIndex));
+}
+
+//Runs body(threadIndex, index) for every index in [0, count) on numberOfThreads threads
+//Indices are handed out in small chunks from a shared counter, so uneven points balance themselves
+//The first exception thrown by a worker is rethrown after all threads finished
+
+template<typename Body>
+void parallelFor(int count, int numberOfThreads, Body body) {
+    numberOfThreads = std::max(1, std::min(getNumberOfThreads(numberOfThreads), count));
+    int chunk = std::max(1, count / (numberOfThreads * 16));
+    std::atomic<int> nextIndex(0);
+    std::exception_ptr error = nullptr;
+    std::mutex errorMutex;
+
+    auto worker = [&](int threadIndex) -> void {
+        setWorkerName(threadIndex);
+        try {
+            while (true) {
+                int begin = nextIndex.fetch_add(chunk);
+                if (begin >= count) break;
+                int end = std::min(count, begin + chunk);
+                for (int i = begin; i < end; i++)
+                    body(threadIndex, i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (error == nullptr) error = std::current_exception();
+            nextIndex = count;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < numberOfThreads; t++)
+        threads.emplace_back(worker, t);
+    worker(0);
+    for (auto &t : threads)
+        t.join();
+    if (error != nullptr) std::rethrow_exception(error);
+}
+
+//Indices still owned by one worker of parallelForStealing, the owner takes them from the front
+class StealableRange {
+public:
+    std::mutex mutex;
+    int begin = 0;
+    int end = 0;
+};
+
+//Runs body(threadIndex, index) for every index in [0, count) with work stealing, returns the number of steals
+//Every worker starts with its own contiguous block, so there is no shared counter on the fast path. A worker whose
+//block is empty takes the back half of another worker's block. No two locks are ever held at once.
+//The first exception thrown by a worker is rethrown after all threads finished
+
+template<typename Body>
+long parallelForStealing(int count, int numberOfThreads, Body body) {
+    if (count <= 0) return 0;
+    numberOfThreads = std::max(1, std::min(getNumberOfThreads(numberOfThreads), count));
+    std::vector<StealableRange> ranges(numberOfThreads);
+    for (int t = 0; t < numberOfThreads; t++) {
+        ranges[t].begin = (int) ((long) count * t / numberOfThreads);
+        ranges[t].end = (int) ((long) count * (t + 1) / numberOfThreads);
+    }
+    std::atomic<long> steals(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error = nullptr;
+    std::mutex errorMutex;
+
+    auto worker = [&](int threadIndex) -> void {
+        setWorkerName(threadIndex);
+        StealableRange &own = ranges[threadIndex];
+        try {
+            while (!failed) {
+                int index = -1;
+                {
+                    std::lock_guard<std::mutex> lock(own.mutex);
+                    if (own.begin < own.end) index = own.begin++;
+                }
+                if (index >= 0) {
+                    body(threadIndex, index);
+                    continue;
+                }
+                int stolenBegin = 0, stolenEnd = 0;
+                for (int k = 1; k < numberOfThreads && stolenBegin == stolenEnd; k++) {
+                    StealableRange &victim = ranges[(threadIndex + k) % numberOfThreads];
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    int remaining = victim.end - victim.begin;
+                    if (remaining < 2) continue;     //the owner is about to take the last one
+                    stolenBegin = victim.end - remaining / 2;
+                    stolenEnd = victim.end;
+                    victim.end = stolenBegin;
+                }
+                if (stolenBegin == stolenEnd) break;
+                steals++;
+                std::lock_guard<std::mutex> lock(own.mutex);
+                own.begin = stolenBegin;
+                own.end = stolenEnd;
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (error == nullptr) error = std::current_exception();
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < numberOfThreads; t++)
+        threads.emplace_back(worker, t);
+    worker(0);
+    for (auto &t : threads)
+        t.join();
+    if (error != nullptr) std::rethrow_exception(error);
+    return steals;
+}
+
+#endif //CIRCUITANALYZER_THREADPOOL_H
@@ -0,0 +1,145 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include "TopologyCache.h"
+
+vector<uint64_t> TopologyStructure::getKey(bool dynamic, int numberOfNodes, const vector<int> &firstNodes,
+                                           const vector<int> &secondNodes, const vector<bool> &currentFixed) {
+    vector<uint64_t> key = {(uint64_t) dynamic, (uint64_t) numberOfNodes};
+    key.reserve(2 + 3 * firstNodes.size());
+    for (int b = 0; b < firstNodes.size(); b++) {
+        key.push_back(firstNodes[b]);
+        key.push_back(secondNodes[b]);
+        key.push_back(currentFixed[b]);
+    }
+    return key;
+}
+
+template<typename T>
+static long getVectorBytes(const vector<T> &v) {
+    return (long) v.capacity() * sizeof(T);
+}
+
+long TopologyStructure::getBytes() const {
+    long result = sizeof(TopologyStructure) + getVectorBytes(key) + getVectorBytes(treeParentBranch) +
+                  getVectorBytes(treeParentNode) + getVectorBytes(treeDepth) + getVectorBytes(treeOrder) +
+                  getVectorBytes(treeBranches) + getVectorBytes(loops) + getVectorBytes(entryBranch) +
+                  getVectorBytes(entrySign) + getVectorBytes(loopRows) + getVectorBytes(fixedCurrentRows) +
+                  getVectorBytes(nodeRows);
+    for (const auto &loop : loops)
+        result += getVectorBytes(loop);
+    if (pattern != nullptr)
+        result += sizeof(SparsePattern) + getVectorBytes(pattern->columnPointers) + getVectorBytes(pattern->rowIndices);
+    if (symbolic != nullptr)
+        result += sizeof(SparseLUSymbolic) + getVectorBytes(symbolic->columnOrder) +
+                  getVectorBytes(symbolic->rowCounts) + getVectorBytes(symbolic->pivotPositions) +
+                  getVectorBytes(symbolic->lowerPointers) + getVectorBytes(symbolic->lowerIndices) +
+                  getVectorBytes(symbolic->upperPointers) + getVectorBytes(symbolic->upperIndices);
+    return result;
+}
+
+TopologyCache &TopologyCache::getInstance() {
+    static TopologyCache instance;
+    return instance;
+}
+
+long TopologyCache::getCapacity() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return capacity;
+}
+
+void TopologyCache::setCapacity(long capacity) {
+    if (capacity < 1) throw std::domain_error("Cache capacity must be positive!");
+    std::lock_guard<std::mutex> lock(mutex);
+    TopologyCache::capacity = capacity;
+    evict();
+}
+
+bool TopologyCache::isEnabled() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return enabled;
+}
+
+//A disabled cache neither finds nor keeps structures, every topology is analysed from scratch
+void TopologyCache::setEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex);
+    TopologyCache::enabled = enabled;
+}
+
+int TopologyCache::getSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+long TopologyCache::getBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return bytes;
+}
+
+CacheStatistics TopologyCache::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return statistics;
+}
+
+void TopologyCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    bytes = 0;
+}
+
+std::shared_ptr<const TopologyStructure> TopologyCache::find(const vector<uint64_t> &key, uint64_t hash) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled) return nullptr;
+    auto it = index.find(hash);
+    if (it == index.end() || (*it->second)->key != key) {
+        statistics.misses++;
+        return nullptr;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    statistics.hits++;
+    return entries.front();
+}
+
+void TopologyCache::insert(const std::shared_ptr<const TopologyStructure> &structure) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled) return;
+    long size = structure->getBytes();
+    if (size > capacity) return;
+    auto it = index.find(structure->hash);
+    if (it != index.end()) {
+        bytes -= (*it->second)->getBytes();
+        *it->second = structure;
+        entries.splice(entries.begin(), entries, it->second);
+    } else {
+        entries.push_front(structure);
+        index[structure->hash] = entries.begin();
+        statistics.insertions++;
+    }
+    bytes += size;
+    evict();
+}
+
+void TopologyCache::setPivots(uint64_t hash, const std::shared_ptr<const SparsePattern> &pattern,
+                              const std::shared_ptr<const SparseLUSymbolic> &symbolic) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(hash);
+    if (it == index.end()) return;
+    const TopologyStructure &cached = **it->second;
+    if (cached.pattern != pattern || cached.symbolic->hasPivots) return;
+    auto structure = std::make_shared<TopologyStructure>(cached);
+    structure->symbolic = symbolic;
+    bytes += structure->getBytes() - cached.getBytes();
+    *it->second = structure;
+    evict();
+}
+
+void TopologyCache::evict() {
+    while (bytes > capacity && !entries.empty()) {
+        bytes -= entries.back()->getBytes();
+        index.erase(entries.back()->hash);
+        entries.pop_back();
+        statistics.evictions++;
+    }
+}
@@ -0,0 +1,103 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_TOPOLOGYCACHE_H
+#define CIRCUITANALYZER_TOPOLOGYCACHE_H
+
+#include <vector>
+#include <list>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include "CircuitFingerprint.h"
+
+using std::vector;
+using std::list;
+
+//The part of a CircuitTopology that depends only on the incidence of the branches and on which of them have fixed
+//current: spanning tree, loops, equation pattern and symbolic factorization (with the row pivots and the patterns of L
+//and U once the first circuit of the structure was factored)
+//key is the structure it was built for: dynamic, number of nodes, then first node, second node and fixed current of
+//every branch (node indices, so node ids only matter through their order)
+
+class TopologyStructure {
+public:
+    vector<uint64_t> key;
+    uint64_t hash = 0;
+
+    vector<int> treeParentBranch;
+    vector<int> treeParentNode;
+    vector<int> treeDepth;
+    vector<int> treeOrder;
+    vector<int> treeBranches;
+    vector<vector<LoopBranch>> loops;
+    std::shared_ptr<const SparsePattern> pattern;
+    vector<int> entryBranch;
+    vector<double> entrySign;
+    vector<int> loopRows;
+    vector<int> fixedCurrentRows;
+    vector<int> nodeRows;
+    std::shared_ptr<const SparseLUSymbolic> symbolic;
+
+    //memory of the structure with its arrays, the pattern and the symbolic factorization
+    long getBytes() const;
+
+    static vector<uint64_t> getKey(bool dynamic, int numberOfNodes, const vector<int> &firstNodes,
+                                   const vector<int> &secondNodes, const vector<bool> &currentFixed);
+};
+
+//Process-wide LRU cache of topology structures bounded by their bytes, safe to use from many threads
+//Every CircuitTopology looks its structure up here first, so circuits that only differ in component values skip
+//the tree, the loops and the symbolic analysis. A hit copies the arrays, the pattern and the symbolic factorization
+//are shared. The first CompiledCircuit of a structure adds the pivots of its factorization, so the circuits after it
+//only redo the arithmetic. A structure larger than the capacity isn't kept.
+
+class TopologyCache {
+    long capacity = 256L << 20;          //bytes
+    long bytes = 0;
+    bool enabled = true;
+    list<std::shared_ptr<const TopologyStructure>> entries;     //most recently used first
+    std::unordered_map<uint64_t, list<std::shared_ptr<const TopologyStructure>>::iterator> index;
+    CacheStatistics statistics;
+    mutable std::mutex mutex;
+
+    TopologyCache() = default;
+
+public:
+    TopologyCache(const TopologyCache &) = delete;
+
+    TopologyCache &operator=(const TopologyCache &) = delete;
+
+    static TopologyCache &getInstance();
+
+    long getCapacity() const;
+
+    void setCapacity(long capacity);
+
+    bool isEnabled() const;
+
+    void setEnabled(bool enabled);
+
+    int getSize() const;
+
+    long getBytes() const;
+
+    CacheStatistics getStatistics() const;
+
+    void clear();
+
+    std::shared_ptr<const TopologyStructure> find(const vector<uint64_t> &key, uint64_t hash);
+
+    void insert(const std::shared_ptr<const TopologyStructure> &structure);
+
+    //Gives the cached structure of pattern the symbolic factorization of its first factor(), if it has no pivots yet
+    void setPivots(uint64_t hash, const std::shared_ptr<const SparsePattern> &pattern,
+                   const std::shared_ptr<const SparseLUSymbolic> &symbolic);
+
+private:
+    void evict();
+};
+
+
+#endif //CIRCUITANALYZER_TOPOLOGYCACHE_H
@@ -0,0 +1,145 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cstdio>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include "TraceRecorder.h"
+#include "ResultWriter.h"
+
+static const int DEFAULT_BUFFER_CAPACITY = 16384;
+
+std::atomic<bool> TraceRecorder::enabled(false);
+
+static thread_local TraceBuffer *threadBuffer = nullptr;
+
+TraceRecorder::TraceRecorder() : buffers(nullptr), numberOfThreads(0), bufferCapacity(DEFAULT_BUFFER_CAPACITY),
+                                 start(Clock::now()) {}
+
+TraceRecorder::~TraceRecorder() {
+    TraceBuffer *buffer = buffers.load();
+    while (buffer != nullptr) {
+        TraceBuffer *next = buffer->next;
+        delete buffer;
+        buffer = next;
+    }
+}
+
+TraceRecorder &TraceRecorder::getInstance() {
+    static TraceRecorder instance;
+    return instance;
+}
+
+void TraceRecorder::setEnabled(bool enabled) {
+#ifndef CIRCUIT_TRACING
+    if (enabled) throw std::domain_error("Tracing isn't compiled in (CIRCUIT_TRACING)!");
+#endif
+    getInstance();
+    TraceRecorder::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void TraceRecorder::setBufferCapacity(int capacity) {
+    if (capacity < 1) throw std::domain_error("Trace buffers need room for at least one event!");
+    int rounded = 1;
+    while (rounded < capacity && rounded < (1 << 30))
+        rounded *= 2;
+    bufferCapacity = rounded;
+}
+
+TraceBuffer &TraceRecorder::getThreadBuffer() {
+    if (threadBuffer != nullptr) return *threadBuffer;
+    auto buffer = new TraceBuffer();
+    buffer->events.resize(bufferCapacity);
+    buffer->threadId = ++numberOfThreads;
+    buffer->threadName = "thread " + std::to_string(buffer->threadId);
+    buffer->next = buffers.load();
+    while (!buffers.compare_exchange_weak(buffer->next, buffer)) {}
+    threadBuffer = buffer;
+    return *buffer;
+}
+
+void TraceRecorder::record(const char *name, const char *category, Clock::time_point begin, Clock::time_point end) {
+    TraceBuffer &buffer = getThreadBuffer();
+    uint64_t count = buffer.count.load(std::memory_order_relaxed);
+    TraceEvent &event = buffer.events[count & (buffer.events.size() - 1)];
+    event.name = name;
+    event.category = category;
+    event.begin = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - start).count();
+    event.end = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+void TraceRecorder::setThreadName(const std::string &name) {
+    if (!isEnabled()) return;
+    TraceBuffer &buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.nameMutex);
+    buffer.threadName = name;
+}
+
+long TraceRecorder::getNumberOfEvents() const {
+    long events = 0;
+    for (TraceBuffer *b = buffers.load(); b != nullptr; b = b->next)
+        events += std::min<uint64_t>(b->count.load(), b->events.size());
+    return events;
+}
+
+long TraceRecorder::getNumberOfDroppedEvents() const {
+    long dropped = 0;
+    for (TraceBuffer *b = buffers.load(); b != nullptr; b = b->next) {
+        uint64_t count = b->count.load();
+        if (count > b->events.size()) dropped += count - b->events.size();
+    }
+    return dropped;
+}
+
+//ts and dur are in microseconds, with the nanoseconds as decimals
+//Threads are sorted by the order of their first event, which puts the stages of a pipeline in their order
+void TraceRecorder::writeJson(const std::string &path) const {
+    std::ofstream file;
+    if (path != "-") {
+        file.open(path);
+        if (!file) throw std::runtime_error("Can't open " + path + "!");
+    }
+    std::ostream &os = path == "-" ? std::cout : file;
+    os << "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":" << getNumberOfDroppedEvents()
+       << "},\n\"traceEvents\":[";
+    bool first = true;
+    char line[400];
+    vector<TraceEvent> events;
+    for (TraceBuffer *b = buffers.load(); b != nullptr; b = b->next) {
+        std::string name;
+        {
+            std::lock_guard<std::mutex> lock(b->nameMutex);
+            name = b->threadName;
+        }
+        os << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->threadId
+           << ",\"args\":{\"name\":" << getJsonString(name) << "}},\n{\"name\":\"thread_sort_index\",\"ph\":\"M\","
+           << "\"pid\":1,\"tid\":" << b->threadId << ",\"args\":{\"sort_index\":" << b->threadId << "}}";
+        first = false;
+
+        //copy, then keep only the events that weren't overwritten while copying
+        uint64_t size = b->events.size();
+        uint64_t end = b->count.load(std::memory_order_acquire);
+        uint64_t begin = end > size ? end - size : 0;
+        events.clear();
+        for (uint64_t i = begin; i < end; i++)
+            events.push_back(b->events[i & (size - 1)]);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        //event number after may be half written, in the slot of event after - size
+        uint64_t after = b->count.load(std::memory_order_acquire);
+        uint64_t valid = after + 1 > size ? after + 1 - size : 0;
+        for (uint64_t i = std::max(begin, valid); i < end; i++) {
+            const TraceEvent &e = events[i - begin];
+            snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                                         "\"ts\":%lld.%03lld,\"dur\":%lld.%03lld}", e.name, e.category, b->threadId,
+                     (long long) (e.begin / 1000), (long long) (e.begin % 1000),
+                     (long long) ((e.end - e.begin) / 1000), (long long) ((e.end - e.begin) % 1000));
+            os << line;
+        }
+    }
+    os << "\n]}\n";
+    if (!os) throw std::runtime_error("Can't write " + path + "!");
+}
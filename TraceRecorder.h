@@ -0,0 +1,129 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_TRACERECORDER_H
+#define CIRCUITANALYZER_TRACERECORDER_H
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+using std::vector;
+
+//One finished span of a thread, times in nanoseconds since the recorder was made
+//name and category must outlive the recorder (string literals)
+
+class TraceEvent {
+public:
+    const char *name = nullptr;
+    const char *category = nullptr;
+    int64_t begin = 0;
+    int64_t end = 0;
+};
+
+//Events of one thread in a ring, only that thread writes them
+//count is the number of events ever recorded, the last events.size() of them are kept
+
+class TraceBuffer {
+public:
+    vector<TraceEvent> events;
+    std::atomic<uint64_t> count;
+    int threadId = 0;
+    std::mutex nameMutex;
+    std::string threadName;
+    TraceBuffer *next = nullptr;
+
+    TraceBuffer() : count(0) {}
+};
+
+//Timeline of the threads of a run, written as Chrome trace events (loads in Perfetto and chrome://tracing)
+//Every thread records into a ring buffer of its own, made at its first event and linked into the list of the
+//recorder with a compare-and-swap, so recording takes no lock and threads don't share cache lines. A full ring
+//overwrites its oldest events. Spans are recorded when they end, with their begin, so a lost event never leaves a
+//begin without its end.
+//Switches: without CIRCUIT_TRACING defined at compile time isEnabled() is a constant false and every TraceScope
+//and PhaseTimer drops its tracing code. With it, tracing is off until setEnabled(true), and then costs one relaxed
+//load per scope while off.
+//Buffers live as long as the recorder (the program), so the events of finished threads can still be written.
+//writeJson() can run while threads record, events they overwrite during the copy are left out.
+
+class TraceRecorder {
+    typedef std::chrono::steady_clock Clock;
+
+    static std::atomic<bool> enabled;
+    std::atomic<TraceBuffer *> buffers;
+    std::atomic<int> numberOfThreads;
+    std::atomic<int> bufferCapacity;
+    Clock::time_point start;
+
+    TraceRecorder();
+
+public:
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder &) = delete;
+
+    TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+    static TraceRecorder &getInstance();
+
+    static bool isEnabled() {
+#ifdef CIRCUIT_TRACING
+        return enabled.load(std::memory_order_relaxed);
+#else
+        return false;
+#endif
+    }
+
+    //Throws if tracing isn't compiled in
+    static void setEnabled(bool enabled);
+
+    //Events kept per thread, rounded up to a power of two, for threads that haven't recorded yet (default 16384)
+    void setBufferCapacity(int capacity);
+
+    void record(const char *name, const char *category, Clock::time_point begin, Clock::time_point end);
+
+    //Name of the calling thread in the trace, only set while tracing is on
+    void setThreadName(const std::string &name);
+
+    long getNumberOfEvents() const;
+
+    //Events overwritten because a ring was full
+    long getNumberOfDroppedEvents() const;
+
+    //"-" writes to the standard output
+    void writeJson(const std::string &path) const;
+
+private:
+    TraceBuffer &getThreadBuffer();
+};
+
+//Records the span from its construction to its destruction on the calling thread
+
+class TraceScope {
+    const char *name;
+    const char *category;
+    bool tracing;
+    std::chrono::steady_clock::time_point begin;
+
+public:
+    TraceScope(const char *name, const char *category) : name(name), category(category),
+                                                          tracing(TraceRecorder::isEnabled()) {
+        if (tracing) begin = std::chrono::steady_clock::now();
+    }
+
+    ~TraceScope() {
+        if (tracing) TraceRecorder::getInstance().record(name, category, begin, std::chrono::steady_clock::now());
+    }
+
+    TraceScope(const TraceScope &) = delete;
+
+    TraceScope &operator=(const TraceScope &) = delete;
+};
+
+
+#endif //CIRCUITANALYZER_TRACERECORDER_H
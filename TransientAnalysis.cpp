@@ -0,0 +1,193 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#include <cmath>
+#include "TransientAnalysis.h"
+
+int TransientResults::getNumberOfPoints() const {
+    return times.size();
+}
+
+double TransientResults::getBranchCurrent(int point, int branch) const {
+    return branchCurrents.at((size_t) point * numberOfBranches + branch);
+}
+
+double TransientResults::getNodeVoltage(int point, int node) const {
+    return nodeVoltages.at((size_t) point * numberOfNodes + node);
+}
+
+//Starts from zero state: discharged capacitors and no current through inductors
+TransientAnalysis::TransientAnalysis(Circuit &circuit, IntegrationMethod method) :
+        topology(std::make_shared<CircuitTopology>(circuit, true)), method(method) {
+    values = topology->getValuesOf(circuit);
+    topology->getBranchValues(values, resistances, voltages, sourceCurrents);
+    topology->getBranchReactiveValues(values, capacitances, inductances);
+    int numberOfBranches = topology->getNumberOfBranches();
+    capacitorVoltages.assign(numberOfBranches, 0.0);
+    inductorVoltages.assign(numberOfBranches, 0.0);
+    currents.assign(numberOfBranches, 0.0);
+}
+
+//Starts from the DC solution: capacitors are open, inductors are shorts
+//For a branch with a capacitor V(first) - V(second) = -E + vC, since no current flows through it
+void TransientAnalysis::setInitialStateFromOperatingPoint(Circuit &circuit) {
+    CompiledCircuit operatingPoint(circuit);
+    currents = operatingPoint.solve();
+    vector<double> nodeVoltages = operatingPoint.getNodeVoltages(currents);
+    const CircuitTopology &t = *topology;
+    for (int b = 0; b < t.getNumberOfBranches(); b++) {
+        inductorVoltages[b] = 0;
+        if (capacitances[b] > 0)
+            capacitorVoltages[b] = nodeVoltages[t.firstNodes[b]] - nodeVoltages[t.secondNodes[b]] + voltages[b];
+        else capacitorVoltages[b] = 0;
+    }
+}
+
+CompiledCircuit &TransientAnalysis::getFactorization(IntegrationMethod stepMethod, double timeStep,
+                                                     TransientResults &results) {
+    auto key = std::make_pair(stepMethod, timeStep);
+    auto it = factorizations.find(key);
+    if (it != factorizations.end()) return it->second;
+
+    vector<double> companionResistances = resistances;
+    for (int b = 0; b < topology->getNumberOfBranches(); b++) {
+        if (stepMethod == IntegrationMethod::BACKWARD_EULER) {
+            if (capacitances[b] > 0) companionResistances[b] += timeStep / capacitances[b];
+            companionResistances[b] += inductances[b] / timeStep;
+        } else {
+            if (capacitances[b] > 0) companionResistances[b] += timeStep / (2 * capacitances[b]);
+            companionResistances[b] += 2 * inductances[b] / timeStep;
+        }
+    }
+    CompiledCircuit compiledCircuit(topology);
+    compiledCircuit.refactorBranches(companionResistances);
+    results.numberOfFactorizations++;
+    return factorizations.emplace(key, compiledCircuit).first->second;
+}
+
+void TransientAnalysis::step(IntegrationMethod stepMethod, double timeStep, TransientResults &results,
+                             vector<double> &newCurrents, vector<double> &newCapacitorVoltages,
+                             vector<double> &newInductorVoltages) {
+    CompiledCircuit &compiledCircuit = getFactorization(stepMethod, timeStep, results);
+    int numberOfBranches = topology->getNumberOfBranches();
+    vector<double> companionVoltages = voltages;
+    for (int b = 0; b < numberOfBranches; b++) {
+        double c = capacitances[b];
+        double l = inductances[b];
+        if (stepMethod == IntegrationMethod::BACKWARD_EULER)
+            companionVoltages[b] += -capacitorVoltages[b] + l / timeStep * currents[b];
+        else
+            companionVoltages[b] += -capacitorVoltages[b] - (c > 0 ? timeStep / (2 * c) * currents[b] : 0) +
+                                    2 * l / timeStep * currents[b] + inductorVoltages[b];
+    }
+    compiledCircuit.setBranchSources(companionVoltages, sourceCurrents);
+    compiledCircuit.solve(newCurrents);
+
+    newCapacitorVoltages.resize(numberOfBranches);
+    newInductorVoltages.resize(numberOfBranches);
+    for (int b = 0; b < numberOfBranches; b++) {
+        double c = capacitances[b];
+        double l = inductances[b];
+        if (stepMethod == IntegrationMethod::BACKWARD_EULER) {
+            newCapacitorVoltages[b] = capacitorVoltages[b] + (c > 0 ? timeStep / c * newCurrents[b] : 0);
+            newInductorVoltages[b] = l / timeStep * (newCurrents[b] - currents[b]);
+        } else {
+            newCapacitorVoltages[b] = capacitorVoltages[b] +
+                                      (c > 0 ? timeStep / (2 * c) * (newCurrents[b] + currents[b]) : 0);
+            newInductorVoltages[b] = 2 * l / timeStep * (newCurrents[b] - currents[b]) - inductorVoltages[b];
+        }
+    }
+}
+
+void TransientAnalysis::acceptStep(double time, IntegrationMethod stepMethod, double timeStep,
+                                   TransientResults &results) {
+    CompiledCircuit &compiledCircuit = getFactorization(stepMethod, timeStep, results);
+    results.times.push_back(time);
+    results.branchCurrents.insert(results.branchCurrents.end(), currents.begin(), currents.end());
+    vector<double> nodeVoltages;
+    compiledCircuit.getNodeVoltages(currents, nodeVoltages);
+    results.nodeVoltages.insert(results.nodeVoltages.end(), nodeVoltages.begin(), nodeVoltages.end());
+}
+
+TransientResults TransientAnalysis::startResults() {
+    TransientResults results;
+    results.numberOfBranches = topology->getNumberOfBranches();
+    results.numberOfNodes = topology->getNumberOfNodes();
+    results.branchIds = topology->branchIds;
+    results.nodeIds = topology->nodeIds;
+    return results;
+}
+
+//Fixed step: one factorization, then only triangular solves
+TransientResults TransientAnalysis::run(double stopTime, double timeStep) {
+    if (timeStep <= 0) throw std::domain_error("Time step must be positive!");
+    TransientResults results = startResults();
+    int numberOfSteps = (int) ceil(stopTime / timeStep - 1e-9);
+    vector<double> newCurrents, newCapacitorVoltages, newInductorVoltages;
+    for (int s = 1; s <= numberOfSteps; s++) {
+        IntegrationMethod stepMethod = s == 1 ? IntegrationMethod::BACKWARD_EULER : method;
+        step(stepMethod, timeStep, results, newCurrents, newCapacitorVoltages, newInductorVoltages);
+        currents.swap(newCurrents);
+        capacitorVoltages.swap(newCapacitorVoltages);
+        inductorVoltages.swap(newInductorVoltages);
+        acceptStep(s * timeStep, stepMethod, timeStep, results);
+    }
+    return results;
+}
+
+//Step size control compares the new capacitor voltages and inductor currents with a linear extrapolation of the
+//last two accepted steps: the step is halved if they differ by more than the tolerance and doubled if they agree
+//within a tenth of it
+TransientResults TransientAnalysis::runAdaptive(double stopTime, double initialStep, double relativeTolerance,
+                                                double absoluteTolerance, int maximumDoublings) {
+    if (initialStep <= 0) throw std::domain_error("Time step must be positive!");
+    TransientResults results = startResults();
+    int numberOfBranches = topology->getNumberOfBranches();
+    vector<double> newCurrents, newCapacitorVoltages, newInductorVoltages;
+    vector<double> previousCurrents, previousCapacitorVoltages;
+    double previousStep = 0;
+    double time = 0;
+    int exponent = 0;
+
+    while (time < stopTime * (1 - 1e-12)) {
+        double timeStep = ldexp(initialStep, exponent);
+        if (time + timeStep > stopTime) timeStep = stopTime - time;
+        IntegrationMethod stepMethod = previousStep == 0 ? IntegrationMethod::BACKWARD_EULER : method;
+        step(stepMethod, timeStep, results, newCurrents, newCapacitorVoltages, newInductorVoltages);
+
+        double error = 0;
+        if (previousStep > 0) {
+            double ratio = timeStep / previousStep;
+            for (int b = 0; b < numberOfBranches; b++) {
+                if (capacitances[b] > 0) {
+                    double predicted = capacitorVoltages[b] +
+                                       (capacitorVoltages[b] - previousCapacitorVoltages[b]) * ratio;
+                    error = std::max(error, fabs(newCapacitorVoltages[b] - predicted) /
+                                            (absoluteTolerance + relativeTolerance * fabs(newCapacitorVoltages[b])));
+                }
+                if (inductances[b] > 0) {
+                    double predicted = currents[b] + (currents[b] - previousCurrents[b]) * ratio;
+                    error = std::max(error, fabs(newCurrents[b] - predicted) /
+                                            (absoluteTolerance + relativeTolerance * fabs(newCurrents[b])));
+                }
+            }
+        }
+        if (error > 1 && exponent > -maximumDoublings) {
+            exponent--;
+            results.numberOfRejectedSteps++;
+            continue;
+        }
+
+        previousCurrents = currents;
+        previousCapacitorVoltages = capacitorVoltages;
+        previousStep = timeStep;
+        currents.swap(newCurrents);
+        capacitorVoltages.swap(newCapacitorVoltages);
+        inductorVoltages.swap(newInductorVoltages);
+        time += timeStep;
+        acceptStep(time, stepMethod, timeStep, results);
+        if (error < 0.1 && exponent < maximumDoublings) exponent++;
+    }
+    return results;
+}
@@ -0,0 +1,87 @@
+//
+// Created by 2570p on 19.10.2026..
+//
+
+#ifndef CIRCUITANALYZER_TRANSIENTANALYSIS_H
+#define CIRCUITANALYZER_TRANSIENTANALYSIS_H
+
+#include <vector>
+#include <map>
+#include "CompiledCircuit.h"
+
+using std::vector;
+
+enum class IntegrationMethod {
+    BACKWARD_EULER, TRAPEZOIDAL
+};
+
+//Time points of a transient analysis, one row of branch currents and node voltages per accepted step
+
+class TransientResults {
+public:
+    int numberOfBranches = 0;
+    int numberOfNodes = 0;
+    vector<int> branchIds;
+    vector<int> nodeIds;
+    vector<double> times;
+    vector<double> branchCurrents;
+    vector<double> nodeVoltages;
+    int numberOfFactorizations = 0;
+    int numberOfRejectedSteps = 0;
+
+    int getNumberOfPoints() const;
+
+    double getBranchCurrent(int point, int branch) const;
+
+    double getNodeVoltage(int point, int node) const;
+};
+
+//Time domain simulation with capacitors and inductors replaced by companion models.
+//For a branch with series R, E, C and L, one step h turns the branch into
+//    backward Euler: R + h / C + L / h,           E - vC + L / h * I
+//    trapezoidal:    R + h / (2C) + 2L / h,       E - vC - h / (2C) * I + 2L / h * I + vL
+//(vC, vL and I from the previous step), so for a fixed step the matrix stays the same and every step is only
+//a triangular solve. The first step is always backward Euler, since the trapezoidal rule needs currents that
+//are consistent with the sources at the start. Adaptive stepping uses step sizes of initialStep * 2^k and keeps
+//one factorization per step size, so it refactors only when it switches to a step size it hasn't used before.
+
+class TransientAnalysis {
+    std::shared_ptr<const CircuitTopology> topology;
+    ComponentValues values;
+    IntegrationMethod method;
+    vector<double> resistances;
+    vector<double> voltages;
+    vector<double> sourceCurrents;
+    vector<double> capacitances;
+    vector<double> inductances;
+
+    //state after the last accepted step
+    vector<double> capacitorVoltages;
+    vector<double> inductorVoltages;
+    vector<double> currents;
+
+    std::map<std::pair<IntegrationMethod, double>, CompiledCircuit> factorizations;
+
+public:
+    explicit TransientAnalysis(Circuit &circuit, IntegrationMethod method = IntegrationMethod::TRAPEZOIDAL);
+
+    void setInitialStateFromOperatingPoint(Circuit &circuit);
+
+    TransientResults run(double stopTime, double timeStep);
+
+    TransientResults runAdaptive(double stopTime, double initialStep, double relativeTolerance = 1e-3,
+                                 double absoluteTolerance = 1e-9, int maximumDoublings = 10);
+
+private:
+    CompiledCircuit &getFactorization(IntegrationMethod stepMethod, double timeStep, TransientResults &results);
+
+    void step(IntegrationMethod stepMethod, double timeStep, TransientResults &results, vector<double> &newCurrents,
+              vector<double> &newCapacitorVoltages, vector<double> &newInductorVoltages);
+
+    void acceptStep(double time, IntegrationMethod stepMethod, double timeStep, TransientResults &results);
+
+    TransientResults startResults();
+};
+
+
+#endif //CIRCUITANALYZER_TRANSIENTANALYSIS_H
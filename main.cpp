@@ -251,8 +251,10 @@ public:
         return resistance;
     }
 
+    //-1 stands for an infinite resistance, like in the internal resistance of ideal voltmeters and current sources
     void setResistance(double resistance) {
-        if (resistance < 0) throw std::domain_error("Resistance can't be negative!");
+        if (resistance < 0 && fabs(1 + resistance) > EPSILON)
+            throw std::domain_error("Resistance can't be negative!");
         this->resistance = resistance;
     }
 
@@ -289,6 +291,194 @@ public:
     }
 };
 
+//Capacitor and Inductor are only used by transient and AC analysis, in DC a capacitor is an open circuit and
+//an inductor is a short circuit
+
+class Capacitor {
+    int id;
+    double capacitance;
+public:
+    explicit Capacitor(int id, double capacitance = 1e-6) {
+        setId(id);
+        setCapacitance(capacitance);
+    }
+
+    //getters and setters
+
+    int getId() const {
+        return id;
+    }
+
+    void setId(int id) {
+        if (id < 0) throw std::domain_error("IDs start at 0!");
+        Capacitor::id = id;
+    }
+
+    double getCapacitance() const {
+        return capacitance;
+    }
+
+    void setCapacitance(double capacitance) {
+        if (capacitance <= 0) throw std::domain_error("Capacitance must be positive!");
+        this->capacitance = capacitance;
+    }
+
+    //operators
+
+    friend bool operator==(const Capacitor &c1, const Capacitor &c2) {
+        return c1.id == c2.id;
+    }
+
+    friend bool operator!=(const Capacitor &c1, const Capacitor &c2) {
+        return !(c1 == c2);
+    }
+
+    friend bool operator<(const Capacitor &c1, const Capacitor &c2) {
+        return c1.id < c2.id;
+    }
+
+    friend bool operator<=(const Capacitor &c1, const Capacitor &c2) {
+        return c1 < c2 || c1 == c2;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const Capacitor &c) {
+        os << "C" << c.getId() << " -|" << c.getCapacitance() << "F|-";
+        return os;
+    }
+};
+
+class Inductor {
+    int id;
+    double inductance;
+public:
+    explicit Inductor(int id, double inductance = 1e-3) {
+        setId(id);
+        setInductance(inductance);
+    }
+
+    //getters and setters
+
+    int getId() const {
+        return id;
+    }
+
+    void setId(int id) {
+        if (id < 0) throw std::domain_error("IDs start at 0!");
+        Inductor::id = id;
+    }
+
+    double getInductance() const {
+        return inductance;
+    }
+
+    void setInductance(double inductance) {
+        if (inductance < 0) throw std::domain_error("Inductance can't be negative!");
+        this->inductance = inductance;
+    }
+
+    //operators
+
+    friend bool operator==(const Inductor &l1, const Inductor &l2) {
+        return l1.id == l2.id;
+    }
+
+    friend bool operator!=(const Inductor &l1, const Inductor &l2) {
+        return !(l1 == l2);
+    }
+
+    friend bool operator<(const Inductor &l1, const Inductor &l2) {
+        return l1.id < l2.id;
+    }
+
+    friend bool operator<=(const Inductor &l1, const Inductor &l2) {
+        return l1 < l2 || l1 == l2;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const Inductor &l) {
+        os << "L" << l.getId() << " -{" << l.getInductance() << "H}-";
+        return os;
+    }
+};
+
+//Nonlinear element of a branch, described by its voltage drop in the direction of the branch as a function of the
+//branch current. Elements are shared between copies of a branch, so they must not change after they are added.
+
+class NonlinearElement {
+    int id;
+public:
+    explicit NonlinearElement(int id) {
+        setId(id);
+    }
+
+    virtual ~NonlinearElement() = default;
+
+    int getId() const {
+        return id;
+    }
+
+    void setId(int id) {
+        if (id < 0) throw std::domain_error("IDs start at 0!");
+        NonlinearElement::id = id;
+    }
+
+    virtual double getVoltage(double current) const = 0;
+
+    //dV/dI, must be positive
+    virtual double getDerivative(double current) const = 0;
+
+    friend bool operator==(const NonlinearElement &e1, const NonlinearElement &e2) {
+        return e1.id == e2.id;
+    }
+
+    friend bool operator!=(const NonlinearElement &e1, const NonlinearElement &e2) {
+        return !(e1 == e2);
+    }
+};
+
+//Shockley diode, anode at the first node of its branch: V = n * Vt * ln(1 + I / Is)
+//Below 1 + I / Is = MINIMUM_RATIO (deep reverse bias) the curve continues as a straight line, so V(I) is defined
+//for every current
+
+class Diode : public NonlinearElement {
+    double saturationCurrent;
+    double emissionCoefficient;
+    double thermalVoltage;
+
+    static constexpr double MINIMUM_RATIO = 1e-6;
+public:
+    explicit Diode(int id, double saturationCurrent = 1e-14, double emissionCoefficient = 1,
+                   double thermalVoltage = 0.025852) : NonlinearElement(id) {
+        if (saturationCurrent <= 0) throw std::domain_error("Saturation current must be positive!");
+        if (emissionCoefficient <= 0 || thermalVoltage <= 0)
+            throw std::domain_error("Emission coefficient and thermal voltage must be positive!");
+        this->saturationCurrent = saturationCurrent;
+        this->emissionCoefficient = emissionCoefficient;
+        this->thermalVoltage = thermalVoltage;
+    }
+
+    double getSaturationCurrent() const {
+        return saturationCurrent;
+    }
+
+    double getVoltage(double current) const override {
+        double ratio = 1 + current / saturationCurrent;
+        double nVt = emissionCoefficient * thermalVoltage;
+        if (ratio >= MINIMUM_RATIO) return nVt * log(ratio);
+        return nVt * (log(MINIMUM_RATIO) + (ratio - MINIMUM_RATIO) / MINIMUM_RATIO);
+    }
+
+    double getDerivative(double current) const override {
+        double ratio = 1 + current / saturationCurrent;
+        if (ratio < MINIMUM_RATIO) ratio = MINIMUM_RATIO;
+        return emissionCoefficient * thermalVoltage / (saturationCurrent * ratio);
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const Diode &d) {
+        os << "D" << d.getId() << " -|>|-";
+        return os;
+    }
+};
+
 //ideal Voltmeter has an infinite resistance, we used -1 instead
 
 class Voltmeter {
@@ -470,10 +660,69 @@ public:
     }
 };
 
+//Wattmeter measures the power absorbed by an existing branch, (V(first) - V(second)) * I
+//Its coils are ideal, so it doesn't add a branch of its own
+
 class Wattmeter {
-    Voltmeter voltmeter;
-    Ampermeter ampermeter;
-    //to be implemented
+    int id;
+    int branchId;
+    double power = 0;
+public:
+    Wattmeter(int id, int branchId) {
+        setId(id);
+        setBranchId(branchId);
+    }
+
+    //getters and setters
+
+    int getId() const {
+        return id;
+    }
+
+    void setId(int id) {
+        if (id < 0) throw std::domain_error("IDs start at 0!");
+        Wattmeter::id = id;
+    }
+
+    int getBranchId() const {
+        return branchId;
+    }
+
+    void setBranchId(int branchId) {
+        if (branchId < 0) throw std::domain_error("IDs start at 0!");
+        Wattmeter::branchId = branchId;
+    }
+
+    double getPower() const {
+        return power;
+    }
+
+    void setPower(double power) {
+        this->power = power;
+    }
+
+    //operators
+
+    friend bool operator==(const Wattmeter &w1, const Wattmeter &w2) {
+        return w1.id == w2.id;
+    }
+
+    friend bool operator!=(const Wattmeter &w1, const Wattmeter &w2) {
+        return !(w1 == w2);
+    }
+
+    friend bool operator<(const Wattmeter &w1, const Wattmeter &w2) {
+        return w1.id < w2.id;
+    }
+
+    friend bool operator<=(const Wattmeter &w1, const Wattmeter &w2) {
+        return w1 < w2 || w1 == w2;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const Wattmeter &w) {
+        os << "W" << w.getId() << " (B" << w.getBranchId() << " [" << w.getPower() << "W])";
+        return os;
+    }
 };
 
 class Node {
@@ -546,6 +795,9 @@ class Branch {
     list<Resistor> resistors;
     list<VoltageSource> voltageSources;
     list<CurrentSource> currentSources;
+    list<Capacitor> capacitors;
+    list<Inductor> inductors;
+    list<std::shared_ptr<const NonlinearElement>> nonlinearElements;
     double current = 0;
 public:
 
@@ -645,6 +897,30 @@ public:
         Branch::currentSources = currentSources;
     }
 
+    const list<Capacitor> &getCapacitors() const {
+        return capacitors;
+    }
+
+    list<Capacitor> &getCapacitors() {
+        return capacitors;
+    }
+
+    const list<Inductor> &getInductors() const {
+        return inductors;
+    }
+
+    list<Inductor> &getInductors() {
+        return inductors;
+    }
+
+    const list<std::shared_ptr<const NonlinearElement>> &getNonlinearElements() const {
+        return nonlinearElements;
+    }
+
+    list<std::shared_ptr<const NonlinearElement>> &getNonlinearElements() {
+        return nonlinearElements;
+    }
+
     //utility
 
     bool hasResistors() {
@@ -659,8 +935,21 @@ public:
         return !currentSources.empty();
     }
 
+    bool hasCapacitors() {
+        return !capacitors.empty();
+    }
+
+    bool hasInductors() {
+        return !inductors.empty();
+    }
+
+    bool hasNonlinearElements() const {
+        return !nonlinearElements.empty();
+    }
+
     bool isEmpty() {
-        return resistors.empty() && voltageSources.empty() && currentSources.empty();
+        return resistors.empty() && voltageSources.empty() && currentSources.empty() && capacitors.empty() &&
+               inductors.empty() && nonlinearElements.empty();
     }
 
     bool isLoop() {
@@ -720,6 +1009,34 @@ public:
         currentSources.push_back(c);
     }
 
+    void addCapacitor(const Capacitor &c) {
+        capacitors.push_back(c);
+    }
+
+    void addInductor(const Inductor &l) {
+        inductors.push_back(l);
+    }
+
+    void addNonlinearElement(const std::shared_ptr<const NonlinearElement> &e) {
+        if (e == nullptr) throw std::domain_error("Nonlinear element is missing!");
+        nonlinearElements.push_back(e);
+    }
+
+    //capacitors in series
+    double getCapacitance() const {
+        double inverseCapacitance = 0;
+        for (const auto &c : capacitors)
+            inverseCapacitance += 1 / c.getCapacitance();
+        return capacitors.empty() ? 0 : 1 / inverseCapacitance;
+    }
+
+    double getInductance() const {
+        double inductance = 0;
+        for (const auto &l : inductors)
+            inductance += l.getInductance();
+        return inductance;
+    }
+
     //operators
 
     friend bool operator==(const Branch &b1, const Branch &b2) {
@@ -742,6 +1059,9 @@ public:
         this->resistors.splice(resistors.end(), b.getResistors());
         this->voltageSources.splice(voltageSources.end(), b.getVoltageSources());
         this->currentSources.splice(currentSources.end(), b.getCurrentSources());
+        this->capacitors.splice(capacitors.end(), b.getCapacitors());
+        this->inductors.splice(inductors.end(), b.getInductors());
+        this->nonlinearElements.splice(nonlinearElements.end(), b.getNonlinearElements());
         return *this;
     }
 
@@ -757,15 +1077,12 @@ public:
 class VoltmeterWrapper {
     Voltmeter voltmeter;
     std::pair<Node, Node> voltmeterNodes;
-    Resistor *parasiteResistance;
+    int branchId;
 public:
-    VoltmeterWrapper(const Voltmeter &voltmeter, const Node &firstNode, const Node &secondNode,
-                     Resistor *resistor = nullptr) :
-            voltmeter(voltmeter) {
-        if (resistor == nullptr && !voltmeter.isIdeal())
-            throw std::logic_error("A resistor must by provided for non-ideal voltmeters!");
+    //branchId is the branch with the internal resistance of the voltmeter
+    VoltmeterWrapper(const Voltmeter &voltmeter, const Node &firstNode, const Node &secondNode, int branchId) :
+            voltmeter(voltmeter), branchId(branchId) {
         this->voltmeterNodes = std::pair<Node, Node>(firstNode, secondNode);
-        parasiteResistance = resistor;
     }
 
     //getters and setters
@@ -782,12 +1099,12 @@ public:
         VoltmeterWrapper::voltmeter = voltmeter;
     }
 
-    Resistor *getParasiteResistance() const {
-        return parasiteResistance;
+    int getBranchId() const {
+        return branchId;
     }
 
-    void setParasiteResistance(Resistor *parasiteResistance) {
-        VoltmeterWrapper::parasiteResistance = parasiteResistance;
+    void setBranchId(int branchId) {
+        VoltmeterWrapper::branchId = branchId;
     }
 
     const Node &getFirstNode() const {
@@ -819,27 +1136,21 @@ public:
 class AmpermeterWrapper {
     Ampermeter ampermeter;
     Branch ampermeterBranch;
-    Resistor *parasiteResistance;
-
 
 public:
-    AmpermeterWrapper(const Ampermeter &ampermeter, const Branch &ampermeterBranch, Resistor *parasiteResistance)
-            : ampermeter(ampermeter), ampermeterBranch(ampermeterBranch), parasiteResistance(parasiteResistance) {}
+    AmpermeterWrapper(const Ampermeter &ampermeter, const Branch &ampermeterBranch)
+            : ampermeter(ampermeter), ampermeterBranch(ampermeterBranch) {}
 
     const Ampermeter &getAmpermeter() const {
         return ampermeter;
     }
 
-    void setAmpermeter(const Ampermeter &ampermeter) {
-        AmpermeterWrapper::ampermeter = ampermeter;
-    }
-
-    Resistor *getParasiteResistance() const {
-        return parasiteResistance;
+    Ampermeter &getAmpermeter() {
+        return ampermeter;
     }
 
-    void setParasiteResistance(Resistor *parasiteResistance) {
-        AmpermeterWrapper::parasiteResistance = parasiteResistance;
+    void setAmpermeter(const Ampermeter &ampermeter) {
+        AmpermeterWrapper::ampermeter = ampermeter;
     }
 
     const Branch &getAmpermeterBranch() const {